@@ -136,11 +136,11 @@ if [ -f "$CSV" ]; then
     ls -lh "$CSV" | tee -a "$LOG"
     echo "" | tee -a "$LOG"
 
-    if [ -f validar.awk ]; then
+    if [ -x ./validar_csv ]; then
         echo ">>> Ejecutando validación de IDs..." | tee -a "$LOG"
-        awk -v GENS="$GENS" -v TOTAL="$TOTAL" -f validar.awk "$CSV" | tee -a "$LOG"
+        ./validar_csv -g "$GENS" -t "$TOTAL" "$CSV" | tee -a "$LOG"
     else
-        echo "⚠️  No se encontró validar.awk. Saltando validación." | tee -a "$LOG"
+        echo "⚠️  No se encontró validar_csv (make validar_csv). Saltando validación." | tee -a "$LOG"
     fi
 else
     echo "❌ No se generó el archivo $CSV" | tee -a "$LOG"
@@ -0,0 +1,628 @@
+// ================================================================
+// validar.c
+// ================================================================
+// Valida el archivo productos.csv generado por el programa.
+// Verifica que el archivo CSV generado cumpla:
+//  - IDs correlativos (sin saltos)
+//  - Sin IDs duplicados
+//  - Formato de los campos (Cantidad entera, Fecha AAAA-MM-DD, Hora HH:MM:SS)
+//  - Reporta totales por generador y posibles errores
+//
+// Reemplaza a validar.awk con el mismo reporte. El CSV se mapea con mmap y
+// se divide en tramos alineados a '\n' que se validan en paralelo; los campos
+// se leen con el parser de ejercicio2_baseDeDatos (parser_csv.c) sin copiar
+// cada línea. Los IDs vistos se marcan en un mapa de bits compartido
+// (operaciones atómicas), así los duplicados y los faltantes se detectan sin
+// ordenar ni guardar los IDs.
+//
+// Uso:
+//   ./validar_csv -g 5 -t 100 [-j hilos] productos.csv
+// ================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "parser_csv.h"
+#include "indice.h"
+
+#define HILOS_MAX    64
+#define TRAMO_MIN    (1024 * 1024)  /* bytes por hilo como mínimo */
+#define DETALLE_MAX  1000000        /* errores que se listan (se cuentan todos) */
+
+typedef enum {
+    ERR_ID, ERR_DUPLICADO, ERR_GENERADOR, ERR_ORDEN,
+    ERR_CAMPOS, ERR_DESCRIPCION, ERR_CANTIDAD, ERR_FECHA, ERR_HORA
+} TipoError;  /* orden en que se listan los errores de una misma línea */
+
+typedef struct {
+    long linea;          /* local al tramo hasta unir los resultados */
+    TipoError tipo;
+    int a, b;            /* IDs para duplicado / fuera de orden */
+    const char *texto;   /* campo inválido (dentro del archivo mapeado) */
+    uint32_t largo;
+} ErrorVal;
+
+typedef struct {
+    const char *ini, *fin;
+    long lineas;
+    ErrorVal *err;
+    size_t n_err, cap_err, max_err;
+    long errores;              /* todos, también los que no se guardan */
+    long registros;            /* líneas con ID válido */
+    long repetidos;            /* IDs que ya estaban marcados */
+    int hay_ids, min_id, max_id, primer_id, ultimo_id;
+    long linea_primer_id;
+    IndiceId gens;             /* generador -> registros */
+    int hay_gens, max_gen;
+    int *candidatos;           /* IDs repetidos (para ubicar los duplicados) */
+    size_t n_cand, cap_cand;
+    int error_memoria;
+} Tramo;
+
+static int GENS = 4;
+static int TOTAL = 100;
+static int HILOS = 0;
+
+static int gen_col = 0;   // columna Generador (desde 1), 0 si no hay
+
+// IDs vistos: mapa de bits para 1..limite_mapa, índice con mutex para el resto
+static _Atomic uint64_t *mapa;
+static long limite_mapa;
+static IndiceId fuera_mapa;
+static pthread_mutex_t mutex_fuera = PTHREAD_MUTEX_INITIALIZER;
+
+static double ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Quita espacios, tabuladores y '\r' de los extremos del campo
+static void recortar(const char **s, uint32_t *n) {
+    while (*n > 0 && (**s == ' ' || **s == '\t')) { (*s)++; (*n)--; }
+    while (*n > 0 && ((*s)[*n - 1] == ' ' || (*s)[*n - 1] == '\t' || (*s)[*n - 1] == '\r')) (*n)--;
+}
+
+static void registrar(Tramo *t, long linea, TipoError tipo, int a, int b, const char *texto, uint32_t largo) {
+    t->errores++;
+    if (t->n_err >= t->max_err) return;
+    if (t->n_err == t->cap_err) {
+        size_t nueva = t->cap_err ? t->cap_err * 2 : 256;
+        ErrorVal *e = realloc(t->err, nueva * sizeof(ErrorVal));
+        if (!e) {
+            t->error_memoria = 1;
+            return;
+        }
+        t->err = e;
+        t->cap_err = nueva;
+    }
+    t->err[t->n_err++] = (ErrorVal){ linea, tipo, a, b, texto, largo };
+}
+
+// Marca el ID como visto; devuelve 1 si ya estaba
+static int marcar_id(int id) {
+    if (id <= limite_mapa) {
+        uint64_t bit = 1ULL << (id & 63);
+        return (atomic_fetch_or_explicit(&mapa[id >> 6], bit, memory_order_relaxed) & bit) != 0;
+    }
+    pthread_mutex_lock(&mutex_fuera);
+    int ya = indice_buscar(&fuera_mapa, id) >= 0;
+    if (!ya) indice_poner(&fuera_mapa, id, 1);
+    pthread_mutex_unlock(&mutex_fuera);
+    return ya;
+}
+
+static int visto(long id) {
+    if (id <= limite_mapa) return (atomic_load_explicit(&mapa[id >> 6], memory_order_relaxed) >> (id & 63)) & 1;
+    return indice_buscar(&fuera_mapa, (int)id) >= 0;
+}
+
+static int digitos(const char *s, int n, int *v) {
+    *v = 0;
+    for (int i = 0; i < n; i++) {
+        if (s[i] < '0' || s[i] > '9') return -1;
+        *v = *v * 10 + (s[i] - '0');
+    }
+    return 0;
+}
+
+// AAAA-MM-DD
+static int fecha_valida(const char *s, uint32_t n) {
+    int a, m, d;
+    if (n != 10 || s[4] != '-' || s[7] != '-') return 0;
+    if (digitos(s, 4, &a) || digitos(s + 5, 2, &m) || digitos(s + 8, 2, &d)) return 0;
+    return m >= 1 && m <= 12 && d >= 1 && d <= 31;
+}
+
+// HH:MM:SS
+static int hora_valida(const char *s, uint32_t n) {
+    int h, m, seg;
+    if (n != 8 || s[2] != ':' || s[5] != ':') return 0;
+    if (digitos(s, 2, &h) || digitos(s + 3, 2, &m) || digitos(s + 6, 2, &seg)) return 0;
+    return h <= 23 && m <= 59 && seg <= 59;
+}
+
+static void procesar_encabezado(const char *linea, const char *fin) {
+    CamposCsv c;
+    if (csv_separar(linea, fin, &c) < 0) return;
+    for (int i = 0; i < c.n; i++) {
+        const char *s = c.campo[i];
+        uint32_t n = c.largo[i];
+        recortar(&s, &n);
+        if (n == 9 && strncasecmp(s, "generador", 9) == 0) gen_col = i + 1;
+    }
+}
+
+// Comentarios, líneas vacías y líneas sin registro que se saltean
+static int saltear(const char *p, const char *fin) {
+    return p == fin || *p == '#' || *p == '\r';
+}
+
+static void validar_linea(Tramo *t, const char *p, const char *fin, long nr) {
+    CamposCsv c;
+    if (csv_separar(p, fin, &c) < 0) {
+        registrar(t, nr, ERR_CAMPOS, CSV_CAMPOS_MAX, 0, NULL, 0);
+        return;
+    }
+    const char *s = c.campo[0];
+    uint32_t n = c.largo[0];
+    recortar(&s, &n);
+    int id;
+    if (csv_entero(s, n, &id) != 0 || id <= 0) {
+        registrar(t, nr, ERR_ID, 0, 0, s, n);
+        return;
+    }
+
+    t->registros++;
+    if (marcar_id(id)) {
+        t->repetidos++;
+        if (t->n_cand == t->cap_cand) {
+            size_t nueva = t->cap_cand ? t->cap_cand * 2 : 64;
+            int *cand = realloc(t->candidatos, nueva * sizeof(int));
+            if (!cand) {
+                t->error_memoria = 1;
+                return;
+            }
+            t->candidatos = cand;
+            t->cap_cand = nueva;
+        }
+        t->candidatos[t->n_cand++] = id;
+    }
+    if (!t->hay_ids) {
+        t->min_id = t->max_id = t->primer_id = id;
+        t->linea_primer_id = nr;
+    } else if (id < t->ultimo_id) {
+        // el desorden contra el tramo anterior se revisa al unir
+        registrar(t, nr, ERR_ORDEN, id, t->ultimo_id, NULL, 0);
+    }
+    if (id < t->min_id) t->min_id = id;
+    if (id > t->max_id) t->max_id = id;
+    t->ultimo_id = id;
+    t->hay_ids = 1;
+
+    if (gen_col > 0) {
+        const char *g = gen_col <= c.n ? c.campo[gen_col - 1] : "";
+        uint32_t gn = gen_col <= c.n ? c.largo[gen_col - 1] : 0;
+        recortar(&g, &gn);
+        int gen;
+        if (csv_entero(g, gn, &gen) != 0 || gen <= 0) {
+            registrar(t, nr, ERR_GENERADOR, 0, 0, g, gn);
+        } else {
+            int32_t previos = indice_buscar(&t->gens, gen);
+            if (indice_poner(&t->gens, gen, previos < 0 ? 1 : previos + 1) != 0) t->error_memoria = 1;
+            if (!t->hay_gens || gen > t->max_gen) t->max_gen = gen;
+            t->hay_gens = 1;
+        }
+    }
+
+    // Formato de los campos del generador: ID,Descripcion,Cantidad,Fecha,Hora,Generador
+    if (c.n != 6) {
+        registrar(t, nr, ERR_CAMPOS, c.n, 0, NULL, 0);
+        return;
+    }
+    int cantidad;
+    if (c.largo[1] == 0 || c.largo[1] >= DESC_MAX)
+        registrar(t, nr, ERR_DESCRIPCION, 0, 0, c.campo[1], c.largo[1]);
+    if (csv_entero(c.campo[2], c.largo[2], &cantidad) != 0 || cantidad < 0)
+        registrar(t, nr, ERR_CANTIDAD, 0, 0, c.campo[2], c.largo[2]);
+    if (!fecha_valida(c.campo[3], c.largo[3]))
+        registrar(t, nr, ERR_FECHA, 0, 0, c.campo[3], c.largo[3]);
+    if (!hora_valida(c.campo[4], c.largo[4]))
+        registrar(t, nr, ERR_HORA, 0, 0, c.campo[4], c.largo[4]);
+}
+
+static void *validar_tramo(void *arg) {
+    Tramo *t = arg;
+    const char *p = t->ini;
+    while (p < t->fin) {
+        const char *nl = memchr(p, '\n', (size_t)(t->fin - p));
+        const char *fin_linea = nl ? nl : t->fin;
+        t->lineas++;
+        if (!saltear(p, fin_linea)) validar_linea(t, p, fin_linea, t->lineas);
+        p = fin_linea + 1;
+    }
+    return NULL;
+}
+
+// ===== Segunda pasada (solo si hubo repetidos): ubicar cada aparición =====
+typedef struct {
+    long linea;
+    int id;
+} Aparicion;
+
+typedef struct {
+    const Tramo *t;
+    const IndiceId *repetidos;
+    long base;                 /* líneas antes del tramo */
+    Aparicion *ap;
+    size_t n, cap;
+    int error_memoria;
+} Busqueda;
+
+static void *buscar_apariciones(void *arg) {
+    Busqueda *b = arg;
+    const char *p = b->t->ini;
+    long nr = 0;
+    while (p < b->t->fin) {
+        const char *nl = memchr(p, '\n', (size_t)(b->t->fin - p));
+        const char *fin_linea = nl ? nl : b->t->fin;
+        nr++;
+        CamposCsv c;
+        int id;
+        if (!saltear(p, fin_linea) && csv_separar(p, fin_linea, &c) >= 0) {
+            const char *s = c.campo[0];
+            uint32_t n = c.largo[0];
+            recortar(&s, &n);
+            if (csv_entero(s, n, &id) == 0 && id > 0 && indice_buscar(b->repetidos, id) >= 0) {
+                if (b->n == b->cap) {
+                    size_t nueva = b->cap ? b->cap * 2 : 64;
+                    Aparicion *a = realloc(b->ap, nueva * sizeof(Aparicion));
+                    if (!a) {
+                        b->error_memoria = 1;
+                        return NULL;
+                    }
+                    b->ap = a;
+                    b->cap = nueva;
+                }
+                b->ap[b->n++] = (Aparicion){ b->base + nr, id };
+            }
+        }
+        p = fin_linea + 1;
+    }
+    return NULL;
+}
+
+static int por_id_y_linea(const void *x, const void *y) {
+    const Aparicion *a = x, *b = y;
+    if (a->id != b->id) return a->id < b->id ? -1 : 1;
+    return (a->linea > b->linea) - (a->linea < b->linea);
+}
+
+static int por_linea(const void *x, const void *y) {
+    const ErrorVal *a = x, *b = y;
+    if (a->linea != b->linea) return a->linea < b->linea ? -1 : 1;
+    return (int)a->tipo - (int)b->tipo;
+}
+
+static void lanzar(void *(*fn)(void *), void *args, size_t tam_arg, int n) {
+    pthread_t ids[HILOS_MAX];
+    int lanzados = 0;
+    for (int i = 1; i < n; i++) {
+        if (pthread_create(&ids[i], NULL, fn, (char *)args + i * tam_arg) != 0) break;
+        lanzados = i;
+    }
+    if (n > 0) fn(args);
+    for (int i = lanzados + 1; i < n; i++) fn((char *)args + i * tam_arg); // sin hilo
+    for (int i = 1; i <= lanzados; i++) pthread_join(ids[i], NULL);
+}
+
+static int hilos_para(size_t tam) {
+    int hilos = HILOS;
+    if (hilos <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        hilos = cpus > 0 ? (int)cpus : 1;
+    }
+    if (hilos > HILOS_MAX) hilos = HILOS_MAX;
+    size_t por_tamano = tam / TRAMO_MIN + 1;
+    if ((size_t)hilos > por_tamano) hilos = (int)por_tamano;
+    return hilos;
+}
+
+static void imprimir_error(const ErrorVal *e) {
+    int n = (int)e->largo;
+    switch (e->tipo) {
+        case ERR_ID:          printf("❌ Línea %ld: ID inválido (%.*s)\n", e->linea, n, e->texto); break;
+        case ERR_CAMPOS:      printf("❌ Línea %ld: Cantidad de campos inválida (%d)\n", e->linea, e->a); break;
+        case ERR_DUPLICADO:   printf("❌ Línea %ld: ID duplicado (%d)\n", e->linea, e->a); break;
+        case ERR_GENERADOR:   printf("❌ Línea %ld: Generador inválido (%.*s)\n", e->linea, n, e->texto); break;
+        case ERR_CANTIDAD:    printf("❌ Línea %ld: Cantidad inválida (%.*s)\n", e->linea, n, e->texto); break;
+        case ERR_FECHA:       printf("❌ Línea %ld: Fecha inválida (%.*s)\n", e->linea, n, e->texto); break;
+        case ERR_HORA:        printf("❌ Línea %ld: Hora inválida (%.*s)\n", e->linea, n, e->texto); break;
+        case ERR_DESCRIPCION: printf("❌ Línea %ld: Descripción inválida (%.*s)\n", e->linea, n, e->texto); break;
+        case ERR_ORDEN:       printf("❌ Línea %ld: ID fuera de orden (%d después de %d)\n", e->linea, e->a, e->b); break;
+    }
+}
+
+static void uso(const char *prog) {
+    fprintf(stderr,
+        "Uso: %s [-g GENS] [-t TOTAL] [-j hilos] productos.csv\n"
+        "  -g GENS   generadores esperados (4)\n"
+        "  -t TOTAL  registros esperados (100)\n"
+        "  -j hilos  hilos de validación (0 = uno por CPU)\n",
+        prog);
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "g:t:j:h")) != -1) {
+        switch (opt) {
+            case 'g': GENS = atoi(optarg); break;
+            case 't': TOTAL = atoi(optarg); break;
+            case 'j': HILOS = atoi(optarg); break;
+            default: uso(argv[0]); return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        uso(argv[0]);
+        return 2;
+    }
+    // Valores por defecto
+    if (TOTAL <= 0) TOTAL = 100;
+    if (GENS <= 0) GENS = 4;
+    printf("Usando parámetros: TOTAL=%d, GENS=%d\n", TOTAL, GENS);
+    double inicio = ahora_ms();
+
+    const char *ruta = argv[optind];
+    int fd = open(ruta, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        perror(ruta);
+        return 2;
+    }
+    size_t tam = (size_t)st.st_size;
+    const char *base = NULL;
+    if (tam > 0) {
+        base = mmap(NULL, tam, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED) {
+            perror("mmap");
+            return 2;
+        }
+        madvise((void *)base, tam, MADV_SEQUENTIAL);
+    }
+    close(fd);
+    const char *fin = base + tam;
+
+    // Encabezado (primera línea) y cuerpo
+    const char *cuerpo = base;
+    if (tam > 0) {
+        const char *nl = memchr(base, '\n', tam);
+        cuerpo = nl ? nl + 1 : fin;
+        procesar_encabezado(base, nl ? nl : fin);
+    }
+
+    // Cada línea ocupa al menos 2 bytes: el mapa cubre todos los IDs de un
+    // archivo correlativo; los IDs más grandes van al índice
+    limite_mapa = (long)(tam / 2) > TOTAL ? (long)(tam / 2) : TOTAL;
+    if (limite_mapa > INT32_MAX) limite_mapa = INT32_MAX;
+    mapa = calloc((size_t)limite_mapa / 64 + 1, sizeof(uint64_t));
+    indice_iniciar(&fuera_mapa);
+    if (!mapa) {
+        fprintf(stderr, "Sin memoria\n");
+        return 2;
+    }
+
+    int hilos = hilos_para((size_t)(fin - cuerpo));
+    Tramo tramos[HILOS_MAX];
+    int n_tramos = 0;
+    const char *p = cuerpo;
+    for (int i = 0; i < hilos && p < fin; i++) {
+        const char *corte = fin;
+        if (i < hilos - 1) {
+            const char *desde = cuerpo + (size_t)(fin - cuerpo) / hilos * (i + 1);
+            if (desde < p) desde = p;
+            const char *nl = memchr(desde, '\n', (size_t)(fin - desde));
+            corte = nl ? nl + 1 : fin;
+        }
+        if (corte <= p) continue;
+        memset(&tramos[n_tramos], 0, sizeof(Tramo));
+        tramos[n_tramos].ini = p;
+        tramos[n_tramos].fin = corte;
+        tramos[n_tramos].max_err = DETALLE_MAX / hilos;
+        indice_iniciar(&tramos[n_tramos].gens);
+        n_tramos++;
+        p = corte;
+    }
+    lanzar(validar_tramo, tramos, sizeof(Tramo), n_tramos);
+
+    // ===== Unir los tramos =====
+    long errores = 0, advertencias = 0, registros = 0, repetidos = 0;
+    int hay_ids = 0, min_id = 0, max_id = 0, ultimo_id = 0;
+    long lineas_antes = 1; // encabezado
+    size_t n_err = 0;
+    IndiceId gens, repetidos_ids;
+    indice_iniciar(&gens);
+    indice_iniciar(&repetidos_ids);
+    int hay_gens = 0, max_gen = 0;
+    for (int i = 0; i < n_tramos; i++) {
+        Tramo *t = &tramos[i];
+        if (t->error_memoria) {
+            fprintf(stderr, "Sin memoria\n");
+            return 2;
+        }
+        for (size_t j = 0; j < t->n_err; j++) t->err[j].linea += lineas_antes;
+        if (t->hay_ids) {
+            if (hay_ids && t->primer_id < ultimo_id)
+                registrar(t, t->linea_primer_id + lineas_antes, ERR_ORDEN, t->primer_id, ultimo_id, NULL, 0);
+            if (!hay_ids || t->min_id < min_id) min_id = t->min_id;
+            if (!hay_ids || t->max_id > max_id) max_id = t->max_id;
+            ultimo_id = t->ultimo_id;
+            hay_ids = 1;
+        }
+        for (size_t j = 0; j < t->gens.cap; j++) {
+            if (t->gens.t[j].id <= 0) continue;
+            int32_t previos = indice_buscar(&gens, t->gens.t[j].id);
+            indice_poner(&gens, t->gens.t[j].id, (previos < 0 ? 0 : previos) + t->gens.t[j].pos);
+        }
+        if (t->hay_gens && (!hay_gens || t->max_gen > max_gen)) max_gen = t->max_gen;
+        hay_gens |= t->hay_gens;
+        for (size_t j = 0; j < t->n_cand; j++) indice_poner(&repetidos_ids, t->candidatos[j], 1);
+        errores += t->errores;
+        registros += t->registros;
+        repetidos += t->repetidos;
+        n_err += t->n_err;
+        lineas_antes += t->lineas;
+    }
+
+    // Duplicados: la primera aparición de cada ID repetido es válida, el resto no
+    ErrorVal *dups = NULL;
+    size_t n_dups = 0;
+    if (repetidos > 0) {
+        Busqueda busquedas[HILOS_MAX];
+        long antes = 1;
+        for (int i = 0; i < n_tramos; i++) {
+            busquedas[i] = (Busqueda){ &tramos[i], &repetidos_ids, antes, NULL, 0, 0, 0 };
+            antes += tramos[i].lineas;
+        }
+        lanzar(buscar_apariciones, busquedas, sizeof(Busqueda), n_tramos);
+        size_t total = 0;
+        for (int i = 0; i < n_tramos; i++) total += busquedas[i].n;
+        Aparicion *ap = malloc((total ? total : 1) * sizeof(Aparicion));
+        dups = malloc((total ? total : 1) * sizeof(ErrorVal));
+        if (!ap || !dups) {
+            fprintf(stderr, "Sin memoria\n");
+            return 2;
+        }
+        size_t k = 0;
+        for (int i = 0; i < n_tramos; i++) {
+            if (busquedas[i].error_memoria) {
+                fprintf(stderr, "Sin memoria\n");
+                return 2;
+            }
+            if (busquedas[i].n) memcpy(ap + k, busquedas[i].ap, busquedas[i].n * sizeof(Aparicion));
+            k += busquedas[i].n;
+            free(busquedas[i].ap);
+        }
+        qsort(ap, total, sizeof(Aparicion), por_id_y_linea);
+        for (size_t j = 1; j < total; j++) {
+            if (ap[j].id == ap[j - 1].id && n_err + n_dups < DETALLE_MAX)
+                dups[n_dups++] = (ErrorVal){ ap[j].linea, ERR_DUPLICADO, ap[j].id, 0, NULL, 0 };
+        }
+        free(ap);
+        errores += repetidos;
+    }
+
+    // Todos los errores en orden de línea
+    ErrorVal *todos = malloc((n_err + n_dups + 1) * sizeof(ErrorVal));
+    if (!todos) {
+        fprintf(stderr, "Sin memoria\n");
+        return 2;
+    }
+    size_t k = 0;
+    for (int i = 0; i < n_tramos; i++) {
+        if (tramos[i].n_err) memcpy(todos + k, tramos[i].err, tramos[i].n_err * sizeof(ErrorVal));
+        k += tramos[i].n_err;
+    }
+    if (n_dups) memcpy(todos + k, dups, n_dups * sizeof(ErrorVal));
+    k += n_dups;
+    qsort(todos, k, sizeof(ErrorVal), por_linea);
+    for (size_t j = 0; j < k; j++) imprimir_error(&todos[j]);
+
+    long total_reg = registros - repetidos;
+
+    // Verificar correlatividad (faltantes en cualquier parte)
+    long listados = (long)k;
+    if (hay_ids) {
+        long faltantes = ((long)max_id - min_id + 1) - total_reg;
+        for (long i = min_id; i <= max_id && listados < DETALLE_MAX && faltantes > 0; i++) {
+            if (!visto(i)) {
+                printf("❌ Falta ID %ld (no encontrado en el archivo)\n", i);
+                listados++;
+            }
+        }
+        errores += faltantes;
+    }
+    if (listados < errores) printf("… %ld error(es) más sin detallar\n", errores - listados);
+
+    printf("----------------------------------------------\n");
+    printf("📊 Resumen de validación del CSV\n");
+    printf("----------------------------------------------\n");
+    printf("Total de registros leídos : %ld\n", total_reg);
+    if (hay_ids) {
+        printf("ID mínimo                 : %d\n", min_id);
+        printf("ID máximo                 : %d\n", max_id);
+        printf("Esperado correlativo      : %ld\n", (long)max_id - min_id + 1);
+    } else {
+        printf("ID mínimo                 : \n");
+        printf("ID máximo                 : \n");
+        printf("Esperado correlativo      : 0\n");
+    }
+
+    // Verificación de TOTAL
+    if (total_reg != TOTAL) {
+        printf("⚠️  Advertencia: Cantidad de registros (%ld) no coincide con TOTAL esperado (%d)\n", total_reg, TOTAL);
+        advertencias++;
+    }
+    if (!hay_ids || max_id != TOTAL) {
+        printf("⚠️  Advertencia: ID máximo (%d) no coincide con TOTAL esperado (%d)\n", hay_ids ? max_id : 0, TOTAL);
+        advertencias++;
+    }
+
+    // Verificación de generadores
+    if (gen_col == 0) {
+        printf("⚠️  Advertencia: Columna 'Generador' no encontrada. No se puede validar GENS.\n");
+        advertencias++;
+    } else {
+        long gens_contados = (long)gens.vivas;
+        printf("Generadores detectados    : %ld\n", gens_contados);
+        for (int g = 1; g <= max_gen; g++) {
+            int32_t cuenta = indice_buscar(&gens, g);
+            if (cuenta > 0) printf("  Generador %-3d           : %d registro(s)\n", g, cuenta);
+        }
+        if (gens_contados != GENS) {
+            printf("⚠️  Advertencia: Generadores distintos (%ld) no coincide con GENS esperado (%d)\n", gens_contados, GENS);
+            advertencias++;
+        }
+        if (!hay_gens || max_gen != GENS) {
+            printf("⚠️  Advertencia: Generador máximo (%d) no coincide con GENS esperado (%d)\n", hay_gens ? max_gen : 0, GENS);
+            advertencias++;
+        }
+    }
+
+    printf("Tiempo de validación      : %.1f ms (%d hilo(s))\n", ahora_ms() - inicio, n_tramos);
+    printf("----------------------------------------------\n");
+
+    // Resultado final
+    int res;
+    if (errores == 0 && advertencias == 0) {
+        printf("✅ VALIDACIÓN EXITOSA: Todos los IDs son únicos, correlativos y ordenados.\n");
+        res = 0;
+    } else if (errores == 0) {
+        printf("⚠️  VALIDACIÓN EXITOSA CON ADVERTENCIAS.\n");
+        res = 0;
+    } else {
+        printf("❌ VALIDACIÓN FALLIDA: Se detectaron %ld error(es).\n", errores);
+        res = 1;
+    }
+
+    for (int i = 0; i < n_tramos; i++) {
+        free(tramos[i].err);
+        free(tramos[i].candidatos);
+        indice_liberar(&tramos[i].gens);
+    }
+    free(todos);
+    free(dups);
+    indice_liberar(&gens);
+    indice_liberar(&repetidos_ids);
+    indice_liberar(&fuera_mapa);
+    free(mapa);
+    if (base) munmap((void *)base, tam);
+    return res;
+}
@@ -0,0 +1,45 @@
+#ifndef ADMISION_H
+#define ADMISION_H
+
+#include <stdint.h>
+
+/*
+ * Control de admisión: como mucho MAX_CLIENTES conexiones atendidas a la vez.
+ * Cuando no hay lugar, la conexión espera en una cola FIFO de hasta
+ * ADMISION_COLA entradas en lugar de rechazarse; al desconectarse un cliente
+ * su lugar pasa directamente al primero de la cola. Si la espera supera
+ * ADMISION_TIMEOUT_MS se responde "Servidor ocupado" y se cierra.
+ */
+
+#define ADMISION_COLA_DEF        64     /* 0 = rechazar en cuanto se llena */
+#define ADMISION_TIMEOUT_MS_DEF  5000   /* 0 = esperar sin límite */
+
+#define ADMISION_ADMITIDO   0   /* tiene lugar: despacharla ya */
+#define ADMISION_EN_ESPERA  1   /* encolada: se despacha al liberarse un lugar */
+#define ADMISION_RECHAZADO -1   /* cola llena */
+
+extern int ADMISION_COLA;
+extern int ADMISION_TIMEOUT_MS;
+
+/* despachar(socket) entrega una conexión admitida desde la cola a un hilo
+   de atención (0 ok). Arranca el hilo que vence las esperas */
+int admision_iniciar(int (*despachar)(int socket));
+/* Cierra las conexiones en espera y detiene el hilo de vencimientos */
+void admision_detener(void);
+
+/* Pide lugar para una conexión recién aceptada */
+int admision_entrar(int socket);
+
+/* Devuelve el lugar de una conexión terminada (o de una que no se pudo despachar) */
+void admision_salir(void);
+
+/* Tras cambiar MAX_CLIENTES o ADMISION_TIMEOUT_MS: admite a los que esperan
+   si ahora hay lugar y recalcula los vencimientos */
+void admision_reconfigurar(void);
+
+/* Conexiones atendidas y en espera ahora, pico de la cola, admitidas tras
+   esperar y descartadas por timeout */
+void admision_estadisticas(int *activos, int *en_espera, int *pico,
+                           uint64_t *tras_espera, uint64_t *vencidos);
+
+#endif // ADMISION_H
@@ -0,0 +1,46 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Arena de memoria: asigna avanzando un puntero dentro de bloques grandes y
+ * libera todo junto con arena_reiniciar. La usan el conjunto de escrituras
+ * de cada transacción (se reinicia en COMMIT/ROLLBACK) y la arena de cada
+ * hilo para lo que dura un comando (respuestas de BUSCAR/FILTRO).
+ *
+ * Una arena es de un solo hilo: no toma locks, así los hilos de atención no
+ * compiten en malloc por cada fila.
+ */
+
+#define ARENA_BLOQUE     (16 * 1024)     /* tamaño mínimo de cada bloque */
+#define ARENA_RETENER    (1024 * 1024)   /* bytes de bloques que se conservan al reiniciar */
+
+typedef struct BloqueArena BloqueArena;
+
+typedef struct {
+    BloqueArena *actual;   /* bloque donde se asigna; encadena los anteriores */
+    BloqueArena *libres;   /* bloques conservados por arena_reiniciar */
+    void *ultimo;          /* última asignación (se puede agrandar en el lugar) */
+} Arena;
+
+void arena_iniciar(Arena *a);
+/* Libera todo lo asignado; conserva hasta ARENA_RETENER bytes de bloques */
+void arena_reiniciar(Arena *a);
+void arena_liberar(Arena *a);
+
+/* Memoria alineada a 16 bytes; NULL sin memoria */
+void *arena_asignar(Arena *a, size_t n);
+/* Agranda p (de tam bytes) a nuevo; si p es la última asignación y cabe, sin copiar */
+void *arena_agrandar(Arena *a, void *p, size_t tam, size_t nuevo);
+/* Copia de linea asegurando un único '\n' final */
+char *arena_copiar_linea(Arena *a, const char *linea);
+
+/* Arena del hilo actual para datos que duran un comando */
+Arena *arena_hilo(void);
+
+/* Asignaciones servidas, bytes servidos, bloques pedidos a malloc y bytes en bloques vivos */
+void arena_estadisticas(uint64_t *asignaciones, uint64_t *bytes, uint64_t *bloques, uint64_t *reservados);
+
+#endif // ARENA_H
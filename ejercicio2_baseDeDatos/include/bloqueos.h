@@ -0,0 +1,43 @@
+#ifndef BLOQUEOS_H
+#define BLOQUEOS_H
+
+#include <stdint.h>
+#include "transaction.h"
+
+/*
+ * Bloqueos por fila (ID) para las escrituras. La tabla de bloqueos está
+ * dividida en BLOQUEO_FRANJAS franjas, cada una con su mutex, así dos
+ * transacciones que tocan IDs distintos no compiten entre sí.
+ *
+ * Los bloqueos son exclusivos y se mantienen hasta COMMIT o ROLLBACK.
+ * Los interbloqueos se evitan con wait-die: cada transacción recibe una marca
+ * al hacer BEGIN; ante un conflicto la más vieja espera y la más nueva aborta.
+ * Una transacción abortada conserva su marca para el siguiente BEGIN, así no
+ * muere indefinidamente. Las lecturas no bloquean (ven lo confirmado).
+ */
+
+#define BLOQUEO_FRANJAS      64     /* potencia de 2 */
+#define LOCK_TIMEOUT_MS_DEF  5000   /* espera máxima por un bloqueo; 0 = sin límite */
+
+#define BLOQUEO_OK       0
+#define BLOQUEO_ABORTA  -1   /* wait-die: la transacción debe abortar */
+#define BLOQUEO_TIMEOUT -2   /* se agotó LOCK_TIMEOUT_MS esperando (o sin memoria) */
+
+extern int LOCK_TIMEOUT_MS;
+
+void bloqueos_iniciar(void);
+
+/* Marca nueva (creciente) para una transacción */
+uint64_t bloqueo_nueva_marca(void);
+
+/* Bloquea el ID para t (reentrante). Devuelve BLOQUEO_OK, BLOQUEO_ABORTA o
+   BLOQUEO_TIMEOUT; en los dos últimos el llamante debe abortar t */
+int bloqueo_adquirir(Transaccion *t, int id);
+
+/* Libera todos los bloqueos de t y despierta a quienes esperaban */
+void bloqueo_liberar_todos(Transaccion *t);
+
+/* Contadores: adquisiciones que esperaron, abortos por wait-die y por timeout */
+void bloqueo_estadisticas(uint64_t *esperas, uint64_t *abortos, uint64_t *timeouts);
+
+#endif // BLOQUEOS_H
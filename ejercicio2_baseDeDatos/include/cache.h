@@ -0,0 +1,42 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "transaction.h"
+
+/*
+ * Cache de resultados de BUSCAR y FILTRO. La clave es el comando normalizado
+ * ("BUSCAR <texto>", "FILTRO <n>") y el valor la respuesta completa.
+ *
+ * Cada COMMIT aplicado incrementa la versión de la base (db_version); al
+ * cambiar, todas las entradas quedan invalidadas. Las entradas se desalojan
+ * por LRU cuando el total supera CACHE_MAX bytes.
+ *
+ * Solo se usa para transacciones sin escrituras propias: con cambios sin
+ * confirmar la respuesta depende de la vista de esa transacción.
+ */
+
+#define CACHE_MAX_DEF  (4L * 1024 * 1024)   /* 0 = sin cache */
+#define CACHE_CUBETAS  4096                 /* potencia de 2 */
+
+extern long CACHE_MAX;
+
+/* Responde desde la cache si hay una entrada vigente para la versión actual.
+   0 si respondió, -1 si hay que ejecutar la consulta (no toma la tabla) */
+int cache_responder(int socket, const char *cmd, const char *arg, const Transaccion *t);
+
+/* Guarda la respuesta de una consulta ejecutada con la base en 'version'.
+   Se llama con todas las particiones tomadas, así la versión no cambia a mitad */
+void cache_guardar(const char *cmd, const char *arg, const Transaccion *t,
+                   uint64_t version, const char *texto, size_t len);
+
+/* Aplica un CACHE_MAX nuevo (desaloja lo que sobre) */
+void cache_reconfigurar(void);
+void cache_vaciar(void);
+
+/* Entradas y bytes en uso, aciertos, fallos, desalojos por LRU e invalidadas por COMMIT */
+void cache_estadisticas(int *entradas, size_t *bytes, uint64_t *aciertos, uint64_t *fallos,
+                        uint64_t *desalojos, uint64_t *invalidadas);
+
+#endif // CACHE_H
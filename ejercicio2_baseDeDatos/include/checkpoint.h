@@ -0,0 +1,42 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+
+/*
+ * Checkpoint: vuelca la tabla confirmada a un nuevo snapshot (CSV escrito en
+ * un temporal y renombrado; msync en el motor binario y fdatasync de los
+ * segmentos en el de log), guarda el LSN que cubre en ARCHIVO_CKPT y trunca
+ * el WAL hasta ese LSN.
+ *
+ * Un hilo de fondo lo ejecuta cada CHECKPOINT_INTERVAL_S segundos o cuando el
+ * WAL supera CHECKPOINT_WAL_MAX bytes. El volcado se hace por tramos,
+ * soltando las particiones de la tabla entre tramos y limitado a CHECKPOINT_KB_S.
+ */
+
+#define CHECKPOINT_INTERVAL_S_DEF 30
+#define CHECKPOINT_WAL_MAX_DEF    (4L * 1024 * 1024)
+#define CHECKPOINT_KB_S_DEF       8192   /* 0 = sin límite */
+
+extern char ARCHIVO_CKPT[512];
+extern int CHECKPOINT_INTERVAL_S;
+extern long CHECKPOINT_WAL_MAX;
+extern int CHECKPOINT_KB_S;
+
+/* LSN cubierto por el último checkpoint (0 si no hay) */
+uint64_t checkpoint_leer_lsn(void);
+
+/* Ejecuta un checkpoint completo. 0 ok, -1 error */
+int checkpoint_ejecutar(void);
+
+/* Reemplaza la tabla por el snapshot CSV ya escrito en 'snapshot' (IMPORTAR):
+   con la tabla bloqueada lo renombra a ARCHIVO_DB, recarga el motor y marca
+   como checkpoint el LSN estable, así los commits anteriores no se vuelven a
+   aplicar y los posteriores se aplican sobre la tabla nueva. 0 ok, -1 error */
+int checkpoint_reemplazar(const char *snapshot);
+
+/* Hilo de fondo */
+int checkpoint_iniciar(void);
+void checkpoint_detener(void);
+
+#endif // CHECKPOINT_H
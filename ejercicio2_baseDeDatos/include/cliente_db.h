@@ -0,0 +1,76 @@
+#ifndef CLIENTE_DB_H
+#define CLIENTE_DB_H
+
+#include <stddef.h>
+
+/*
+ * Biblioteca de cliente del servidor de base de datos.
+ *
+ * Cada ConexionDb es un socket persistente que pide "FIN ON" al conectarse,
+ * así cada respuesta termina en FIN_RESPUESTA y se separa sin esperar
+ * silencio; con CDB_COMPRIMIR pide también "COMPRIMIR ON" y descomprime los
+ * bloques (protocolo.h).
+ *
+ * - Síncrona: cdb_pedir envía un comando y espera su respuesta.
+ * - Asíncrona: cdb_enviar encola el comando con un callback (o
+ *   cdb_enviar_futuro devuelve un FuturoDb) y sigue sin esperar; varios
+ *   comandos viajan seguidos por el mismo socket (pipelining) y un hilo
+ *   lector entrega las respuestas en orden. El servidor procesa los
+ *   comandos de una conexión de a uno, así que el orden está garantizado.
+ * - Pool: PoolDb mantiene N conexiones; cdb_pool_tomar da una en exclusiva
+ *   (para transacciones, que son estado de la conexión) y cdb_pool_enviar
+ *   reparte pedidos sueltos entre las conexiones libres con menos pendientes.
+ *   Las conexiones caídas se reabren al tomarlas.
+ *
+ * Las funciones devuelven 0 ok, -1 error (el motivo queda en cdb_error).
+ */
+
+#define CDB_COMPRIMIR  1          /* pedir respuestas comprimidas */
+#define CDB_BEGIN      2          /* abrir una transacción al conectar (conexiones de lectura del pool) */
+
+#define CDB_TUBERIA_DEF 64        /* comandos en vuelo por conexión antes de bloquear a cdb_enviar */
+
+typedef struct ConexionDb ConexionDb;
+typedef struct FuturoDb FuturoDb;
+typedef struct PoolDb PoolDb;
+
+/* Respuesta de un comando asíncrono: texto (sin la marca de fin, terminado
+   en '\0') válido solo durante el callback; error != 0 si la conexión se
+   cayó antes de la respuesta. Se llama desde el hilo lector de la conexión */
+typedef void (*CallbackDb)(void *ctx, const char *texto, size_t len, int error);
+
+/* ===== Conexión ===== */
+ConexionDb *cdb_conectar(const char *host, int puerto, int opciones, char *error, size_t tam_error);
+/* Cierra el socket; los pedidos pendientes reciben error */
+void cdb_cerrar(ConexionDb *c);
+const char *cdb_saludo(const ConexionDb *c);   /* mensaje de bienvenida del servidor */
+const char *cdb_error(const ConexionDb *c);
+int cdb_socket(const ConexionDb *c);
+int cdb_comprimida(const ConexionDb *c);       /* el servidor aceptó COMPRIMIR ON */
+int cdb_caida(const ConexionDb *c);
+/* Máximo de comandos en vuelo (CDB_TUBERIA_DEF por defecto) */
+void cdb_tuberia(ConexionDb *c, int max);
+
+/* ===== Síncrona ===== */
+/* cmd con o sin '\n' final. texto apunta a un buffer de la conexión, válido
+   hasta el próximo cdb_pedir */
+int cdb_pedir(ConexionDb *c, const char *cmd, const char **texto, size_t *len);
+
+/* ===== Asíncrona ===== */
+int cdb_enviar(ConexionDb *c, const char *cmd, CallbackDb cb, void *ctx);
+FuturoDb *cdb_enviar_futuro(ConexionDb *c, const char *cmd);
+/* Espera la respuesta; texto vale hasta cdb_futuro_liberar */
+int cdb_futuro_esperar(FuturoDb *f, const char **texto, size_t *len);
+void cdb_futuro_liberar(FuturoDb *f);
+/* Espera a que lleguen las respuestas de todo lo enviado */
+void cdb_esperar(ConexionDb *c);
+
+/* ===== Pool ===== */
+PoolDb *cdb_pool_crear(const char *host, int puerto, int conexiones, int opciones,
+                       char *error, size_t tam_error);
+ConexionDb *cdb_pool_tomar(PoolDb *p);       /* NULL si no se pudo reconectar */
+void cdb_pool_devolver(PoolDb *p, ConexionDb *c);
+int cdb_pool_enviar(PoolDb *p, const char *cmd, CallbackDb cb, void *ctx);
+void cdb_pool_cerrar(PoolDb *p);
+
+#endif // CLIENTE_DB_H
@@ -0,0 +1,20 @@
+#ifndef COMPACTADOR_H
+#define COMPACTADOR_H
+
+/*
+ * Compactador del motor de log: un hilo de fondo revisa cada segundo los
+ * segmentos y, cuando en uno la basura recuperable (versiones viejas y
+ * lápidas que ya no tapan nada) supera COMPACTAR_BASURA_PCT de su tamaño,
+ * copia lo vigente al segmento activo por tramos, soltando la tabla entre
+ * tramos, y borra el segmento una vez que lo copiado está en disco.
+ */
+
+#define COMPACTAR_BASURA_PCT_DEF 50   /* 0 = sin compactación */
+
+extern int COMPACTAR_BASURA_PCT;
+
+/* Hilo de fondo (solo con el motor de log) */
+int compactador_iniciar(void);
+void compactador_detener(void);
+
+#endif // COMPACTADOR_H
@@ -0,0 +1,27 @@
+#ifndef COMPRESION_H
+#define COMPRESION_H
+
+#include <stddef.h>
+
+/*
+ * Compresor de bloques estilo LZ4 (mismo formato de secuencias: token con
+ * largo de literales y de coincidencia, literales, distancia de 2 bytes),
+ * sin dependencias externas. Busca coincidencias de 4 bytes con una tabla
+ * hash de posiciones; favorece la velocidad sobre la tasa, que para el texto
+ * CSV de las respuestas ya ronda 3-4x.
+ *
+ * Lo usan el servidor (respuestas grandes con COMPRIMIR ON) y el cliente.
+ */
+
+/* Tamaño máximo que puede ocupar n bytes comprimidos */
+#define COMPRESION_COTA(n) ((n) + (n) / 255 + 16)
+
+/* Comprime n bytes de src en dst (cap bytes). Devuelve el tamaño comprimido
+   o 0 si no entra en cap (el llamante envía el bloque sin comprimir) */
+size_t comprimir_bloque(const char *src, size_t n, char *dst, size_t cap);
+
+/* Descomprime n bytes de src en dst (cap bytes). Devuelve el tamaño
+   original o -1 si el bloque está dañado o no entra en cap */
+long descomprimir_bloque(const char *src, size_t n, char *dst, size_t cap);
+
+#endif // COMPRESION_H
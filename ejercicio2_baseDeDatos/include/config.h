@@ -0,0 +1,26 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+/*
+ * Configuración del servidor: config/server.conf (o la ruta de la variable de
+ * entorno SERVER_CONF), con líneas CLAVE=valor y comentarios con '#'.
+ * Al arrancar se lee antes que los argumentos posicionales, que tienen
+ * prioridad sobre el archivo.
+ *
+ * Con SIGHUP se vuelve a leer el archivo y se aplican en caliente los
+ * parámetros recargables (MAX_CLIENTES, WORKERS, tiempos de espera, commit
+ * agrupado, checkpoint, cache de consultas, métricas) sin cortar conexiones. Los demás (puerto,
+ * rutas, motor, tamaños de colas y anillos de log) solo cambian al reiniciar;
+ * si difieren del valor en uso se avisa en el log.
+ */
+
+#define CONFIG_RUTA_DEF "config/server.conf"
+
+extern char CONFIG_RUTA[512];
+
+/* Lee el archivo. Con recarga != 0 solo aplica las claves recargables.
+   Claves desconocidas o valores inválidos se informan y se ignoran.
+   0 ok, -1 si no se pudo abrir */
+int config_cargar(const char *path, int recarga);
+
+#endif // CONFIG_H
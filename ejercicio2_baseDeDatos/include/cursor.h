@@ -0,0 +1,36 @@
+#ifndef CURSOR_H
+#define CURSOR_H
+
+#include <stddef.h>
+#include "transaction.h"
+
+/*
+ * Cursor de lectura de un cliente: OPEN / FETCH n / CLOSE.
+ *
+ * OPEN copia la vista de la transacción (tabla confirmada + cambios propios)
+ * con copiar_registros mientras tiene todas las particiones; FETCH envía las filas
+ * siguientes de esa copia sin tomar ningún lock, así un cliente lento no
+ * frena a los demás y las páginas son consistentes entre sí aunque se
+ * confirmen otras transacciones en el medio. Cada conexión tiene a lo sumo
+ * un cursor; sobrevive a COMMIT/ROLLBACK y se libera con CLOSE o al
+ * desconectarse.
+ */
+
+typedef struct {
+    char *datos;     /* una línea por registro */
+    size_t len;
+    size_t pos;      /* próximo byte a enviar */
+    long filas;      /* registros en la copia */
+    long enviadas;
+} Cursor;
+
+void cursor_iniciar(Cursor *c);
+/* Reemplaza el cursor por una copia de la vista de t. El llamante debe tener
+   todas las particiones. 0 ok, -1 sin memoria */
+int cursor_abrir(Cursor *c, const Transaccion *t);
+/* Envía hasta n filas más (no toma ningún lock). Devuelve cuántas envió */
+long cursor_leer(Cursor *c, int socket, long n);
+int cursor_abierto(const Cursor *c);
+void cursor_cerrar(Cursor *c);
+
+#endif // CURSOR_H
@@ -1,17 +1,71 @@
 #ifndef DB_H
 #define DB_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include "transaction.h"
+
+/* Campos de ancho fijo (mismos límites que el generador de ejercicio1) */
+#define DESC_MAX  64
+#define FECHA_MAX 16
+#define HORA_MAX  16
+
+/* Registro tipado: ID,Descripcion,Cantidad,Fecha,Hora,Generador */
+typedef struct {
+    int id;
+    char descripcion[DESC_MAX];
+    int cantidad;
+    char fecha[FECHA_MAX];
+    char hora[HORA_MAX];
+    int generador;
+} Producto;
+
+/* Motores de almacenamiento disponibles */
+#define MOTOR_CSV 0   /* tabla de líneas en memoria, snapshot CSV en cada checkpoint */
+#define MOTOR_BIN 1   /* archivo binario mapeado en memoria, escrituras in-place */
+#define MOTOR_COL 2   /* columnas en memoria (struct-of-arrays), snapshot CSV en cada checkpoint */
+#define MOTOR_LOG 3   /* segmentos de solo-agregar con índice en memoria y compactación */
+
 extern char ARCHIVO_DB[512];
+extern char ARCHIVO_BIN[512];
+extern int MOTOR_DB;
+
+/* Inicialización / cierre del motor seleccionado (MOTOR_DB) */
+int abrir_motor(void);
+void cerrar_motor(void);
+int motor_desde_nombre(const char *nombre); /* "csv" | "bin" | "col" | "log", -1 si es inválido */
+const char *motor_nombre(int motor);
+
+/* Conversión texto <-> Producto */
+int id_de_linea(const char *linea);                   /* primer campo, 0 si no es un registro */
+int parsear_producto(const char *linea, Producto *p); /* 0 ok, -1 línea inválida */
+int formatear_producto(const Producto *p, char *buf, size_t size);
+
+/* Consultas: ven la tabla confirmada más los cambios propios de t (puede ser NULL) */
+void mostrar_registros(int socket_cliente, const Transaccion *t, long desde, long limite);
+/* Copia la vista de t a un buffer propio (una línea por registro, terminado en
+   '\0') para enviarlo sin la tabla bloqueada: saltea 'desde' registros y copia
+   hasta 'limite' (-1 = todos). Con todas las particiones tomadas. NULL sin
+   memoria; liberar con free */
+char *copiar_registros(const Transaccion *t, long desde, long limite, size_t *len, long *filas);
+/* Argumentos de MOSTRAR: "[LIMIT n] [OFFSET m]". 0 ok, -1 inválido */
+int limite_offset_arg(const char *arg, long *limite, long *desde);
+void buscar_registro(int socket_cliente, const char *query, const Transaccion *t);
+void filtrar_generador(int socket_cliente, const char *generador, const Transaccion *t);
+/* DML: validan contra la vista de t y registran el cambio en su conjunto de
+   escrituras. Con las particiones de ids_a_bloquear tomadas */
+int agregar_registro(const char *nuevo_registro, Transaccion *t);
+int modificar_registro(int socket_cliente, const char *arg, Transaccion *t); /* formato: "ID;nueva_linea_completa" */
+int eliminar_registro(const char *arg, Transaccion *t);
+/* IDs que escribiría un comando DML (para bloquear sus filas y particiones).
+   Devuelve cuántos dejó en ids (0..2) */
+int ids_a_bloquear(const char *cmd, const char *arg, int ids[2]);
 
-/* Operaciones que usan socket para responder al cliente */
-void mostrar_registros(int socket_cliente);
-void buscar_registro(int socket_cliente, const char *query);
-void filtrar_generador(int socket_cliente, const char *generador);
-/* DML */
-int agregar_registro(const char *nuevo_registro);
-int modificar_registro(int socket_cliente, const char *arg); /* formato: "ID;nueva_linea_completa" */
-int eliminar_registro(const char *arg);
-int rollback_transaccion(void); /* Elimina temp.csv si existe */
-/* Commit de temp.csv sobre la BD (atómico si existe) */
-int commit_temp(void);
-#endif // DB_H
\ No newline at end of file
+/* Aplica a la tabla compartida los cambios de t (ya durables en el WAL).
+   El llamante debe tener las particiones de sus IDs. */
+int aplicar_transaccion(const Transaccion *t);
+/* Aplica una operación del WAL ('A', 'M', 'D'); idempotente para poder reproducir el log */
+int aplicar_operacion(char op, int id, const char *linea);
+/* Versión de la tabla compartida: cambia con cada transacción u operación aplicada */
+uint64_t db_version(void);
+#endif // DB_H
@@ -0,0 +1,58 @@
+#ifndef DB_BIN_H
+#define DB_BIN_H
+
+#include <stdint.h>
+#include "db.h"
+
+/*
+ * Motor binario: archivo de registros de tamaño fijo mapeado con mmap.
+ * Los slots borrados se encadenan en una free-list y se reutilizan, de modo
+ * que MODIFICAR y ELIMINAR escriben un único slot en lugar de reescribir
+ * todo el archivo. Un índice en memoria (hash ID -> slot) evita los recorridos.
+ */
+
+#define BIN_MAGIC   0x31424450u /* "PDB1" */
+#define BIN_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t tam_registro;
+    uint32_t capacidad;  /* slots reservados en el archivo */
+    uint32_t usados;     /* slots asignados alguna vez (marca de agua) */
+    uint32_t vivos;      /* registros ocupados */
+    int32_t  libre;      /* cabeza de la free-list, -1 si está vacía */
+    uint32_t reservado[9];
+} CabeceraBin;           /* 64 bytes */
+
+typedef struct {
+    Producto p;
+    int32_t siguiente_libre; /* siguiente slot libre (solo si !ocupado) */
+    uint8_t ocupado;
+    uint8_t relleno[3];
+} RegistroBin;
+
+/* Abre (o crea) el archivo binario. Si está vacío importa csv_import. */
+int bin_abrir(const char *path, const char *csv_import);
+void bin_cerrar(void);
+
+/* Acceso por ID (NULL si no existe) */
+const Producto *bin_buscar_id(int id);
+
+/* DML in-place (solo cambios ya confirmados en el WAL).
+   Devuelven 0 ok, -1 error / no encontrado / duplicado */
+int bin_insertar(const Producto *p);
+int bin_modificar(int id, const Producto *p);
+int bin_eliminar(int id);
+
+/* Recorre los registros vivos en orden de slot; corta si fn devuelve != 0 */
+void bin_recorrer(int (*fn)(const Producto *p, void *ctx), void *ctx);
+
+/* Fuerza a disco las páginas modificadas (checkpoint) */
+int bin_sincronizar(void);
+
+/* Compatibilidad con el formato CSV */
+int bin_importar_csv(const char *csv_path);
+int bin_exportar_csv(const char *csv_path);
+
+#endif // DB_BIN_H
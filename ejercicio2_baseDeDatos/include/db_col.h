@@ -0,0 +1,58 @@
+#ifndef DB_COL_H
+#define DB_COL_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "db.h"
+
+/*
+ * Motor columnar: la tabla se guarda en memoria como un arreglo por campo
+ * (struct-of-arrays) en lugar de una línea de texto por fila.
+ *
+ *   id, cantidad, generador  int32
+ *   fecha                    uint32 AAAAMMDD
+ *   hora                     uint32 segundos desde 00:00:00
+ *   descripcion              uint32 desplazamiento en un heap de cadenas
+ *
+ * Las descripciones se internan (cadenas iguales comparten lugar en el
+ * heap). Una fecha u hora que no tiene el formato canónico se guarda como
+ * cadena en el heap con COL_EN_HEAP encendido, así el texto vuelve igual.
+ *
+ * Un filtro sobre una columna entera (FILTRO por generador) recorre solo
+ * ese arreglo: 4 bytes por fila en lugar de la línea completa. Como el
+ * motor CSV, persiste con snapshots CSV en cada checkpoint.
+ */
+
+#define COL_EN_HEAP  0x80000000u   /* fecha/hora: el resto es desplazamiento en el heap */
+
+typedef enum { COL_ID, COL_CANTIDAD, COL_GENERADOR } ColumnaCol;
+
+int col_abrir(const char *csv_path);
+void col_cerrar(void);
+
+int col_existe(int id);
+
+/* Reemplaza el registro p->id si existe o lo agrega al final. 0 ok, -1 error */
+int col_poner(const Producto *p);
+int col_borrar(int id);
+
+/* Recorre las filas vivas en orden, armando la línea CSV de cada una
+   (mismo contrato que csv_recorrer); corta si fn devuelve != 0 */
+void col_recorrer(int (*fn)(int id, const char *linea, void *ctx), void *ctx);
+/* Igual, pero solo arma las filas cuya columna vale 'valor' */
+void col_filtrar(ColumnaCol col, int valor, int (*fn)(int id, const char *linea, void *ctx), void *ctx);
+
+/* Filas cuya línea contiene texto (BUSCAR). Un texto sin ',' que no puede
+   ser parte de un número, fecha u hora solo se busca en las cadenas */
+void col_buscar(const char *texto, int (*fn)(int id, const char *linea, void *ctx), void *ctx);
+
+/* Volcado por tramos para el checkpoint (mismo contrato que csv_volcar) */
+size_t col_posiciones(void);
+size_t col_volcar(FILE *f, size_t desde, size_t max_filas, size_t *bytes);
+void col_pausar_compactacion(int pausar);
+
+/* Filas vivas, bytes de las columnas y del heap de cadenas (sin lock: aproximado) */
+void col_estadisticas(size_t *filas, size_t *bytes_columnas, size_t *bytes_heap);
+
+#endif // DB_COL_H
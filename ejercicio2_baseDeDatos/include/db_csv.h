@@ -0,0 +1,45 @@
+#ifndef DB_CSV_H
+#define DB_CSV_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Motor CSV: la tabla se carga en memoria como líneas de texto con un índice
+ * ID -> posición. Las filas se reparten en las particiones de particiones.h,
+ * cada una con sus filas y su índice, así dos hilos con particiones distintas
+ * pueden cambiarlas a la vez. Cada fila guarda su número de orden de llegada
+ * y los recorridos mezclan las particiones por ese número: se ven en el orden
+ * del archivo, con las filas nuevas al final. Los cambios confirmados se
+ * aplican en memoria y quedan durables en el WAL; el archivo CSV solo se
+ * reescribe en cada checkpoint.
+ */
+
+typedef struct {
+    int id;          /* 0 para líneas que no son registros (encabezado, #MISSING...) */
+    uint64_t orden;  /* orden de llegada, creciente dentro de cada partición */
+    char *linea;     /* termina en '\n'; NULL si la fila fue borrada */
+} FilaCsv;
+
+int csv_abrir(const char *path);
+void csv_cerrar(void);
+
+/* Línea del registro con ese ID o NULL (con su partición tomada) */
+const char *csv_buscar_id(int id);
+
+/* Reemplaza la línea del ID si existe o la agrega al final. 0 ok, -1 error */
+int csv_poner(int id, const char *linea);
+int csv_borrar(int id);
+
+/* Recorre las filas vivas en orden; corta si fn devuelve != 0 */
+void csv_recorrer(int (*fn)(int id, const char *linea, void *ctx), void *ctx);
+
+/* Volcado por tramos para el checkpoint: las posiciones son números de orden.
+   Escribe hasta max_filas filas desde 'desde' y devuelve la siguiente posición
+   (== csv_posiciones() al final). Las filas borradas o agregadas entre tramos
+   no corren las posiciones */
+size_t csv_posiciones(void);
+size_t csv_volcar(FILE *f, size_t desde, size_t max_filas, size_t *bytes);
+
+#endif // DB_CSV_H
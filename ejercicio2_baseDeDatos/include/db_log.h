@@ -0,0 +1,91 @@
+#ifndef DB_LOG_H
+#define DB_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Motor de log: la tabla vive en segmentos de solo-agregar
+ * (ARCHIVO_SEG.000001, .000002, ...). Cada cambio aplicado agrega un
+ * registro al segmento activo: la línea nueva (AGREGAR, MODIFICAR) o una
+ * lápida (ELIMINAR), así escribir cuesta lo mismo sea cual sea el tamaño de
+ * la tabla. Un índice en memoria (ID -> segmento y desplazamiento) apunta a
+ * la última versión y las lecturas la toman de los segmentos mapeados.
+ *
+ * Las versiones viejas y las lápidas son basura. El compactador
+ * (compactador.c) copia al segmento activo los registros vigentes de un
+ * segmento con mucha basura y después lo borra. El checkpoint solo hace
+ * fdatasync de los segmentos escritos.
+ *
+ *   segmento:  CabeceraSegLog, registros
+ *   registro:  CabeceraRegLog, línea con '\n' y '\0' (nada en una lápida),
+ *              relleno hasta múltiplo de 8
+ *
+ * Al abrir se recorren los segmentos en orden; un registro cortado o con la
+ * suma mal al final del último segmento (caída a mitad de una escritura) se
+ * descarta y el WAL vuelve a aplicar lo que faltaba.
+ */
+
+#define SEG_MAGIA     0x31474c50u /* "PLG1" */
+#define SEG_VERSION   1
+#define REG_MAGIA     0x47455250u /* "PREG" */
+
+#define SEGMENTO_KB_DEF  65536    /* tamaño a partir del cual se abre otro segmento */
+
+typedef struct {
+    uint32_t magia;
+    uint32_t version;
+    uint32_t numero;
+    uint32_t reservado[5];
+} CabeceraSegLog;        /* 32 bytes */
+
+typedef struct {
+    uint32_t magia;      /* REG_MAGIA */
+    uint32_t suma;       /* FNV-1a de id, largo y la línea */
+    int32_t id;
+    uint32_t largo;      /* bytes de la línea con '\n' y '\0'; 0 = lápida */
+} CabeceraRegLog;        /* 16 bytes */
+
+extern char ARCHIVO_SEG[512];
+extern int SEGMENTO_KB;
+
+/* Abre los segmentos de ARCHIVO_SEG. Si no hay ninguno importa csv_import */
+int dblog_abrir(const char *csv_import);
+void dblog_cerrar(void);
+/* Borra todos los segmentos de prefijo (la tabla se vuelve a importar) */
+int dblog_eliminar_segmentos(const char *prefijo);
+
+/* Línea vigente del ID o NULL. Válida mientras no cambie la tabla */
+const char *dblog_buscar_id(int id);
+/* Agrega la versión nueva del ID / su lápida. 0 ok, -1 error */
+int dblog_poner(int id, const char *linea);
+int dblog_borrar(int id);
+/* Recorre las filas vivas; corta si fn devuelve != 0 */
+void dblog_recorrer(int (*fn)(int id, const char *linea, void *ctx), void *ctx);
+
+/* fdatasync de los segmentos escritos desde la última vez (checkpoint) */
+int dblog_sincronizar(void);
+
+/* Compactación por tramos (con la tabla bloqueada en cada llamada) */
+typedef struct {
+    uint32_t numero;     /* segmento que se compacta */
+    uint32_t generacion; /* se invalida si la tabla se reabrió (IMPORTAR) */
+    size_t pos;          /* próximo registro a revisar */
+    size_t copiados;     /* bytes reescritos en el segmento activo */
+} CompactacionLog;
+/* Elige el segmento con más basura recuperable si supera pct% de su tamaño
+   (sellando el activo si es él). 0 si no hay ninguno */
+int dblog_elegir(int pct, CompactacionLog *c);
+/* Copia hasta max_regs registros vigentes. 1 si quedan, 0 terminado, -1 error */
+int dblog_compactar(CompactacionLog *c, size_t max_regs);
+/* Borra el segmento ya compactado (sincroniza antes los destinos). 0 ok */
+int dblog_retirar(const CompactacionLog *c);
+
+/* Segmentos, filas vivas, bytes en disco y bytes de basura (aproximado) */
+void dblog_estadisticas(size_t *segmentos, size_t *filas, size_t *bytes, size_t *basura);
+
+/* Compatibilidad con el formato CSV */
+int dblog_importar_csv(const char *csv_path);
+int dblog_exportar_csv(const char *csv_path);
+
+#endif // DB_LOG_H
@@ -0,0 +1,40 @@
+#ifndef IMPORTAR_H
+#define IMPORTAR_H
+
+#include <stdint.h>
+
+/*
+ * Importación masiva: arma un snapshot CSV nuevo a partir de un archivo del
+ * generador (CSV de productos.c) o de un archivo del motor binario.
+ *
+ * El origen se mapea con mmap y se divide en tramos alineados a '\n'; cada
+ * hilo valida las filas de su tramo sin copiarlas con parser_csv (6 campos,
+ * ID > 0, enteros completos y textos que entran en Producto). Luego se descartan los
+ * IDs repetidos (queda la primera aparición) con un índice dimensionado de una
+ * vez y las filas válidas se escriben en un temporal que se renombra a destino.
+ *
+ * El servidor (comando IMPORTAR) reemplaza la tabla con ese snapshot mediante
+ * checkpoint_reemplazar; la herramienta bin/importar lo deja listo sin servidor.
+ */
+
+#define IMPORTAR_TRAMO_MIN (1024 * 1024) /* bytes de origen por hilo como mínimo */
+#define IMPORTAR_HILOS_MAX 16
+
+extern int IMPORTAR_HILOS; /* 0 = uno por CPU */
+
+typedef struct {
+    long filas;       /* filas escritas en el snapshot */
+    long invalidas;   /* líneas que no son un registro válido */
+    long duplicadas;  /* IDs repetidos (se conserva el primero) */
+    int binario;      /* el origen era un archivo del motor binario */
+    int hilos;
+    double ms_lectura; /* mapeo, validación y deduplicación */
+    double ms_total;
+    char error[256];   /* motivo si falló */
+} ResultadoImportar;
+
+/* Valida origen y escribe el snapshot en destino (temporal + rename + fsync).
+   0 ok, -1 error (el motivo queda en r->error y en el log) */
+int importar_snapshot(const char *origen, const char *destino, ResultadoImportar *r);
+
+#endif // IMPORTAR_H
@@ -0,0 +1,33 @@
+#ifndef INDICE_H
+#define INDICE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Índice hash ID -> posición (direccionamiento abierto, sondeo lineal) */
+
+typedef struct {
+    int id;       /* 0 = vacío, -1 = borrado */
+    int32_t pos;
+} EntradaIdx;
+
+typedef struct {
+    EntradaIdx *t;
+    size_t cap;     /* potencia de 2 */
+    size_t usadas;  /* ocupadas + borradas */
+    size_t vivas;
+} IndiceId;
+
+void indice_iniciar(IndiceId *ix);
+void indice_liberar(IndiceId *ix);
+void indice_vaciar(IndiceId *ix);
+/* Dimensiona la tabla para n IDs de una vez (carga masiva). 0 ok, -1 sin memoria */
+int indice_reservar(IndiceId *ix, size_t n);
+
+/* Devuelve la posición asociada o -1 si el ID no está */
+int32_t indice_buscar(const IndiceId *ix, int id);
+/* Inserta o actualiza; ids <= 0 no se indexan. 0 ok, -1 sin memoria */
+int indice_poner(IndiceId *ix, int id, int32_t pos);
+void indice_borrar(IndiceId *ix, int id);
+
+#endif // INDICE_H
@@ -0,0 +1,65 @@
+#ifndef METRICAS_H
+#define METRICAS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Métricas internas del servidor: contadores y un histograma de latencias
+ * log-lineal (estilo HDR: 16 sub-cubetas por potencia de 2, error < 7%) por
+ * tipo de comando, más el tiempo de espera de las particiones, de los
+ * bloqueos de fila y de la cola de admisión. Registrar es un par de sumas atómicas, sin locks.
+ *
+ * Se consultan con el comando STATS y se vuelcan al log de debug cada
+ * METRICAS_INTERVALO_S segundos.
+ */
+
+#define METRICAS_INTERVALO_S_DEF 60   /* 0 = sin volcado periódico */
+
+typedef enum {
+    MET_MOSTRAR = 0,
+    MET_BUSCAR,
+    MET_FILTRO,
+    MET_AGREGAR,
+    MET_MODIFICAR,
+    MET_ELIMINAR,
+    MET_BEGIN,
+    MET_COMMIT,
+    MET_ROLLBACK,
+    MET_STATS,
+    MET_OTRO,
+    MET_ESPERA_PARTICION, /* espera para tomar particiones de la tabla */
+    MET_ESPERA_FILA,      /* espera por un bloqueo de fila */
+    MET_ESPERA_ADMISION,  /* espera en la cola de admisión (conexiones admitidas) */
+    MET_TOTAL
+} Metrica;
+
+extern int METRICAS_INTERVALO_S;
+
+/* Reloj monotónico en nanosegundos */
+uint64_t metricas_ahora_ns(void);
+
+/* Métrica correspondiente a un comando (en mayúsculas) */
+Metrica metrica_de_comando(const char *cmd);
+/* Nombre de una métrica (el del comando para las de comandos) */
+const char *metricas_nombre(Metrica m);
+
+/* Suma una muestra de ns nanosegundos al histograma de m */
+void metricas_registrar(Metrica m, uint64_t ns);
+
+/* Conexiones y tráfico */
+void metricas_conexion_abierta(void);
+void metricas_conexion_cerrada(void);
+void metricas_conexion_rechazada(void);
+void metricas_bytes_recibidos(size_t n);
+
+/* Escribe el reporte en buf (texto, una línea por métrica). Devuelve la longitud */
+size_t metricas_formatear(char *buf, size_t size);
+
+/* Volcado periódico al log */
+int metricas_iniciar(void);
+void metricas_detener(void);
+/* Aplica un METRICAS_INTERVALO_S nuevo (arranca el volcado si no estaba) */
+int metricas_reconfigurar(void);
+
+#endif // METRICAS_H
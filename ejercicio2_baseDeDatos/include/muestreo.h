@@ -0,0 +1,27 @@
+#ifndef MUESTREO_H
+#define MUESTREO_H
+
+/*
+ * Muestreo del proceso para el log de debug: cada MUESTREO_INTERVALO_S
+ * segundos un hilo lee /proc/self (hilos, RSS y su pico, tiempo de CPU,
+ * fallos de página, descriptores abiertos y cuántos son sockets), el estado
+ * de los sockets TCP (TCP_INFO) y los cambios de contexto de todos los hilos
+ * (getrusage), y escribe dos líneas compactas con lo acumulado y el ritmo
+ * desde la muestra anterior.
+ *
+ * Reemplaza a los netstat/ss/lsof/ps lanzados con popen: una muestra son
+ * unas pocas lecturas de /proc sin crear procesos (la línea incluye lo que
+ * tardó).
+ */
+
+#define MUESTREO_INTERVALO_S_DEF 10   /* 0 = sin muestreo */
+
+extern int MUESTREO_INTERVALO_S;
+
+/* Hilo de muestreo */
+int muestreo_iniciar(void);
+void muestreo_detener(void);
+/* Aplica un MUESTREO_INTERVALO_S nuevo (arranca el hilo si no estaba) */
+int muestreo_reconfigurar(void);
+
+#endif // MUESTREO_H
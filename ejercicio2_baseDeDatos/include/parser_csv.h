@@ -0,0 +1,44 @@
+#ifndef PARSER_CSV_H
+#define PARSER_CSV_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "db.h"
+
+/*
+ * Lectura de líneas CSV sin copiarlas: csv_separar ubica las comas y el fin
+ * de línea recorriendo 16 bytes por instrucción (SSE2; hay una versión escalar
+ * para otras arquitecturas) y deja cada campo como puntero + largo dentro de
+ * la línea original. Sobre eso, csv_entero y csv_producto convierten a tipos
+ * validando el campo completo (sin la basura final que atoi deja pasar).
+ *
+ * La usan db.c (parsear_producto y los argumentos de los comandos), la
+ * importación masiva y el validador de ejercicio1_productos.
+ */
+
+#define CSV_CAMPOS_MAX 16
+
+typedef struct {
+    const char *campo[CSV_CAMPOS_MAX];
+    uint32_t largo[CSV_CAMPOS_MAX];
+    int n;             /* campos encontrados */
+    const char *fin;   /* '\n', '\r', '\0' o el límite donde terminó la línea */
+} CamposCsv;
+
+/* Separa la línea que empieza en p hasta '\n', '\r', '\0' o fin (NULL = sin
+   límite: la línea termina en alguno de esos caracteres). Devuelve la cantidad
+   de campos o -1 si hay más de CSV_CAMPOS_MAX */
+int csv_separar(const char *p, const char *fin, CamposCsv *c);
+
+/* Entero decimal con signo opcional que ocupa los n bytes. 0 ok, -1 inválido
+   (vacío, otros caracteres o fuera de rango de int) */
+int csv_entero(const char *s, size_t n, int *v);
+
+/* Registro ID,Descripcion,Cantidad,Fecha,Hora,Generador: exactamente 6
+   campos, ID > 0, enteros válidos y textos sin caracteres de control que
+   entran en Producto sin truncar. 0 ok, -1 inválido */
+int csv_producto(const char *p, const char *fin, Producto *prod);
+/* Igual, a partir de una línea ya separada */
+int csv_campos_producto(const CamposCsv *c, Producto *prod);
+
+#endif // PARSER_CSV_H
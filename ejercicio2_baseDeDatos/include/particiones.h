@@ -0,0 +1,39 @@
+#ifndef PARTICIONES_H
+#define PARTICIONES_H
+
+#include <stdint.h>
+
+/*
+ * Particiones de la tabla compartida. Las filas se reparten por hash del ID
+ * en PARTICIONES_TABLA particiones, cada una con su mutex: AGREGAR, MODIFICAR
+ * y ELIMINAR toman solo las de sus IDs, así escrituras sobre IDs de
+ * particiones distintas avanzan en paralelo. Un COMMIT toma las de todos los
+ * IDs de su conjunto de escrituras y los recorridos (MOSTRAR, BUSCAR, FILTRO,
+ * OPEN, checkpoint, IMPORTAR, compactación) toman todas. Siempre se toman en
+ * orden creciente, así dos hilos nunca se esperan en círculo.
+ *
+ * El motor csv guarda cada partición por separado (filas e índice propios);
+ * bin, col y log usan una sola, que equivale a un mutex para toda la tabla.
+ */
+
+#define PARTICIONES_DEF  16   /* se redondea a potencia de 2 */
+#define PARTICIONES_MAX  64   /* caben en una máscara de 64 bits */
+
+extern int PARTICIONES_TABLA;
+
+/* Fija cuántas particiones se usan; antes de abrir el motor */
+void particiones_configurar(int n);
+int particiones_cantidad(void);
+/* Partición del ID (los que no son registros van a la 0) */
+int particion_de(int id);
+
+/* Conjuntos de particiones como máscara de bits */
+static inline uint64_t particion_mascara(int id) { return 1ULL << particion_de(id); }
+uint64_t particiones_todas(void);
+
+/* Toma las particiones de la máscara en orden creciente. Devuelve los ns
+   que tuvo que esperar (0 si estaban libres) */
+uint64_t particiones_bloquear(uint64_t mascara);
+void particiones_desbloquear(uint64_t mascara);
+
+#endif // PARTICIONES_H
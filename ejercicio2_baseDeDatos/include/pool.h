@@ -0,0 +1,42 @@
+#ifndef POOL_H
+#define POOL_H
+
+/*
+ * Pool de hilos para atender conexiones. Los hilos se crean al arrancar y
+ * atienden una conexión tras otra, así un cliente de vida corta no paga la
+ * creación de un hilo.
+ *
+ * El hilo de accept deja el socket en una cola circular sin locks (varios
+ * productores / varios consumidores, con número de secuencia por celda) y
+ * despierta a un hilo libre con un semáforo.
+ *
+ * Cada hilo atiende una conexión completa, de modo que con menos hilos que
+ * MAX_CLIENTES las conexiones admitidas esperan en la cola a que se libere uno.
+ */
+
+#define POOL_HILOS_DEF  0      /* 0 = tantos como MAX_CLIENTES */
+#define POOL_COLA       1024   /* sockets pendientes de atender; potencia de 2 */
+#define POOL_CIERRE_S   5      /* espera por los comandos en curso al cerrar */
+
+extern int POOL_HILOS;
+
+/* Crea n hilos que ejecutan atender(socket) para cada conexión despachada.
+   0 ok, -1 si no se pudo crear ninguno */
+int pool_iniciar(int n, void (*atender)(int socket));
+
+/* Crea o retira hilos hasta tener n (los retirados terminan al quedar libres).
+   0 ok, -1 si no se llegó a n */
+int pool_redimensionar(int n);
+
+/* Encola una conexión aceptada. 0 ok, -1 si la cola está llena */
+int pool_despachar(int socket);
+
+/* Cierre: corta la lectura de las conexiones en curso (cada una termina el
+   comando que está ejecutando), retira todos los hilos y espera a que
+   terminen. Pasados POOL_CIERRE_S corta también la escritura */
+void pool_detener(void);
+
+/* Hilos creados, hilos atendiendo una conexión y conexiones en cola */
+void pool_estadisticas(int *hilos, int *ocupados, int *encolados);
+
+#endif // POOL_H
@@ -0,0 +1,33 @@
+#ifndef PROTOCOLO_H
+#define PROTOCOLO_H
+
+/*
+ * Protocolo cliente-servidor: un comando por línea, respuesta en texto.
+ * El cliente puede mandar varios comandos sin esperar las respuestas
+ * (pipelining): el servidor los atiende de a uno y responde en orden.
+ *
+ * Las respuestas no tienen largo fijo (MOSTRAR devuelve N líneas). Para
+ * separarlas el cliente pide "FIN ON": a partir de ahí el servidor termina
+ * cada respuesta con la línea FIN_RESPUESTA (cliente_db.h lo hace al
+ * conectarse). Las marcas del protocolo son caracteres de control y
+ * csv_campos_producto (parser_csv.h) rechaza registros con caracteres de
+ * control en los textos, así que nunca aparecen en los datos.
+ */
+
+#define FIN_RESPUESTA     "\x04\n"
+#define FIN_RESPUESTA_LEN 2
+
+/*
+ * Compresión por conexión: el cliente la pide con "COMPRIMIR ON" al
+ * conectarse. Desde ahí las respuestas de al menos COMPRESS_MIN_BYTES se
+ * envían en bloques de hasta COMPRIMIDO_BLOQUE bytes originales, cada uno
+ * como COMPRIMIDO_MARCA + largo original (4 bytes, little endian) + largo
+ * comprimido (4 bytes) + datos (compresion.h). El resto de la respuesta
+ * sigue en texto; por la misma razón la marca no aparece en los datos.
+ */
+
+#define COMPRIMIDO_MARCA    '\x01'
+#define COMPRIMIDO_CABECERA 9
+#define COMPRIMIDO_BLOQUE   (256 * 1024)
+
+#endif // PROTOCOLO_H
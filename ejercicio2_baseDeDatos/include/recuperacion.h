@@ -0,0 +1,27 @@
+#ifndef RECUPERACION_H
+#define RECUPERACION_H
+
+#include <stdint.h>
+
+/*
+ * Recuperación al arrancar: carga el último snapshot (CSV en memoria o el
+ * archivo binario mapeado con mmap) y reproduce solo los bloques confirmados
+ * del WAL posteriores al checkpoint.
+ *
+ * El WAL se mapea en memoria y se divide en tramos alineados a bloques "T";
+ * cada tramo se analiza en un hilo. Solo el análisis es paralelo: las
+ * operaciones de todos los tramos se aplican después en un único hilo, en
+ * orden de LSN, porque un ID que no está se agrega al final y el orden de
+ * aplicación decide el orden de las filas.
+ */
+
+#define RECUPERACION_TRAMO_MIN (256 * 1024) /* bytes de WAL por hilo como mínimo */
+#define RECUPERACION_HILOS_MAX 16
+
+extern int RECUPERACION_HILOS; /* 0 = uno por CPU */
+
+/* Abre el motor y aplica el WAL. En *lsn deja el último LSN confirmado
+   (checkpoint o WAL) para continuar la numeración. 0 ok, -1 error */
+int recuperar_base(uint64_t *lsn);
+
+#endif // RECUPERACION_H
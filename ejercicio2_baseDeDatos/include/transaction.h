@@ -1,13 +1,43 @@
 #ifndef TRANSACTION_H
 #define TRANSACTION_H
 
-// Función para iniciar una transacción
-void begin_transaction(void);
+#include <stddef.h>
+#include <stdint.h>
+#include "indice.h"
+#include "arena.h"
 
-// Función para confirmar una transacción
-void commit_transaction(void);
+// Valor final de un registro tocado por la transacción
+typedef struct {
+    int id;
+    char *linea;   // termina en '\n'; NULL si la transacción lo eliminó (vive en la arena)
+    int en_base;   // el ID existía en la tabla confirmada al tocarlo
+} CambioTrans;
 
-// Función para cancelar una transacción
-void rollback_transaction(void);
+// Conjunto de escrituras de una transacción: no se aplica a la tabla compartida
+// hasta el COMMIT, así ROLLBACK solo descarta memoria
+typedef struct {
+    CambioTrans *cambios;
+    size_t n, cap;
+    IndiceId idx;      // id -> posición en cambios
+    Arena mem;         // líneas de los cambios; se libera entera en trans_reset
+    char *ops;         // serialización para el WAL ("A|M <id> <linea>", "D <id>")
+    size_t len, cap_ops;
+    uint64_t marca;    // orden de la transacción para wait-die (0 = sin asignar)
+    int *bloqueados;   // IDs bloqueados por la transacción (ver bloqueos.h)
+    size_t n_bloq, cap_bloq;
+} Transaccion;
+
+// Inicializa / vacía / libera el conjunto de escrituras
+void trans_iniciar(Transaccion *t);
+void trans_reset(Transaccion *t);
+void trans_liberar(Transaccion *t);
+
+// Cambio registrado para un ID o NULL si la transacción no lo tocó
+const CambioTrans *trans_buscar(const Transaccion *t, int id);
+// Registra el valor final de un ID (linea NULL = eliminado)
+int trans_poner(Transaccion *t, int id, const char *linea, int en_base);
+// Serializa los cambios en t->ops con el formato del WAL (largo en t->len,
+// 0 si no hay nada que registrar). 0 ok, -1 sin memoria
+int trans_serializar(Transaccion *t);
 
 #endif // TRANSACTION_H
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef TRAZA_H
+#define TRAZA_H
+
+#include <stdint.h>
+
+/*
+ * Traza de tramos por pedido: cada hilo anota en un anillo propio (sin
+ * locks) el nombre, el inicio y la duración de los tramos de un pedido
+ * (recepción, parseo, esperas de particiones y de filas, recorrido de la
+ * tabla, WAL, envío). Con la traza apagada cada punto cuesta una lectura
+ * de TRAZA_ACTIVA.
+ *
+ * TRAZA VOLCAR escribe los anillos en formato de eventos de Chrome
+ * (chrome://tracing, Perfetto): un evento "X" por tramo, un tid por hilo y
+ * el número de pedido en args. Cada anillo guarda los últimos
+ * TRAZA_EVENTOS tramos de su hilo.
+ */
+
+#define TRAZA_EVENTOS_DEF 8192          /* tramos por hilo */
+#define TRAZA_RUTA_DEF    "traza.json"  /* TRAZA VOLCAR sin nombre y SIGUSR1 (junto a LOG_PATH) */
+
+extern int TRAZA_ACTIVA;
+extern int TRAZA_EVENTOS;
+
+/* Inicio de un tramo: 0 con la traza apagada (traza_fin lo ignora) */
+uint64_t traza_inicio(void);
+/* Cierra el tramo empezado en inicio. nombre debe ser una cadena constante
+   (se guarda el puntero, no una copia) */
+void traza_fin(const char *nombre, uint64_t inicio);
+/* Los tramos siguientes del hilo pertenecen a un pedido nuevo */
+void traza_nuevo_pedido(void);
+
+/* Enciende o apaga la traza (TRAZA ON/OFF) */
+void traza_activar(int activa);
+/* Escribe los tramos en ruta. Devuelve la cantidad de eventos, -1 si falla */
+long traza_volcar(const char *ruta);
+
+#endif // TRAZA_H
@@ -4,16 +4,32 @@
 #include <stddef.h>
 #include <stdint.h>
 
+/* Mensajes que puede acumular el anillo de log de cada hilo antes de
+   descartar (se redondea a potencia de 2; aplica a los hilos nuevos) */
+#define LOG_ANILLO_SLOTS_DEF 512
+
+extern int LOG_ANILLO_SLOTS;
+
+/* Respuestas desde este tamaño se comprimen si la conexión lo pidió (0 = nunca) */
+#define COMPRESION_MIN_DEF 4096
+
+extern int COMPRESION_MIN;
+
 void init_logger(const char *path, uint8_t foreground);
 void close_logger(void);
 void log_msg(const char *fmt, ...);
-void log_monitoring_snapshot(void);
 
 void init_action_logger(const char *path, uint8_t foreground);
 void close_action_logger(void);
 void log_action(const char *fmt, ...);
 
 void enviar(int socket, const char *mensaje);
+void enviar_bytes(int socket, const char *datos, size_t n);
+/* Compresión de lo que envía este hilo (la conexión que atiende); ver protocolo.h */
+void enviar_comprimido(int activo);
+/* Bloques comprimidos enviados y sus bytes antes y después de comprimir */
+void compresion_estadisticas(uint64_t *bloques, uint64_t *originales, uint64_t *comprimidos);
+uint64_t total_bytes_enviados(void); /* bytes enviados con enviar() */
 void recibir(int socket, char *buffer, size_t size);
 void error(const char *mensaje);
 void cerrar_socket(int socket);
@@ -0,0 +1,56 @@
+#ifndef WAL_H
+#define WAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Log de escritura anticipada (WAL) con commit agrupado.
+ *
+ * Cada transacción confirmada se escribe como un bloque de texto:
+ *   T <lsn>
+ *   A <id> <linea>        (AGREGAR)
+ *   M <id> <linea>        (MODIFICAR)
+ *   D <id>                (ELIMINAR)
+ *   C <lsn>
+ * Solo los bloques con su línea C completa se consideran confirmados.
+ *
+ * Los commits que llegan dentro de la ventana GROUP_COMMIT_US se escriben
+ * juntos con un único fdatasync; cada llamante vuelve cuando su bloque es
+ * durable.
+ */
+
+#define GROUP_COMMIT_US_DEF 2000      /* ventana de agrupación (microsegundos) */
+#define WAL_LOTE_MAX        (1 << 20) /* bytes pendientes que fuerzan la escritura */
+
+extern char ARCHIVO_WAL[512];
+extern int GROUP_COMMIT_US;
+
+/* Abre el log para agregar. lsn_base es el último LSN confirmado que encontró
+   la recuperación (checkpoint o WAL): la numeración continúa desde ahí */
+int wal_abrir(const char *path, uint64_t lsn_base);
+void wal_cerrar(void);
+
+/* Escribe de forma durable las operaciones de una transacción.
+   Devuelve el LSN asignado (> 0) o 0 si hubo error de E/S. Un error de E/S
+   deja el WAL fuera de servicio: los commits siguientes devuelven 0 hasta
+   reiniciar. Tras un commit exitoso el llamante aplica los cambios y luego
+   llama a wal_aplicado(lsn). */
+uint64_t wal_commit(const char *ops, size_t len);
+void wal_aplicado(uint64_t lsn);
+
+/* Último LSN durable */
+uint64_t wal_lsn(void);
+/* Mayor LSN L tal que todo commit con LSN <= L ya está aplicado en la tabla
+   (los commits se aplican en paralelo, no necesariamente en orden) */
+uint64_t wal_lsn_aplicado(void);
+
+/* Tamaño actual del archivo de log en bytes */
+long wal_tamano(void);
+/* Descarta los bloques con LSN <= hasta (ya incluidos en un checkpoint) */
+int wal_truncar(uint64_t hasta);
+
+/* Contadores: commits escritos y fdatasync realizados */
+void wal_estadisticas(uint64_t *commits, uint64_t *syncs);
+
+#endif // WAL_H
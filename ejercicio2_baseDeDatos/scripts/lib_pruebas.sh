@@ -0,0 +1,106 @@
+#!/bin/bash
+# Funciones comunes de las pruebas contra el servidor. Cada prueba define
+# PREFIJO y PORT y la incluye con:
+#   source "$(dirname "$0")/lib_pruebas.sh"
+# Deja el directorio de trabajo en ROOT, crea TMP (se borra al salir junto
+# con el servidor que haya quedado en PID_SRV) y guarda lo que recibe cada
+# cliente en scripts/logs/PREFIJO_NOMBRE.out.
+# Las pruebas salen con código distinto de 0 si falla alguna verificación.
+
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+cd "$ROOT"
+
+TMP="$(mktemp -d)"
+PID_SRV=""
+CLIENTES=()
+FALLOS=0
+mkdir -p scripts/logs
+rm -f "scripts/logs/${PREFIJO}"_*.out
+
+trap '[ -n "$PID_SRV" ] && kill -9 "$PID_SRV" 2>/dev/null; rm -rf "$TMP"' EXIT
+
+# salida NOMBRE: archivo con lo recibido por el cliente NOMBRE
+salida() {
+  echo "scripts/logs/${PREFIJO}_$1.out"
+}
+
+# detener SEÑAL: manda la señal al servidor (INT = cierre ordenado, 9 = caída)
+# y espera a que termine
+detener() {
+  kill "-$1" "$PID_SRV" 2>/dev/null
+  wait "$PID_SRV" 2>/dev/null
+  PID_SRV=""
+}
+
+# sesion NOMBRE ESPERA comandos...: los manda juntos y espera ESPERA segundos
+# (entero) lo que responda el servidor
+sesion() {
+  local out espera="$2"
+  out="$(salida "$1")"; shift 2
+  (
+    exec 3<>/dev/tcp/127.0.0.1/$PORT || exit 1
+    timeout $((espera + 2)) cat <&3 > "$out" & lector=$!
+    for c in "$@"; do printf "%s\n" "$c" >&3; done
+    sleep "$espera"
+    kill "$lector" 2>/dev/null || true
+    exec 3>&-
+  )
+}
+
+# cliente NOMBRE pasos...: como sesion pero en segundo plano; cada paso es un
+# comando o "+S" (esperar S segundos). esperar aguarda a los clientes lanzados
+cliente() {
+  local out
+  out="$(salida "$1")"; shift
+  (
+    exec 3<>/dev/tcp/127.0.0.1/$PORT || exit 1
+    timeout 15 cat <&3 > "$out" & lector=$!
+    for p in "$@"; do
+      case "$p" in
+        +*) sleep "${p#+}" ;;
+        *)  printf "%s\n" "$p" >&3 ;;
+      esac
+    done
+    sleep 1
+    kill "$lector" 2>/dev/null || true
+    exec 3>&-
+  ) &
+  CLIENTES+=($!)
+}
+
+# esperar a que terminen los clientes lanzados (no al servidor)
+esperar() {
+  wait "${CLIENTES[@]}" 2>/dev/null
+  CLIENTES=()
+}
+
+# verificar DESCRIPCION NOMBRE|ARCHIVO PATRON [no]: lo recibido por el cliente
+# NOMBRE (o el archivo indicado) contiene (o no) el patrón
+verificar() {
+  local out="$2"
+  [ -f "$out" ] || out="$(salida "$2")"
+  if grep -q -- "$3" "$out" 2>/dev/null; then encontrado=1; else encontrado=0; fi
+  if [ "${4:-}" = "no" ]; then encontrado=$((1 - encontrado)); fi
+  if [ $encontrado -eq 1 ]; then
+    echo "✅ $1"
+  else
+    echo "❌ $1 (ver $out)"
+    FALLOS=$((FALLOS + 1))
+  fi
+}
+
+# fallo DESCRIPCION: cuenta una verificación fallida hecha por la prueba
+fallo() {
+  echo "❌ $1"
+  FALLOS=$((FALLOS + 1))
+}
+
+# terminar DESCRIPCION: resumen final y código de salida
+terminar() {
+  echo "Salidas de los clientes en scripts/logs/${PREFIJO}_*.out"
+  if [ $FALLOS -gt 0 ]; then
+    echo "❌ $FALLOS verificación(es) fallida(s)"
+    exit 1
+  fi
+  echo "✅ $1"
+}
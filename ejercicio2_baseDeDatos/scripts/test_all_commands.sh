@@ -24,8 +24,11 @@ cmds=(
   "MOSTRAR"
   "BUSCAR G1_001"
   "FILTRO 1"
+  "FILTRO"     # sin argumento: no debe reusar el "1" del comando anterior
+  "BUSCAR"
   "AGREGAR 555,GX_555,5,2025-10-16,12:00:00,5"
   "MODIFICAR 555;555,GX_555_MOD,6,2025-10-16,12:00:00,5"
+  "ELIMINAR"   # sin ID: no debe tomar el 555 que quedó del MODIFICAR
   "ELIMINAR 555"
   "BEGIN"
   "AGREGAR 777,GX_777,7,2025-10-16,12:00:00,7"
@@ -38,7 +41,7 @@ cmds=(
 # ejecutar la sesión
 (
   exec 3<>/dev/tcp/127.0.0.1/$PORT || { echo "CONNECT_FAIL" > "$OUT"; exit 0; }
-  timeout 2 cat <&3 > "$OUT" & reader=$!
+  timeout 15 cat <&3 > "$OUT" & reader=$!
   for c in "${cmds[@]}"; do
     printf "%s\n" "$c" >&3
     sleep 0.5
@@ -53,4 +56,20 @@ echo "---- Cliente output ----" > "$LOG"
 cat "$OUT" >> "$LOG"
 echo "Test ALL commands completado. Log: $LOG"
 
-exec ./scripts/stop_server.sh
\ No newline at end of file
+# Comandos sin argumento: error de uso, nunca los argumentos del anterior
+FALLOS=0
+verificar() {
+  if grep -q -- "$2" "$OUT"; then
+    echo "✅ $1"
+  else
+    echo "❌ $1 (ver $OUT)"
+    FALLOS=$((FALLOS + 1))
+  fi
+}
+verificar "FILTRO sin argumento pide el generador" "FILTRO requiere un número de generador"
+verificar "BUSCAR sin argumento pide el criterio" "BUSCAR requiere un criterio"
+verificar "ELIMINAR sin ID no borra nada" "Registro no encontrado para eliminar"
+verificar "ELIMINAR 555 borra el registro" "Registro eliminado correctamente"
+
+./scripts/stop_server.sh
+[ $FALLOS -eq 0 ] || { echo "❌ $FALLOS verificación(es) fallida(s)"; exit 1; }
\ No newline at end of file
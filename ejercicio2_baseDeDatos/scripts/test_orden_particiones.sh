@@ -0,0 +1,119 @@
+#!/bin/bash
+# Prueba: la tabla repartida en particiones (TABLE_SHARDS) mantiene el orden
+# de llegada de las filas en MOSTRAR, también después de reiniciar.
+#  1. Con 16 particiones MOSTRAR devuelve lo mismo, en el mismo orden, que con 1.
+#  2. Tras kill -9 (la mitad de las filas en el snapshot y la otra mitad en el
+#     WAL) y tras un cierre ordenado (todo en el snapshot) el MOSTRAR es
+#     idéntico al de antes de reiniciar.
+#  3. Una transacción posterior que modifica filas anteriores (una del
+#     snapshot y otra agregada en el WAL) no las mueve tras kill -9.
+# Los commits salen de a una sesión, así el orden de aplicación es el del WAL.
+# El checkpoint periódico se desactiva: solo lo hace el cierre ordenado.
+
+PREFIJO=orden
+PORT=8085
+source "$(dirname "$0")/lib_pruebas.sh"
+
+# arrancar PARTICIONES [nueva]: con "nueva" parte de una copia limpia de la tabla
+arrancar() {
+  if [ "${2:-}" = "nueva" ]; then
+    rm -f "$TMP"/productos.*
+    cp data/productos.csv "$TMP/productos.csv"
+  fi
+  grep -v -E '^(TABLE_SHARDS|CHECKPOINT_INTERVAL_S|CHECKPOINT_WAL_MAX_KB)=' config/server.conf > "$TMP/server.conf"
+  echo "TABLE_SHARDS=$1" >> "$TMP/server.conf"
+  echo "CHECKPOINT_INTERVAL_S=3600" >> "$TMP/server.conf"
+  echo "CHECKPOINT_WAL_MAX_KB=1048576" >> "$TMP/server.conf"
+  (cd "$TMP" && SERVER_CONF=server.conf exec "$ROOT/bin/servidor" $PORT 5 10 productos.csv acciones.log >/dev/null 2>&1) &
+  PID_SRV=$!
+  sleep 1
+}
+
+# filas NOMBRE: las filas de un MOSTRAR, en el orden recibido
+filas() {
+  grep -E '^[0-9]+,' "$(salida "$1")" > "$TMP/$1.filas"
+  echo "$TMP/$1.filas"
+}
+
+# iguales DESCRIPCION A B: los dos MOSTRAR tienen las mismas filas en el mismo orden
+iguales() {
+  a=$(filas "$2"); b=$(filas "$3")
+  if [ -s "$a" ] && cmp -s "$a" "$b"; then
+    echo "✅ $1 ($(wc -l < "$a") filas)"
+  else
+    fallo "$1 (diff $2 / $3 en scripts/logs)"
+  fi
+}
+
+# Lote de cambios: altas DESDE..HASTA con IDs repartidos en todas las
+# particiones, en commits de 30, con modificaciones y bajas intercaladas
+lote() {
+  LOTE=("BEGIN")
+  for i in $(seq "$1" "$2"); do
+    id=$((920000 + (i * 7919) % 5000))
+    LOTE+=("AGREGAR $id,Orden $i,$i,2024-01-01,10:00:00,$((i % 9 + 1))")
+    if [ $((i % 30)) -eq 0 ]; then
+      LOTE+=("MODIFICAR $id;$id,Orden $i bis,$i,2024-01-01,10:00:00,1"
+             "ELIMINAR $((920000 + ((i - 15) * 7919) % 5000))" "COMMIT" "BEGIN")
+    fi
+  done
+  LOTE+=("COMMIT" "SALIR")
+}
+
+# escribir PARTICIONES: 300 altas sobre una tabla nueva; entre la primera y
+# la segunda mitad un cierre ordenado las pasa al snapshot, así la segunda
+# mitad queda solo en el WAL
+escribir() {
+  arrancar "$1" nueva
+  lote 1 150
+  sesion "escritura_p$1" 2 "${LOTE[@]}"
+  detener INT
+  arrancar "$1"
+  lote 151 300
+  sesion "escritura2_p$1" 2 "${LOTE[@]}"
+}
+
+MOSTRAR=("BEGIN" "MOSTRAR" "ROLLBACK" "SALIR")
+
+echo "=== 1. 16 particiones contra 1 ==="
+escribir 1
+sesion p1 2 "${MOSTRAR[@]}"
+detener INT
+escribir 16
+sesion antes 2 "${MOSTRAR[@]}"
+iguales "mismo orden con 16 particiones que con 1" p1 antes
+
+echo "=== 2. Reinicio tras kill -9 ==="
+detener 9
+arrancar 16
+sesion tras_caida 2 "${MOSTRAR[@]}"
+if grep "Recuperación en" "$TMP/server_debug.log" | tail -n 1 | grep -q "(0 transacciones"; then
+  fallo "la recuperación no reprodujo nada del WAL"
+fi
+iguales "mismo orden tras kill -9 y recuperación" antes tras_caida
+
+echo "=== 3. Reinicio tras cierre ordenado ==="
+detener INT
+arrancar 16
+sesion tras_cierre 2 "${MOSTRAR[@]}"
+iguales "mismo orden tras cierre y recarga del snapshot" antes tras_cierre
+
+echo "=== 4. Modificación posterior de filas anteriores y kill -9 ==="
+sesion modificar 2 \
+  "BEGIN" "AGREGAR 930001,Primera,1,2024-01-01,10:00:00,1" "COMMIT" \
+  "BEGIN" "AGREGAR 930002,Segunda,2,2024-01-01,10:00:00,2" "COMMIT" \
+  "BEGIN" "MODIFICAR 930001;930001,Primera bis,1,2024-01-01,10:00:00,1" \
+  "MODIFICAR 922919;922919,Orden 1 bis,1,2024-01-01,10:00:00,2" "COMMIT" "SALIR"
+sesion antes_mod 2 "${MOSTRAR[@]}"
+detener 9
+arrancar 16
+sesion tras_mod 2 "${MOSTRAR[@]}"
+iguales "mismo orden tras modificar filas anteriores y kill -9" antes_mod tras_mod
+if grep -n -E '^93000[12],' "$(salida tras_mod)" | cut -d, -f1 | cut -d: -f2 | tr '\n' ' ' | grep -q '^930001 930002 $'; then
+  echo "✅ la fila modificada sigue antes de la agregada después"
+else
+  fallo "la fila modificada quedó después de la agregada después (ver $(salida tras_mod))"
+fi
+detener INT
+
+terminar "Prueba de orden entre particiones completa"
@@ -0,0 +1,69 @@
+#!/bin/bash
+# Prueba de recuperación tras una caída (kill -9) con la cola del WAL cortada.
+#  1. Los commits confirmados antes de la caída se reproducen desde el WAL.
+#  2. Un bloque sin su línea C y una línea cortada a la mitad se descartan.
+#  3. El WAL sigue utilizable: un commit posterior sobrevive a otro reinicio.
+# El checkpoint periódico se desactiva para que todo salga del WAL.
+
+PREFIJO=recuperacion
+PORT=8083
+source "$(dirname "$0")/lib_pruebas.sh"
+WAL="$TMP/productos.wal"
+
+grep -v -E '^(CHECKPOINT_INTERVAL_S|CHECKPOINT_WAL_MAX_KB)=' config/server.conf > "$TMP/server.conf"
+echo "CHECKPOINT_INTERVAL_S=3600" >> "$TMP/server.conf"
+echo "CHECKPOINT_WAL_MAX_KB=1048576" >> "$TMP/server.conf"
+cp data/productos.csv "$TMP/productos.csv"
+
+# El servidor corre en TMP: server_debug.log queda ahí
+arrancar() {
+  (cd "$TMP" && SERVER_CONF=server.conf exec "$ROOT/bin/servidor" $PORT 5 10 productos.csv acciones.log >/dev/null 2>&1) &
+  PID_SRV=$!
+  sleep 1
+}
+
+echo "=== Commits antes de la caída ==="
+arrancar
+sesion escritura 2 \
+  "BEGIN" \
+  "AGREGAR 900001,Recuperado A,5,2024-01-01,10:00:00,3" \
+  "AGREGAR 900002,Recuperado B,6,2024-01-01,10:00:00,4" \
+  "COMMIT" \
+  "BEGIN" \
+  "MODIFICAR 900001;900001,Recuperado A2,7,2024-01-01,10:00:00,3" \
+  "ELIMINAR 900002" \
+  "COMMIT" \
+  "SALIR"
+detener 9
+verificar "los commits quedaron en el WAL" "$WAL" "^C "
+
+# Cola cortada: un bloque completo sin su C y otro cortado a mitad de línea
+ULTIMO=$(grep '^C ' "$WAL" | tail -n 1 | cut -d' ' -f2)
+printf "T %d\nA 900003 900003,Sin commit,1,2024-01-01,10:00:00,1\n" $((ULTIMO + 1)) >> "$WAL"
+printf "T %d\nA 900004 900004,Cort" $((ULTIMO + 2)) >> "$WAL"
+
+echo "=== Reinicio sobre el WAL cortado ==="
+arrancar
+sesion lectura 2 "BEGIN" "MOSTRAR" "ROLLBACK" "SALIR"
+sesion nuevo 2 \
+  "BEGIN" \
+  "AGREGAR 900005,Tras recuperar,2,2024-01-01,10:00:00,5" \
+  "COMMIT" \
+  "SALIR"
+verificar "la recuperación reprodujo el WAL" "$TMP/server_debug.log" "Recuperación en"
+verificar "el AGREGAR + MODIFICAR confirmado está" lectura "900001,Recuperado A2"
+verificar "el ELIMINAR confirmado se aplicó" lectura "^900002," no
+verificar "el bloque sin C se descartó" lectura "900003," no
+verificar "la línea cortada se descartó" lectura "900004," no
+verificar "acepta commits nuevos" nuevo "Transacción confirmada"
+
+echo "=== Segunda caída: el commit nuevo no quedó pegado a la cola cortada ==="
+detener 9
+arrancar
+sesion lectura2 2 "BEGIN" "MOSTRAR" "ROLLBACK" "SALIR"
+verificar "el commit posterior se recuperó" lectura2 "900005,Tras recuperar"
+verificar "lo anterior sigue igual" lectura2 "900001,Recuperado A2"
+verificar "el bloque sin C no reaparece" lectura2 "900003," no
+detener INT
+
+terminar "Prueba de recuperación completa"
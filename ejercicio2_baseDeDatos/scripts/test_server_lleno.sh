@@ -1,66 +1,115 @@
 #!/bin/bash
-# Prueba: servidor con límite MAX_CLIENTES y varios intentos de conexión.
-set -e
+# Prueba: servidor lleno (MAX_CLIENTES=2) con cola de admisión.
+#  1. Con los lugares ocupados, una conexión nueva recibe el aviso con su posición.
+#  2. Al salir un cliente, la primera en espera es admitida y atiende lo que mandó.
+#  3. Con ADMISSION_QUEUE=0 se rechaza al instante; con ADMISSION_TIMEOUT_MS
+#     corto se rechaza al vencer la espera.
+# Sale con código distinto de 0 si falla alguna verificación.
 
 ROOT="$(cd "$(dirname "$0")/.." && pwd)"
 cd "$ROOT"
 
 PORT=8082
-MAX=3      # límite pequeño para la prueba
+MAX=2      # límite pequeño para la prueba
 BACKLOG=10
-CSV=data/productos.csv
-LOG=test_full_actions.log
+TMP="$(mktemp -d)"
+PID_SRV=""
+FALLOS=0
 mkdir -p scripts/logs
-rm -f "$LOG" scripts/logs/* temp.csv server.pid
+rm -f scripts/logs/lleno_*.out
 
-# arrancar servidor (via run_server.sh para compilar si hace falta)
-./scripts/run_server.sh $PORT $MAX $BACKLOG $CSV $LOG 
+trap '[ -n "$PID_SRV" ] && kill "$PID_SRV" 2>/dev/null; rm -rf "$TMP"' EXIT
 
-sleep 1
+# arrancar COLA TIMEOUT_MS: servidor con una copia de la tabla y la cola indicada
+arrancar() {
+  grep -v -E '^(ADMISSION_QUEUE|ADMISSION_TIMEOUT_MS)=' config/server.conf > "$TMP/server.conf"
+  echo "ADMISSION_QUEUE=$1" >> "$TMP/server.conf"
+  echo "ADMISSION_TIMEOUT_MS=$2" >> "$TMP/server.conf"
+  rm -f "$TMP"/productos.*
+  cp data/productos.csv "$TMP/productos.csv"
+  SERVER_CONF="$TMP/server.conf" ./bin/servidor $PORT $MAX $BACKLOG "$TMP/productos.csv" "$TMP/acciones.log" >/dev/null 2>&1 &
+  PID_SRV=$!
+  sleep 1
+}
+
+detener() {
+  kill -INT "$PID_SRV" 2>/dev/null
+  wait "$PID_SRV" 2>/dev/null
+  PID_SRV=""
+}
 
-# función cliente simple que intenta conectar y pedir MOSTRAR
-cliente_try() {
-  id="$1"
-  out="scripts/logs/cliente_full_${id}.out"
-  rm -f "$out"
+# cliente NOMBRE SEGUNDOS [comandos...]: conecta, manda los comandos y sigue
+# conectado SEGUNDOS antes de SALIR. Lo recibido queda en scripts/logs/lleno_NOMBRE.out
+cliente() {
+  nombre="$1"; dur="$2"; shift 2
+  out="scripts/logs/lleno_${nombre}.out"
   (
-    exec 3<>/dev/tcp/127.0.0.1/$PORT
-    if [ $? -ne 0 ]; then
+    if ! exec 3<>/dev/tcp/127.0.0.1/$PORT; then
       echo "CONNECT_FAIL" > "$out"
       exit 0
     fi
-    # leer saludo en background
-    timeout 3 cat <&3 > "$out" & reader=$!
-    printf "BEGIN\n" >&3
-    sleep 1
-    kill "$reader" 2>/dev/null || true
-    exec 3>&-; exec 3<&-
+    timeout $((${dur%.*} + 2)) cat <&3 > "$out" & lector=$!
+    for c in "$@"; do printf "%s\n" "$c" >&3; done
+    sleep "$dur"
+    printf "SALIR\n" >&3 2>/dev/null
+    sleep 0.5
+    kill "$lector" 2>/dev/null || true
+    exec 3>&-
   ) &
-  echo $!
 }
 
-# lanzar más clientes que el límite
-PIDS=()
-TRIES=20
-for i in $(seq 1 $TRIES); do
-  pid=$(cliente_try $i)
-  PIDS+=($pid)
-  sleep 0.2
-done
+# verificar DESCRIPCION NOMBRE PATRON [no]: el cliente recibió (o no) el patrón
+verificar() {
+  out="scripts/logs/lleno_$2.out"
+  if grep -q -- "$3" "$out" 2>/dev/null; then encontrado=1; else encontrado=0; fi
+  if [ "${4:-}" = "no" ]; then encontrado=$((1 - encontrado)); fi
+  if [ $encontrado -eq 1 ]; then
+    echo "✅ $1"
+  else
+    echo "❌ $1 (ver $out)"
+    FALLOS=$((FALLOS + 1))
+  fi
+}
+
+echo "=== 1-2. Espera en la cola y admisión al liberarse un lugar ==="
+arrancar 64 10000
+cliente a1 2
+cliente b1 2
+sleep 0.5
+cliente c1 4 "BEGIN"
+sleep 6
+detener
+verificar "la conexión en espera recibe su posición" c1 "posición 1"
+verificar "es admitida al salir otro cliente" c1 "Conectado al servidor"
+verificar "atiende el comando que mandó mientras esperaba" c1 "Transacción iniciada"
+verificar "no es rechazada" c1 "Servidor ocupado" no
 
-# esperar a todos
+echo "=== 3a. Sin cola de espera (ADMISSION_QUEUE=0) ==="
+arrancar 0 10000
+cliente a2 2
+cliente b2 2
+sleep 0.5
+cliente c2 1
 sleep 3
-wait ${PIDS[@]} 2>/dev/null || true
+detener
+verificar "se rechaza al instante" c2 "Servidor ocupado"
+verificar "no llega a ser atendida" c2 "Conectado al servidor" no
 
-# extraer indicadores de rechazo/éxito
-echo "=== Resultado prueba servidor lleno (logs en scripts/logs) ===" > "$LOG"
-for f in scripts/logs/cliente_full_*.out; do
-  echo "---- $f ----" >> "$LOG"
-  if [ -f "$f" ]; then
-    grep -E "ERROR: Servidor ocupado|Servidor ocupado|CONNECT_FAIL" "$f" || true
-    cat "$f" >> "$LOG"
-  fi
-done
+echo "=== 3b. Espera vencida (ADMISSION_TIMEOUT_MS=500) ==="
+arrancar 64 500
+cliente a3 3
+cliente b3 3
+sleep 0.5
+cliente c3 2
+sleep 4
+detener
+verificar "primero queda en espera" c3 "posición 1"
+verificar "se rechaza al vencer la espera" c3 "Servidor ocupado"
+verificar "no llega a ser atendida" c3 "Conectado al servidor" no
 
-echo "Test completo. Log: $LOG"
-exec ./scripts/stop_server.sh
\ No newline at end of file
+echo "Salidas de los clientes en scripts/logs/lleno_*.out"
+if [ $FALLOS -gt 0 ]; then
+  echo "❌ $FALLOS verificación(es) fallida(s)"
+  exit 1
+fi
+echo "✅ Prueba de servidor lleno completa"
@@ -0,0 +1,75 @@
+#!/bin/bash
+# Prueba de bloqueos por fila con wait-die entre sesiones BEGIN/MODIFICAR.
+#  1. La transacción más nueva que pide un ID bloqueado por una más vieja se
+#     aborta; reintentando con BEGIN confirma cuando la vieja terminó.
+#  2. La más vieja que pide un ID bloqueado por una más nueva espera y confirma
+#     después de ella (su valor es el que queda).
+#  3. Transacciones sobre IDs distintos no se esperan entre sí.
+#  4. ROLLBACK termina la transacción y suelta sus bloqueos.
+
+PREFIJO=waitdie
+PORT=8086
+source "$(dirname "$0")/lib_pruebas.sh"
+
+cp data/productos.csv "$TMP/productos.csv"
+(cd "$TMP" && exec "$ROOT/bin/servidor" $PORT 10 10 productos.csv acciones.log >/dev/null 2>&1) &
+PID_SRV=$!
+sleep 1
+
+fila() { echo "$1,$2,1,2024-01-01,10:00:00,9"; }
+
+cliente preparar "BEGIN" \
+  "AGREGAR $(fila 910001 Base)" "AGREGAR $(fila 910002 Base)" "AGREGAR $(fila 910003 Base)" \
+  "AGREGAR $(fila 910004 Base)" "AGREGAR $(fila 910005 Base)" "COMMIT" "SALIR"
+esperar
+
+echo "=== 1. La más nueva se aborta ==="
+cliente viejo1 "BEGIN" "+0.5" "MODIFICAR 910001;$(fila 910001 Viejo1)" "+2" "COMMIT" "SALIR"
+sleep 0.2
+cliente nuevo1 "BEGIN" "+0.7" "MODIFICAR 910001;$(fila 910001 Nuevo1)" "+0.3" "BEGIN" "+2.5" \
+  "MODIFICAR 910001;$(fila 910001 Nuevo1)" "COMMIT" "SALIR"
+esperar
+verificar "la nueva recibe el conflicto" nuevo1 "Conflicto"
+verificar "la vieja no se aborta" viejo1 "Conflicto" no
+verificar "la vieja confirma" viejo1 "Transacción confirmada"
+verificar "la nueva confirma al reintentar" nuevo1 "Transacción confirmada"
+
+echo "=== 2. La más vieja espera ==="
+cliente viejo2 "BEGIN" "+1" "MODIFICAR 910002;$(fila 910002 Viejo2)" "COMMIT" "+2" "SALIR"
+sleep 0.3
+cliente nuevo2 "BEGIN" "+0.2" "MODIFICAR 910002;$(fila 910002 Nuevo2)" "+1.5" "COMMIT" "SALIR"
+esperar
+verificar "la vieja no se aborta" viejo2 "Conflicto" no
+verificar "la vieja confirma tras esperar" viejo2 "Transacción confirmada"
+verificar "la nueva confirma" nuevo2 "Transacción confirmada"
+
+echo "=== 3. IDs distintos no se esperan ==="
+cliente lento "BEGIN" "MODIFICAR 910003;$(fila 910003 Lento)" "+3" "COMMIT" "SALIR"
+sleep 0.3
+cliente rapido "BEGIN" "MODIFICAR 910004;$(fila 910004 Rapido)" "COMMIT" "SALIR"
+sleep 1
+verificar "confirma mientras la otra sigue abierta" rapido "Transacción confirmada"
+verificar "la otra todavía no confirmó" lento "Transacción confirmada" no
+esperar
+verificar "la otra confirma después" lento "Transacción confirmada"
+
+echo "=== 4. ROLLBACK termina la transacción ==="
+cliente rollback "BEGIN" "MODIFICAR 910005;$(fila 910005 Descartado)" "ROLLBACK" \
+  "MODIFICAR 910005;$(fila 910005 Fuera)" "BEGIN" "ROLLBACK" "SALIR"
+esperar
+cliente otro "BEGIN" "MODIFICAR 910005;$(fila 910005 Otro)" "COMMIT" "SALIR"
+esperar
+verificar "fuera de la transacción pide BEGIN" rollback "use el comando BEGIN"
+verificar "BEGIN vuelve a funcionar" rollback "Ya existe una transacción activa" no
+verificar "los bloqueos se soltaron" otro "Transacción confirmada"
+
+cliente lectura "BEGIN" "MOSTRAR" "ROLLBACK" "SALIR"
+esperar
+verificar "queda el valor del último commit (ID 910001)" lectura "^910001,Nuevo1,"
+verificar "queda el valor de la vieja, que confirmó última (ID 910002)" lectura "^910002,Viejo2,"
+verificar "quedan los dos IDs distintos" lectura "^910004,Rapido,"
+verificar "lo revertido no quedó (ID 910005)" lectura "^910005,Otro,"
+
+detener INT
+
+terminar "Prueba de wait-die completa"
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include "admision.h"
+#include "metricas.h"
+#include "utils.h"
+
+extern int MAX_CLIENTES;
+
+int ADMISION_COLA = ADMISION_COLA_DEF;
+int ADMISION_TIMEOUT_MS = ADMISION_TIMEOUT_MS_DEF;
+
+typedef struct {
+    int socket;
+    uint64_t desde_ns;
+} Espera;
+
+// Cola circular de conexiones en espera (protegida por mutex_admision)
+static Espera *cola = NULL;
+static int cap = 0, cabeza = 0, n_espera = 0, pico = 0;
+static int activos = 0;
+static uint64_t tras_espera = 0, vencidos = 0;
+static int (*despachar_fn)(int socket) = NULL;
+
+static pthread_mutex_t mutex_admision = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_hilo;
+static pthread_t hilo_vencimientos;
+static int hilo_activo = 0;
+static int detener = 0;
+
+static void sacar_primero(Espera *e) {
+    *e = cola[cabeza];
+    cabeza = (cabeza + 1) % cap;
+    n_espera--;
+}
+
+static void rechazar(int socket) {
+    enviar(socket, "Servidor ocupado. Reintente más tarde.\n");
+    close(socket);
+    metricas_conexion_rechazada();
+}
+
+int admision_entrar(int socket) {
+    pthread_mutex_lock(&mutex_admision);
+    // con gente esperando, una conexión nueva no se adelanta aunque haya lugar
+    if (activos < MAX_CLIENTES && n_espera == 0) {
+        activos++;
+        pthread_mutex_unlock(&mutex_admision);
+        return ADMISION_ADMITIDO;
+    }
+    if (n_espera >= cap) {
+        pthread_mutex_unlock(&mutex_admision);
+        return ADMISION_RECHAZADO;
+    }
+    cola[(cabeza + n_espera) % cap] = (Espera){ socket, metricas_ahora_ns() };
+    n_espera++;
+    if (n_espera > pico) pico = n_espera;
+    // bajo el mutex: así el aviso no puede llegar después del saludo
+    char aviso[96];
+    snprintf(aviso, sizeof(aviso), "⏳ Servidor lleno: en espera de un lugar (posición %d)...\n", n_espera);
+    enviar(socket, aviso);
+    if (n_espera == 1) pthread_cond_signal(&cond_hilo); // nuevo vencimiento más próximo
+    pthread_mutex_unlock(&mutex_admision);
+    return ADMISION_EN_ESPERA;
+}
+
+void admision_salir(void) {
+    pthread_mutex_lock(&mutex_admision);
+    // el lugar pasa al primero de la cola sin bajar 'activos'
+    while (n_espera > 0 && activos <= MAX_CLIENTES) {
+        Espera e;
+        sacar_primero(&e);
+        uint64_t espera = metricas_ahora_ns() - e.desde_ns;
+        if (despachar_fn(e.socket) == 0) {
+            tras_espera++;
+            pthread_mutex_unlock(&mutex_admision);
+            metricas_registrar(MET_ESPERA_ADMISION, espera);
+            return;
+        }
+        rechazar(e.socket);
+    }
+    activos--;
+    pthread_mutex_unlock(&mutex_admision);
+}
+
+void admision_reconfigurar(void) {
+    pthread_mutex_lock(&mutex_admision);
+    while (n_espera > 0 && activos < MAX_CLIENTES) {
+        Espera e;
+        sacar_primero(&e);
+        if (despachar_fn(e.socket) == 0) {
+            activos++;
+            tras_espera++;
+            metricas_registrar(MET_ESPERA_ADMISION, metricas_ahora_ns() - e.desde_ns);
+        } else {
+            rechazar(e.socket);
+        }
+    }
+    pthread_cond_signal(&cond_hilo); // recalcular el vencimiento
+    pthread_mutex_unlock(&mutex_admision);
+}
+
+void admision_estadisticas(int *act, int *esp, int *pic, uint64_t *tras, uint64_t *venc) {
+    pthread_mutex_lock(&mutex_admision);
+    if (act) *act = activos;
+    if (esp) *esp = n_espera;
+    if (pic) *pic = pico;
+    if (tras) *tras = tras_espera;
+    if (venc) *venc = vencidos;
+    pthread_mutex_unlock(&mutex_admision);
+}
+
+// Cierra las esperas que superan ADMISION_TIMEOUT_MS (por ser FIFO, siempre las primeras)
+static void *hilo_vencer(void *arg) {
+    (void)arg;
+    // las señales las atiende el hilo principal
+    sigset_t set;
+    sigfillset(&set);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    pthread_mutex_lock(&mutex_admision);
+    while (!detener) {
+        // ADMISION_TIMEOUT_MS puede cambiar con una recarga de la configuración
+        uint64_t limite_ns = (uint64_t)ADMISION_TIMEOUT_MS * 1000000ULL;
+        if (n_espera == 0 || ADMISION_TIMEOUT_MS <= 0) {
+            pthread_cond_wait(&cond_hilo, &mutex_admision);
+            continue;
+        }
+        uint64_t vence = cola[cabeza].desde_ns + limite_ns;
+        if (metricas_ahora_ns() >= vence) {
+            Espera e;
+            sacar_primero(&e);
+            vencidos++;
+            log_action("Cliente en espera (socket=%d) descartado tras %d ms sin lugar.",
+                       e.socket, ADMISION_TIMEOUT_MS);
+            rechazar(e.socket);
+            continue;
+        }
+        struct timespec ts = { (time_t)(vence / 1000000000ULL), (long)(vence % 1000000000ULL) };
+        pthread_cond_timedwait(&cond_hilo, &mutex_admision, &ts);
+    }
+    pthread_mutex_unlock(&mutex_admision);
+    return NULL;
+}
+
+int admision_iniciar(int (*despachar)(int socket)) {
+    despachar_fn = despachar;
+    cap = ADMISION_COLA > 0 ? ADMISION_COLA : 0;
+    if (cap > 0) {
+        cola = calloc((size_t)cap, sizeof(Espera));
+        if (!cola) {
+            log_msg("Admisión: sin memoria para la cola de espera (%d)", cap);
+            cap = 0;
+            return -1;
+        }
+    }
+
+    // los vencimientos se calculan con el reloj monotónico (metricas_ahora_ns)
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&cond_hilo, &attr);
+    pthread_condattr_destroy(&attr);
+
+    if (cap == 0) return 0;
+    detener = 0;
+    if (pthread_create(&hilo_vencimientos, NULL, hilo_vencer, NULL) != 0) {
+        log_msg("Admisión: no se pudo crear el hilo de vencimientos");
+        return -1;
+    }
+    hilo_activo = 1;
+    return 0;
+}
+
+void admision_detener(void) {
+    pthread_mutex_lock(&mutex_admision);
+    detener = 1;
+    // las que esperan no van a llegar a atenderse: se cierran ya
+    while (n_espera > 0) {
+        Espera e;
+        sacar_primero(&e);
+        enviar(e.socket, "Servidor cerrándose. Reintente más tarde.\n");
+        close(e.socket);
+    }
+    pthread_cond_signal(&cond_hilo);
+    pthread_mutex_unlock(&mutex_admision);
+    if (!hilo_activo) return;
+    pthread_join(hilo_vencimientos, NULL);
+    hilo_activo = 0;
+}
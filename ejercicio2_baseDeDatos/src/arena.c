@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "arena.h"
+
+struct BloqueArena {
+    BloqueArena *sig;
+    size_t tam, usado;
+    _Alignas(16) char datos[];
+};
+
+// Contadores globales (las arenas en sí no se comparten entre hilos)
+static atomic_ullong asignaciones = 0, bytes_servidos = 0, bloques_pedidos = 0;
+static atomic_llong bytes_reservados = 0;
+
+static __thread Arena arena_de_hilo;
+static __thread int arena_de_hilo_lista = 0;
+
+static size_t alinear(size_t n) {
+    return (n + 15) & ~(size_t)15;
+}
+
+static void soltar_bloque(BloqueArena *b) {
+    atomic_fetch_sub_explicit(&bytes_reservados, (long long)b->tam, memory_order_relaxed);
+    free(b);
+}
+
+void arena_iniciar(Arena *a) {
+    a->actual = NULL;
+    a->libres = NULL;
+    a->ultimo = NULL;
+}
+
+// Un bloque con lugar para n bytes: uno conservado si alcanza o uno nuevo
+static BloqueArena *nuevo_bloque(Arena *a, size_t n) {
+    for (BloqueArena **p = &a->libres; *p; p = &(*p)->sig) {
+        if ((*p)->tam >= n) {
+            BloqueArena *b = *p;
+            *p = b->sig;
+            return b;
+        }
+    }
+    size_t tam = n > ARENA_BLOQUE ? n : ARENA_BLOQUE;
+    BloqueArena *b = malloc(sizeof(BloqueArena) + tam);
+    if (!b) return NULL;
+    b->tam = tam;
+    atomic_fetch_add_explicit(&bloques_pedidos, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&bytes_reservados, (long long)tam, memory_order_relaxed);
+    return b;
+}
+
+void *arena_asignar(Arena *a, size_t n) {
+    n = alinear(n ? n : 1);
+    BloqueArena *b = a->actual;
+    if (!b || b->tam - b->usado < n) {
+        b = nuevo_bloque(a, n);
+        if (!b) return NULL;
+        b->usado = 0;
+        b->sig = a->actual;
+        a->actual = b;
+    }
+    void *p = b->datos + b->usado;
+    b->usado += n;
+    a->ultimo = p;
+    atomic_fetch_add_explicit(&asignaciones, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&bytes_servidos, n, memory_order_relaxed);
+    return p;
+}
+
+void *arena_agrandar(Arena *a, void *p, size_t tam, size_t nuevo) {
+    if (!p) return arena_asignar(a, nuevo);
+    BloqueArena *b = a->actual;
+    if (p == a->ultimo && b) {
+        size_t desde = (size_t)((char *)p - b->datos);
+        if (b->tam - desde >= alinear(nuevo)) {
+            atomic_fetch_add_explicit(&bytes_servidos, alinear(nuevo) - (b->usado - desde),
+                                      memory_order_relaxed);
+            b->usado = desde + alinear(nuevo);
+            return p;
+        }
+    }
+    void *q = arena_asignar(a, nuevo);
+    if (q) memcpy(q, p, tam < nuevo ? tam : nuevo);
+    return q;
+}
+
+char *arena_copiar_linea(Arena *a, const char *linea) {
+    size_t n = strcspn(linea, "\r\n");
+    char *copia = arena_asignar(a, n + 2);
+    if (!copia) return NULL;
+    memcpy(copia, linea, n);
+    copia[n] = '\n';
+    copia[n + 1] = '\0';
+    return copia;
+}
+
+void arena_reiniciar(Arena *a) {
+    size_t retenido = 0;
+    for (BloqueArena *b = a->libres; b; b = b->sig) retenido += b->tam;
+    BloqueArena *b = a->actual;
+    while (b) {
+        BloqueArena *sig = b->sig;
+        // una respuesta enorme no debe quedar retenida por el hilo para siempre
+        if (retenido + b->tam <= ARENA_RETENER) {
+            b->sig = a->libres;
+            a->libres = b;
+            retenido += b->tam;
+        } else {
+            soltar_bloque(b);
+        }
+        b = sig;
+    }
+    a->actual = NULL;
+    a->ultimo = NULL;
+}
+
+void arena_liberar(Arena *a) {
+    arena_reiniciar(a);
+    while (a->libres) {
+        BloqueArena *sig = a->libres->sig;
+        soltar_bloque(a->libres);
+        a->libres = sig;
+    }
+}
+
+Arena *arena_hilo(void) {
+    if (!arena_de_hilo_lista) {
+        arena_iniciar(&arena_de_hilo);
+        arena_de_hilo_lista = 1;
+    }
+    return &arena_de_hilo;
+}
+
+void arena_estadisticas(uint64_t *asig, uint64_t *bytes, uint64_t *bloques, uint64_t *reservados) {
+    if (asig) *asig = atomic_load(&asignaciones);
+    if (bytes) *bytes = atomic_load(&bytes_servidos);
+    if (bloques) *bloques = atomic_load(&bloques_pedidos);
+    if (reservados) {
+        long long r = atomic_load(&bytes_reservados);
+        *reservados = r > 0 ? (uint64_t)r : 0;
+    }
+}
@@ -0,0 +1,405 @@
+// bench.c — microbenchmarks de las operaciones de db.c.
+// Llama directamente a las funciones del motor (sin servidor ni red) sobre
+// tablas generadas de N filas y reporta ns/op, asignaciones/op y bytes/op.
+// Las filas se derivan de una salida de ejercicio1_productos (plantilla):
+// se conservan cantidad, fecha, hora y generador, y se renumeran los IDs.
+// Las respuestas de BUSCAR/FILTRO van a un socket inválido (-1), así se
+// mide el recorrido y no el envío.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <getopt.h>
+#include "db.h"
+#include "db_bin.h"
+#include "db_csv.h"
+#include "db_col.h"
+#include "db_log.h"
+#include "particiones.h"
+#include "transaction.h"
+#include "arena.h"
+#include "cache.h"
+
+#define LOTE_CARGA    4096
+#define LOTE_DML      1000     /* operaciones por transacción antes de vaciarla */
+#define PASO          7919     /* primo: i * PASO % N recorre IDs distintos */
+#define MAX_TAMANOS   16
+#define MAX_BASE      256
+
+// ====== Conteo de asignaciones ======
+// Se interponen malloc/calloc/realloc de glibc; solo cuentan dentro de una medición.
+extern void *__libc_malloc(size_t n);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *p, size_t n);
+
+static int contando = 0;
+static unsigned long long asignaciones = 0, bytes_asignados = 0;
+
+void *malloc(size_t n) {
+    if (contando) { asignaciones++; bytes_asignados += n; }
+    return __libc_malloc(n);
+}
+
+void *calloc(size_t n, size_t size) {
+    if (contando) { asignaciones++; bytes_asignados += n * size; }
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *p, size_t n) {
+    if (contando) { asignaciones++; bytes_asignados += n; }
+    return __libc_realloc(p, n);
+}
+
+// ====== Configuración ======
+static char PLANTILLA[512] = "../ejercicio1_productos/productos.csv";
+static char DIRECTORIO[256] = "data";
+static char BASE[512] = "";
+static size_t tamanos[MAX_TAMANOS] = { 1000, 10000, 100000, 1000000, 10000000 };
+static int n_tamanos = 5;
+static int MIN_MS = 200;         /* tiempo mínimo medido por operación */
+static double UMBRAL = 25.0;     /* % de ns/op sobre la base que cuenta como regresión */
+
+static Producto *plantilla = NULL;
+static size_t n_plantilla = 0;
+
+// ====== Estado de la tabla en medición ======
+static size_t filas = 0;
+static Transaccion tx;
+static char consulta[DESC_MAX + 2];
+
+static uint64_t ahora_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Fila i (1..N) de la tabla generada
+static void fila_generada(size_t i, Producto *p) {
+    *p = plantilla[(i - 1) % n_plantilla];
+    p->id = (int)i;
+    snprintf(p->descripcion, sizeof(p->descripcion), "G%d_%03zu", p->generador, i);
+}
+
+static int linea_generada(size_t i, char *buf, size_t size) {
+    Producto p;
+    fila_generada(i, &p);
+    return formatear_producto(&p, buf, size);
+}
+
+// Carga la plantilla; si no hay archivo usa filas con el mismo formato que productos
+static int cargar_plantilla(void) {
+    FILE *f = fopen(PLANTILLA, "r");
+    char linea[512];
+    size_t cap = 0;
+    while (f && fgets(linea, sizeof(linea), f)) {
+        Producto p;
+        if (parsear_producto(linea, &p) != 0) continue; // encabezado, #MISSING...
+        if (n_plantilla == cap) {
+            cap = cap ? cap * 2 : 256;
+            Producto *q = realloc(plantilla, cap * sizeof(Producto));
+            if (!q) { fclose(f); return -1; }
+            plantilla = q;
+        }
+        plantilla[n_plantilla++] = p;
+    }
+    if (f) fclose(f);
+    if (n_plantilla > 0) {
+        printf("plantilla: %s (%zu filas)\n", PLANTILLA, n_plantilla);
+        return 0;
+    }
+
+    fprintf(stderr, "⚠️  %s sin registros; se usa una plantilla sintética\n", PLANTILLA);
+    n_plantilla = 200;
+    plantilla = calloc(n_plantilla, sizeof(Producto));
+    if (!plantilla) return -1;
+    time_t t = time(NULL);
+    struct tm tm;
+    localtime_r(&t, &tm);
+    for (size_t i = 0; i < n_plantilla; i++) {
+        plantilla[i].cantidad = (int)(i * 37 % 50) + 1;
+        plantilla[i].generador = (int)(i % 4) + 1;
+        strftime(plantilla[i].fecha, sizeof(plantilla[i].fecha), "%Y-%m-%d", &tm);
+        strftime(plantilla[i].hora, sizeof(plantilla[i].hora), "%H:%M:%S", &tm);
+    }
+    return 0;
+}
+
+// ====== Base de comparación (salida previa de bench) ======
+typedef struct {
+    size_t filas;
+    char op[16];
+    double ns;
+} Referencia;
+
+static Referencia base[MAX_BASE];
+static int n_base = 0;
+static int regresiones = 0;
+
+static int cargar_base(void) {
+    FILE *f = fopen(BASE, "r");
+    if (!f) {
+        perror(BASE);
+        return -1;
+    }
+    char linea[256];
+    while (n_base < MAX_BASE && fgets(linea, sizeof(linea), f)) {
+        Referencia *r = &base[n_base];
+        if (sscanf(linea, "%zu %15s %lf", &r->filas, r->op, &r->ns) == 3) n_base++;
+    }
+    fclose(f);
+    return 0;
+}
+
+static const Referencia *buscar_base(size_t n, const char *op) {
+    for (int i = 0; i < n_base; i++) {
+        if (base[i].filas == n && strcmp(base[i].op, op) == 0) return &base[i];
+    }
+    return NULL;
+}
+
+static void reportar(const char *op, uint64_t ns, unsigned long long ops,
+                     unsigned long long allocs, unsigned long long bytes) {
+    double ns_op = (double)ns / (double)ops;
+    printf("%-10zu %-10s %12.1f %10.2f %10.1f %10llu", filas, op, ns_op,
+           (double)allocs / (double)ops, (double)bytes / (double)ops, ops);
+    const Referencia *r = n_base ? buscar_base(filas, op) : NULL;
+    if (r && r->ns > 0) {
+        double delta = (ns_op - r->ns) * 100.0 / r->ns;
+        printf(" %+8.1f%%", delta);
+        if (delta > UMBRAL) {
+            printf(" ⚠️");
+            regresiones++;
+        }
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+// ====== Mediciones ======
+typedef void (*FnOp)(size_t i);
+
+// Repite fn en lotes de 'lote' operaciones hasta juntar MIN_MS; entre lotes
+// (fuera de la medición) se llama a 'entre_lotes' si no es NULL
+static void medir(const char *op, FnOp fn, size_t lote, void (*entre_lotes)(void)) {
+    uint64_t total = 0, limite = (uint64_t)MIN_MS * 1000000ULL;
+    unsigned long long ops = 0, allocs = 0, bytes = 0;
+    size_t i = 0;
+    do {
+        asignaciones = bytes_asignados = 0;
+        contando = 1;
+        uint64_t t0 = ahora_ns();
+        for (size_t k = 0; k < lote; k++) fn(i++);
+        total += ahora_ns() - t0;
+        contando = 0;
+        allocs += asignaciones;
+        bytes += bytes_asignados;
+        ops += lote;
+        if (entre_lotes) entre_lotes();
+    } while (total < limite);
+    reportar(op, total, ops, allocs, bytes);
+}
+
+// ID existente número i de una secuencia que no se repite en N pasos
+static int id_de(size_t i) {
+    return (int)((i * PASO) % filas) + 1;
+}
+
+static void vaciar_tx(void) {
+    trans_reset(&tx);
+}
+
+static void op_buscar(size_t i) {
+    (void)i;
+    buscar_registro(-1, consulta, NULL);
+    arena_reiniciar(arena_hilo()); // como el servidor al terminar cada comando
+}
+
+static void op_filtro(size_t i) {
+    char gen[8];
+    snprintf(gen, sizeof(gen), "%d", plantilla[i % n_plantilla].generador);
+    filtrar_generador(-1, gen, NULL);
+    arena_reiniciar(arena_hilo());
+}
+
+static void op_agregar(size_t i) {
+    char linea[256];
+    linea_generada(filas + 1 + i % LOTE_DML, linea, sizeof(linea));
+    agregar_registro(linea, &tx);
+}
+
+static void op_modificar(size_t i) {
+    char arg[288];
+    int id = id_de(i);
+    int n = snprintf(arg, sizeof(arg), "%d;", id);
+    linea_generada((size_t)id, arg + n, sizeof(arg) - (size_t)n);
+    modificar_registro(-1, arg, &tx);
+}
+
+static void op_eliminar(size_t i) {
+    char arg[16];
+    snprintf(arg, sizeof(arg), "%d", id_de(i));
+    eliminar_registro(arg, &tx);
+}
+
+// COMMIT de una transacción con una modificación (sin WAL): la escritura en el motor
+static void op_aplicar(size_t i) {
+    aplicar_transaccion(&tx);
+    (void)i;
+}
+
+static void preparar_aplicar(void) {
+    static size_t i = 0;
+    char arg[288];
+    int id = id_de(i++);
+    int n = snprintf(arg, sizeof(arg), "%d;", id);
+    linea_generada((size_t)id, arg + n, sizeof(arg) - (size_t)n);
+    trans_reset(&tx);
+    modificar_registro(-1, arg, &tx);
+}
+
+// Llena la tabla con N filas; mide aplicar_operacion('A') por fila
+static int cargar_tabla(size_t n) {
+    char *lineas = malloc((size_t)LOTE_CARGA * 256);
+    if (!lineas) return -1;
+    uint64_t total = 0;
+    unsigned long long allocs = 0, bytes = 0;
+    int err = 0;
+    for (size_t desde = 1; desde <= n && !err; desde += LOTE_CARGA) {
+        size_t hasta = desde + LOTE_CARGA - 1 < n ? desde + LOTE_CARGA - 1 : n;
+        for (size_t i = desde; i <= hasta; i++) {
+            linea_generada(i, lineas + (i - desde) * 256, 256);
+        }
+        asignaciones = bytes_asignados = 0;
+        contando = 1;
+        uint64_t t0 = ahora_ns();
+        for (size_t i = desde; i <= hasta && !err; i++) {
+            err = aplicar_operacion('A', (int)i, lineas + (i - desde) * 256);
+        }
+        total += ahora_ns() - t0;
+        contando = 0;
+        allocs += asignaciones;
+        bytes += bytes_asignados;
+    }
+    free(lineas);
+    if (err) {
+        fprintf(stderr, "❌ Error cargando la tabla de %zu filas\n", n);
+        return -1;
+    }
+    filas = n;
+    reportar("cargar", total, n, allocs, bytes);
+    return 0;
+}
+
+static int medir_tamano(size_t n) {
+    snprintf(ARCHIVO_DB, sizeof(ARCHIVO_DB), "%s/bench_%d.csv", DIRECTORIO, (int)getpid());
+    snprintf(ARCHIVO_BIN, sizeof(ARCHIVO_BIN), "%s/bench_%d.bin", DIRECTORIO, (int)getpid());
+    snprintf(ARCHIVO_SEG, sizeof(ARCHIVO_SEG), "%s/bench_%d.seg", DIRECTORIO, (int)getpid());
+    unlink(ARCHIVO_DB);
+    unlink(ARCHIVO_BIN);
+    dblog_eliminar_segmentos(ARCHIVO_SEG);
+    if (abrir_motor() != 0) {
+        fprintf(stderr, "❌ No se pudo abrir el motor en %s\n", DIRECTORIO);
+        return -1;
+    }
+    filas = n;
+    int res = cargar_tabla(n);
+    if (res == 0) {
+        // un solo registro coincide (la descripción termina en ',')
+        Producto p;
+        fila_generada(n / 2 + 1, &p);
+        snprintf(consulta, sizeof(consulta), "%s,", p.descripcion);
+        medir("buscar", op_buscar, 1, NULL);
+        medir("filtro", op_filtro, 1, NULL);
+        medir("agregar", op_agregar, LOTE_DML, vaciar_tx);
+        medir("modificar", op_modificar, LOTE_DML, vaciar_tx);
+        medir("eliminar", op_eliminar, LOTE_DML, vaciar_tx);
+        preparar_aplicar();
+        medir("aplicar", op_aplicar, 1, preparar_aplicar);
+        trans_reset(&tx);
+    }
+    // los motores binario y de log no deben exportar a CSV al cerrar: se cierran directamente
+    if (MOTOR_DB == MOTOR_BIN) bin_cerrar();
+    else if (MOTOR_DB == MOTOR_COL) col_cerrar();
+    else if (MOTOR_DB == MOTOR_LOG) dblog_cerrar();
+    else csv_cerrar();
+    unlink(ARCHIVO_BIN);
+    dblog_eliminar_segmentos(ARCHIVO_SEG);
+    return res;
+}
+
+// ====== Programa ======
+static int parsear_tamanos(const char *s) {
+    char copia[256];
+    char *resto = NULL;
+    n_tamanos = 0;
+    strncpy(copia, s, sizeof(copia) - 1);
+    copia[sizeof(copia) - 1] = '\0';
+    for (char *t = strtok_r(copia, ",", &resto); t; t = strtok_r(NULL, ",", &resto)) {
+        double v = atof(t); // acepta 1e6
+        if (v < LOTE_DML || v > 2e9 || n_tamanos == MAX_TAMANOS) return -1;
+        tamanos[n_tamanos++] = (size_t)v;
+    }
+    return n_tamanos > 0 ? 0 : -1;
+}
+
+static void uso(const char *prog) {
+    fprintf(stderr,
+        "Uso: %s [opciones]\n"
+        "  -f archivo     plantilla: CSV generado por ejercicio1_productos (%s)\n"
+        "  -n tamaños     filas por tabla, separadas por coma (1e3,1e4,1e5,1e6,1e7)\n"
+        "  -m motor       csv | bin | col | log (csv)\n"
+        "  -p n           particiones de la tabla con el motor csv (%d)\n"
+        "  -d directorio  dónde crear los archivos temporales (data)\n"
+        "  -t ms          tiempo mínimo medido por operación (200)\n"
+        "  -b archivo     salida previa de bench para comparar ns/op\n"
+        "  -u porcentaje  aumento de ns/op que cuenta como regresión (25)\n",
+        prog, PLANTILLA, PARTICIONES_DEF);
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+    CACHE_MAX = 0; // se mide el recorrido de la tabla, no la cache de consultas
+    while ((opt = getopt(argc, argv, "f:n:m:p:d:t:b:u:h")) != -1) {
+        switch (opt) {
+            case 'f': strncpy(PLANTILLA, optarg, sizeof(PLANTILLA) - 1); break;
+            case 'n':
+                if (parsear_tamanos(optarg) != 0) {
+                    fprintf(stderr, "Tamaños inválidos (mínimo %d): %s\n", LOTE_DML, optarg);
+                    return 1;
+                }
+                break;
+            case 'm': MOTOR_DB = motor_desde_nombre(optarg); break;
+            case 'p': PARTICIONES_TABLA = atoi(optarg); break;
+            case 'd': strncpy(DIRECTORIO, optarg, sizeof(DIRECTORIO) - 1); break;
+            case 't': MIN_MS = atoi(optarg); break;
+            case 'b': strncpy(BASE, optarg, sizeof(BASE) - 1); break;
+            case 'u': UMBRAL = atof(optarg); break;
+            default: uso(argv[0]); return 1;
+        }
+    }
+    if (MOTOR_DB < 0 || MIN_MS <= 0 || PARTICIONES_TABLA <= 0) {
+        uso(argv[0]);
+        return 1;
+    }
+    if (BASE[0] && cargar_base() != 0) return 1;
+    if (cargar_plantilla() != 0) return 1;
+    trans_iniciar(&tx);
+
+    particiones_configurar(MOTOR_DB == MOTOR_CSV ? PARTICIONES_TABLA : 1);
+    printf("motor: %s (%d particiones)\n", motor_nombre(MOTOR_DB), particiones_cantidad());
+    printf("%-10s %-10s %12s %10s %10s %10s%s\n", "filas", "operacion", "ns/op",
+           "allocs/op", "B/op", "ops", n_base ? "      base" : "");
+    for (int i = 0; i < n_tamanos; i++) {
+        if (medir_tamano(tamanos[i]) != 0) return 1;
+    }
+    trans_liberar(&tx);
+    free(plantilla);
+
+    if (regresiones) {
+        printf("❌ %d medición(es) más de %.0f%% por encima de %s\n", regresiones, UMBRAL, BASE);
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "bloqueos.h"
+#include "indice.h"
+#include "metricas.h"
+
+int LOCK_TIMEOUT_MS = LOCK_TIMEOUT_MS_DEF;
+
+typedef struct {
+    int id;
+    uint64_t duenio;   /* marca de la transacción que lo tiene */
+} Bloqueo;
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t liberado;
+    Bloqueo *b;
+    size_t n, cap;
+    IndiceId idx;      /* id -> posición en b */
+} Franja;
+
+static Franja franjas[BLOQUEO_FRANJAS];
+static atomic_ullong marca_siguiente = 1;
+static atomic_ullong total_esperas = 0;
+static atomic_ullong total_abortos = 0;
+static atomic_ullong total_timeouts = 0;
+
+void bloqueos_iniciar() {
+    for (int i = 0; i < BLOQUEO_FRANJAS; i++) {
+        pthread_mutex_init(&franjas[i].mutex, NULL);
+        pthread_cond_init(&franjas[i].liberado, NULL);
+        franjas[i].b = NULL;
+        franjas[i].n = franjas[i].cap = 0;
+        indice_iniciar(&franjas[i].idx);
+    }
+}
+
+uint64_t bloqueo_nueva_marca() {
+    return atomic_fetch_add(&marca_siguiente, 1);
+}
+
+// Los rangos de IDs de cada generador son contiguos: mezclar antes de elegir franja
+static Franja *franja_de(int id) {
+    uint32_t h = (uint32_t)id * 2654435761u;
+    return &franjas[(h >> 16) & (BLOQUEO_FRANJAS - 1)];
+}
+
+static int recordar(Transaccion *t, int id) {
+    if (t->n_bloq == t->cap_bloq) {
+        size_t nueva = t->cap_bloq ? t->cap_bloq * 2 : 16;
+        int *b = realloc(t->bloqueados, nueva * sizeof(int));
+        if (!b) return -1;
+        t->bloqueados = b;
+        t->cap_bloq = nueva;
+    }
+    t->bloqueados[t->n_bloq++] = id;
+    return 0;
+}
+
+// Quita la entrada de la franja (con su mutex tomado)
+static void quitar(Franja *f, int id, uint64_t duenio) {
+    int32_t pos = indice_buscar(&f->idx, id);
+    if (pos < 0 || f->b[pos].duenio != duenio) return;
+    indice_borrar(&f->idx, id);
+    f->n--;
+    if ((size_t)pos != f->n) {
+        f->b[pos] = f->b[f->n];
+        indice_poner(&f->idx, f->b[pos].id, pos);
+    }
+}
+
+int bloqueo_adquirir(Transaccion *t, int id) {
+    if (id <= 0) return BLOQUEO_OK; // IDs inválidos no llegan a escribirse
+    Franja *f = franja_de(id);
+
+    struct timespec limite;
+    if (LOCK_TIMEOUT_MS > 0) {
+        clock_gettime(CLOCK_REALTIME, &limite);
+        limite.tv_sec += LOCK_TIMEOUT_MS / 1000;
+        limite.tv_nsec += (long)(LOCK_TIMEOUT_MS % 1000) * 1000000L;
+        limite.tv_sec += limite.tv_nsec / 1000000000L;
+        limite.tv_nsec %= 1000000000L;
+    }
+
+    int espero = 0;
+    uint64_t inicio = 0;
+    int32_t pos;
+    pthread_mutex_lock(&f->mutex);
+    while ((pos = indice_buscar(&f->idx, id)) >= 0 && f->b[pos].duenio != t->marca) {
+        if (t->marca > f->b[pos].duenio) {
+            // wait-die: la más nueva no espera a una más vieja
+            pthread_mutex_unlock(&f->mutex);
+            atomic_fetch_add(&total_abortos, 1);
+            return BLOQUEO_ABORTA;
+        }
+        if (!espero) inicio = metricas_ahora_ns();
+        espero = 1;
+        if (LOCK_TIMEOUT_MS <= 0) {
+            pthread_cond_wait(&f->liberado, &f->mutex);
+        } else if (pthread_cond_timedwait(&f->liberado, &f->mutex, &limite) == ETIMEDOUT) {
+            pthread_mutex_unlock(&f->mutex);
+            metricas_registrar(MET_ESPERA_FILA, metricas_ahora_ns() - inicio);
+            atomic_fetch_add(&total_timeouts, 1);
+            return BLOQUEO_TIMEOUT;
+        }
+    }
+    if (espero) {
+        metricas_registrar(MET_ESPERA_FILA, metricas_ahora_ns() - inicio);
+        atomic_fetch_add(&total_esperas, 1);
+    }
+    if (pos >= 0) {
+        pthread_mutex_unlock(&f->mutex); // ya era nuestro
+        return BLOQUEO_OK;
+    }
+
+    if (f->n == f->cap) {
+        size_t nueva = f->cap ? f->cap * 2 : 16;
+        Bloqueo *b = realloc(f->b, nueva * sizeof(Bloqueo));
+        if (!b) {
+            pthread_mutex_unlock(&f->mutex);
+            return BLOQUEO_TIMEOUT;
+        }
+        f->b = b;
+        f->cap = nueva;
+    }
+    if (indice_poner(&f->idx, id, (int32_t)f->n) != 0) {
+        pthread_mutex_unlock(&f->mutex);
+        return BLOQUEO_TIMEOUT;
+    }
+    f->b[f->n].id = id;
+    f->b[f->n].duenio = t->marca;
+    f->n++;
+    pthread_mutex_unlock(&f->mutex);
+
+    if (recordar(t, id) != 0) {
+        pthread_mutex_lock(&f->mutex);
+        quitar(f, id, t->marca);
+        pthread_cond_broadcast(&f->liberado);
+        pthread_mutex_unlock(&f->mutex);
+        return BLOQUEO_TIMEOUT;
+    }
+    return BLOQUEO_OK;
+}
+
+void bloqueo_liberar_todos(Transaccion *t) {
+    for (size_t i = 0; i < t->n_bloq; i++) {
+        Franja *f = franja_de(t->bloqueados[i]);
+        pthread_mutex_lock(&f->mutex);
+        quitar(f, t->bloqueados[i], t->marca);
+        pthread_cond_broadcast(&f->liberado);
+        pthread_mutex_unlock(&f->mutex);
+    }
+    t->n_bloq = 0;
+}
+
+void bloqueo_estadisticas(uint64_t *esperas, uint64_t *abortos, uint64_t *timeouts) {
+    if (esperas) *esperas = atomic_load(&total_esperas);
+    if (abortos) *abortos = atomic_load(&total_abortos);
+    if (timeouts) *timeouts = atomic_load(&total_timeouts);
+}
@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "cache.h"
+#include "db.h"
+#include "parser_csv.h"
+#include "utils.h"
+
+long CACHE_MAX = CACHE_MAX_DEF;
+
+#define CLAVE_MAX (DESC_MAX * 4)
+
+typedef struct Entrada {
+    struct Entrada *sig_hash;
+    struct Entrada *ant, *sig;   // lista LRU: cabeza = más reciente
+    uint32_t hash;
+    int refs;                    // hilos enviando el texto ahora
+    int fuera;                   // ya se quitó de la tabla (se libera con refs == 0)
+    size_t tam;                  // bytes contabilizados en 'bytes'
+    size_t len;
+    char *clave;
+    char texto[];                // respuesta + '\0', seguida de la clave
+} Entrada;
+
+// Tabla hash + lista LRU (protegidas por mutex_cache)
+static Entrada *cubetas[CACHE_CUBETAS];
+static Entrada *lru_cabeza = NULL, *lru_cola = NULL;
+static int n_entradas = 0;
+static size_t bytes = 0;
+static uint64_t version_cache = 0;
+static uint64_t aciertos = 0, fallos = 0, desalojos = 0, invalidadas = 0;
+static pthread_mutex_t mutex_cache = PTHREAD_MUTEX_INITIALIZER;
+
+// FNV-1a
+static uint32_t hash_clave(const char *s) {
+    uint32_t h = 2166136261u;
+    for (; *s; s++) h = (h ^ (unsigned char)*s) * 16777619u;
+    return h;
+}
+
+// "BUSCAR <texto>" / "FILTRO <n>"; -1 si el comando no es cacheable o el
+// argumento es inválido (la consulta responde el error)
+static int normalizar(const char *cmd, const char *arg, char *clave, size_t size) {
+    if (!arg) return -1;
+    while (*arg == ' ') arg++;
+    if (*arg == '\0') return -1;
+    if (strcmp(cmd, "BUSCAR") == 0) {
+        // el texto se compara tal cual (incluidos espacios finales)
+        if (snprintf(clave, size, "BUSCAR %s", arg) >= (int)size) return -1;
+        return 0;
+    }
+    if (strcmp(cmd, "FILTRO") == 0) {
+        // mismo criterio que filtrar_generador: el argumento entero, sin basura
+        size_t n = strlen(arg);
+        while (n > 0 && arg[n - 1] == ' ') n--;
+        int gen;
+        if (csv_entero(arg, n, &gen) != 0 || gen <= 0) return -1;
+        snprintf(clave, size, "FILTRO %d", gen);
+        return 0;
+    }
+    return -1;
+}
+
+static int cacheable(const Transaccion *t) {
+    return CACHE_MAX > 0 && (!t || t->n == 0);
+}
+
+static void lru_quitar(Entrada *e) {
+    if (e->ant) e->ant->sig = e->sig; else lru_cabeza = e->sig;
+    if (e->sig) e->sig->ant = e->ant; else lru_cola = e->ant;
+    e->ant = e->sig = NULL;
+}
+
+static void lru_al_frente(Entrada *e) {
+    e->ant = NULL;
+    e->sig = lru_cabeza;
+    if (lru_cabeza) lru_cabeza->ant = e;
+    lru_cabeza = e;
+    if (!lru_cola) lru_cola = e;
+}
+
+// Quita la entrada de la tabla; si alguien la está enviando la libera el último
+static void sacar(Entrada *e) {
+    Entrada **p = &cubetas[e->hash & (CACHE_CUBETAS - 1)];
+    while (*p != e) p = &(*p)->sig_hash;
+    *p = e->sig_hash;
+    lru_quitar(e);
+    n_entradas--;
+    bytes -= e->tam;
+    e->fuera = 1;
+    if (e->refs == 0) free(e);
+}
+
+static Entrada *buscar(const char *clave, uint32_t h) {
+    for (Entrada *e = cubetas[h & (CACHE_CUBETAS - 1)]; e; e = e->sig_hash) {
+        if (e->hash == h && strcmp(e->clave, clave) == 0) return e;
+    }
+    return NULL;
+}
+
+// Un COMMIT cambió la base: nada de lo guardado sirve
+static void invalidar_si_cambio(uint64_t version) {
+    if (version == version_cache) return;
+    invalidadas += (uint64_t)n_entradas;
+    while (lru_cabeza) sacar(lru_cabeza);
+    version_cache = version;
+}
+
+static void desalojar_hasta(size_t limite) {
+    while (lru_cola && bytes > limite) {
+        sacar(lru_cola);
+        desalojos++;
+    }
+}
+
+int cache_responder(int socket, const char *cmd, const char *arg, const Transaccion *t) {
+    char clave[CLAVE_MAX];
+    if (!cacheable(t) || normalizar(cmd, arg, clave, sizeof(clave)) != 0) return -1;
+    uint32_t h = hash_clave(clave);
+
+    pthread_mutex_lock(&mutex_cache);
+    invalidar_si_cambio(db_version());
+    Entrada *e = buscar(clave, h);
+    if (!e) {
+        fallos++;
+        pthread_mutex_unlock(&mutex_cache);
+        return -1;
+    }
+    aciertos++;
+    lru_quitar(e);
+    lru_al_frente(e);
+    e->refs++;
+    pthread_mutex_unlock(&mutex_cache);
+
+    // el envío puede bloquear con un cliente lento: fuera del mutex
+    enviar(socket, e->texto);
+
+    pthread_mutex_lock(&mutex_cache);
+    if (--e->refs == 0 && e->fuera) free(e);
+    pthread_mutex_unlock(&mutex_cache);
+    return 0;
+}
+
+void cache_guardar(const char *cmd, const char *arg, const Transaccion *t,
+                   uint64_t version, const char *texto, size_t len) {
+    char clave[CLAVE_MAX];
+    if (!cacheable(t) || normalizar(cmd, arg, clave, sizeof(clave)) != 0) return;
+    size_t largo_clave = strlen(clave) + 1;
+    size_t tam = sizeof(Entrada) + len + 1 + largo_clave;
+    // una respuesta enorme desalojaría todo lo demás
+    if (tam > (size_t)CACHE_MAX / 4) return;
+    uint32_t h = hash_clave(clave);
+
+    Entrada *nueva = malloc(tam);
+    if (!nueva) return;
+    memset(nueva, 0, sizeof(*nueva));
+    nueva->hash = h;
+    nueva->tam = tam;
+    nueva->len = len;
+    memcpy(nueva->texto, texto, len);
+    nueva->texto[len] = '\0';
+    nueva->clave = nueva->texto + len + 1;
+    memcpy(nueva->clave, clave, largo_clave);
+
+    pthread_mutex_lock(&mutex_cache);
+    if (version < version_cache) {
+        // otra consulta ya vio un COMMIT posterior: este resultado es viejo
+        pthread_mutex_unlock(&mutex_cache);
+        free(nueva);
+        return;
+    }
+    invalidar_si_cambio(version);
+    Entrada *vieja = buscar(clave, h);
+    if (vieja) sacar(vieja);
+    Entrada **cubeta = &cubetas[h & (CACHE_CUBETAS - 1)];
+    nueva->sig_hash = *cubeta;
+    *cubeta = nueva;
+    lru_al_frente(nueva);
+    n_entradas++;
+    bytes += tam;
+    desalojar_hasta((size_t)CACHE_MAX);
+    pthread_mutex_unlock(&mutex_cache);
+}
+
+void cache_reconfigurar(void) {
+    pthread_mutex_lock(&mutex_cache);
+    desalojar_hasta(CACHE_MAX > 0 ? (size_t)CACHE_MAX : 0);
+    pthread_mutex_unlock(&mutex_cache);
+}
+
+void cache_vaciar(void) {
+    pthread_mutex_lock(&mutex_cache);
+    while (lru_cabeza) sacar(lru_cabeza);
+    pthread_mutex_unlock(&mutex_cache);
+}
+
+void cache_estadisticas(int *ent, size_t *byt, uint64_t *aci, uint64_t *fal,
+                        uint64_t *des, uint64_t *inv) {
+    pthread_mutex_lock(&mutex_cache);
+    if (ent) *ent = n_entradas;
+    if (byt) *byt = bytes;
+    if (aci) *aci = aciertos;
+    if (fal) *fal = fallos;
+    if (des) *des = desalojos;
+    if (inv) *inv = invalidadas;
+    pthread_mutex_unlock(&mutex_cache);
+}
@@ -0,0 +1,448 @@
+// carga.c — generador de carga para el servidor de base de datos.
+// Abre N conexiones (un hilo cada una), envía una mezcla configurable de
+// comandos con claves uniformes o zipfianas, en lazo cerrado (el siguiente
+// comando sale al llegar la respuesta) o abierto (a una tasa fija), y reporta
+// throughput y latencias p50/p99/p999 por tipo de comando.
+// Con -P las transacciones viajan en tubería (cliente_db.h): cada conexión
+// mantiene hasta P transacciones en vuelo y mide cada comando al llegar su respuesta.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <getopt.h>
+#include <pthread.h>
+#include "cliente_db.h"
+
+typedef enum {
+    OP_MOSTRAR = 0, OP_BUSCAR, OP_FILTRO, OP_AGREGAR, OP_MODIFICAR, OP_ELIMINAR,
+    OP_BEGIN, OP_COMMIT, OP_TIPOS
+} TipoOp;
+
+#define OP_MEZCLA 6 /* tipos elegibles en la mezcla (sin BEGIN/COMMIT) */
+
+static const char *nombres_op[OP_TIPOS] = {
+    "MOSTRAR", "BUSCAR", "FILTRO", "AGREGAR", "MODIFICAR", "ELIMINAR", "BEGIN", "COMMIT"
+};
+
+// ====== Configuración ======
+static char HOST[256] = "127.0.0.1";
+static int PUERTO = 8080;
+static int CONEXIONES = 4;
+static int DURACION_S = 10;
+static long OPS_POR_CONEXION = 0;     /* 0 = por duración */
+static double TASA = 0;               /* ops/s totales; 0 = lazo cerrado */
+static int CLAVES = 100;              /* IDs 1..CLAVES */
+static int ZIPF = 0;
+static double THETA = 0.99;
+static int GENERADORES = 4;
+static int mezcla[OP_MEZCLA] = { 0, 40, 10, 5, 40, 5 };
+static int PROFUNDIDAD = 0;           /* transacciones en vuelo por conexión; 0 = de a una */
+static int COMPRIMIR = 0;
+
+// ====== Estado por hilo ======
+typedef struct {
+    uint64_t *v;
+    size_t n, cap;
+} Muestras;
+
+typedef struct {
+    int num;
+    pthread_t hilo;
+    uint64_t rng;
+    ConexionDb *c;
+    const char *resp;
+    long enviadas;            /* en tubería: operaciones enviadas (ops cuenta las respondidas) */
+    long siguiente_id;        /* para AGREGAR: IDs nuevos fuera del rango de claves */
+    Muestras muestras[OP_TIPOS];
+    uint64_t ops, fallidas, abortos, errores;
+} Hilo;
+
+static double zipf_zetan, zipf_eta, zipf_alfa, zipf_mitad;
+
+static uint64_t ahora_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t aleatorio(Hilo *h) {
+    // xorshift64*
+    h->rng ^= h->rng >> 12;
+    h->rng ^= h->rng << 25;
+    h->rng ^= h->rng >> 27;
+    return h->rng * 2685821657736338717ULL;
+}
+
+static double uniforme01(Hilo *h) {
+    return (aleatorio(h) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Zipf por el método de Gray et al. (el mismo que usa YCSB)
+static void zipf_preparar(int n, double theta) {
+    double zeta2 = 0;
+    zipf_zetan = 0;
+    for (int i = 1; i <= n; i++) {
+        zipf_zetan += 1.0 / pow(i, theta);
+        if (i == 2) zeta2 = zipf_zetan;
+    }
+    if (n < 2) zeta2 = zipf_zetan;
+    zipf_alfa = 1.0 / (1.0 - theta);
+    zipf_eta = (1 - pow(2.0 / n, 1 - theta)) / (1 - zeta2 / zipf_zetan);
+    zipf_mitad = 1 + pow(0.5, theta);
+}
+
+static int clave(Hilo *h) {
+    if (!ZIPF) return 1 + (int)(aleatorio(h) % (uint64_t)CLAVES);
+    double u = uniforme01(h);
+    double uz = u * zipf_zetan;
+    if (uz < 1.0) return 1;
+    if (uz < zipf_mitad) return 2;
+    int k = 1 + (int)(CLAVES * pow(zipf_eta * u - zipf_eta + 1, zipf_alfa));
+    return k > CLAVES ? CLAVES : k;
+}
+
+static TipoOp elegir_op(Hilo *h) {
+    int total = 0;
+    for (int i = 0; i < OP_MEZCLA; i++) total += mezcla[i];
+    int r = (int)(aleatorio(h) % (uint64_t)total);
+    for (int i = 0; i < OP_MEZCLA; i++) {
+        if (r < mezcla[i]) return (TipoOp)i;
+        r -= mezcla[i];
+    }
+    return OP_BUSCAR;
+}
+
+static void agregar_muestra(Muestras *m, uint64_t ns) {
+    if (m->n == m->cap) {
+        size_t nueva = m->cap ? m->cap * 2 : 4096;
+        uint64_t *v = realloc(m->v, nueva * sizeof(uint64_t));
+        if (!v) return;
+        m->v = v;
+        m->cap = nueva;
+    }
+    m->v[m->n++] = ns;
+}
+
+static int pedir(Hilo *h, const char *cmd) {
+    return cdb_pedir(h->c, cmd, &h->resp, NULL);
+}
+
+// Arma el comando de un tipo en buf; devuelve si escribe (requiere COMMIT)
+static int armar_comando(Hilo *h, TipoOp op, char *buf, size_t size) {
+    int id = clave(h);
+    int gen = 1 + id % GENERADORES;
+    switch (op) {
+        case OP_MOSTRAR:
+            snprintf(buf, size, "MOSTRAR\n");
+            return 0;
+        case OP_BUSCAR:
+            snprintf(buf, size, "BUSCAR G%d_%03d\n", gen, id % 1000);
+            return 0;
+        case OP_FILTRO:
+            snprintf(buf, size, "FILTRO %d\n", gen);
+            return 0;
+        case OP_AGREGAR: {
+            long nuevo = h->siguiente_id++;
+            snprintf(buf, size, "AGREGAR %ld,GC_%ld,%d,2025-10-16,12:00:00,%ld\n",
+                     nuevo, nuevo, (int)(aleatorio(h) % 50) + 1, 1 + nuevo % GENERADORES);
+            return 1;
+        }
+        case OP_MODIFICAR:
+            snprintf(buf, size, "MODIFICAR %d;%d,G%d_%03d,%d,2025-10-16,12:00:00,%d\n",
+                     id, id, gen, id % 1000, (int)(aleatorio(h) % 50) + 1, gen);
+            return 1;
+        case OP_ELIMINAR:
+            snprintf(buf, size, "ELIMINAR %d\n", id);
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Registra la respuesta de una operación; 1 si abortó la transacción
+static int contar(Hilo *h, TipoOp tipo, const char *resp, uint64_t inicio) {
+    agregar_muestra(&h->muestras[tipo], ahora_ns() - inicio);
+    if (strstr(resp, "Conflicto")) {
+        h->abortos++;
+        return 1; // la transacción fue abortada
+    }
+    if (strncmp(resp, "❌", strlen("❌")) == 0 || strncmp(resp, "⚠️", strlen("⚠️")) == 0) {
+        h->fallidas++;
+    }
+    return 0;
+}
+
+// Una operación medida; latencia desde 'inicio' (en lazo abierto, la hora planificada)
+static int medir(Hilo *h, TipoOp tipo, const char *cmd, uint64_t inicio) {
+    if (pedir(h, cmd) != 0) {
+        h->errores++;
+        return -1;
+    }
+    return contar(h, tipo, h->resp, inicio);
+}
+
+// ====== Tubería (-P) ======
+// Comando en vuelo; lo cuenta el callback, en el hilo lector de la conexión
+typedef struct {
+    Hilo *h;
+    TipoOp tipo;
+    int es_op;                /* la operación de la mezcla (no BEGIN/COMMIT) */
+    uint64_t inicio;
+} EnVuelo;
+
+static void al_responder(void *ctx, const char *texto, size_t len, int error) {
+    (void)len;
+    EnVuelo *v = ctx;
+    if (error) {
+        v->h->errores++;
+    } else {
+        contar(v->h, v->tipo, texto, v->inicio);
+        if (v->es_op) v->h->ops++;
+    }
+    free(v);
+}
+
+static int enviar_medido(Hilo *h, TipoOp tipo, int es_op, const char *cmd, uint64_t inicio) {
+    EnVuelo *v = malloc(sizeof(EnVuelo));
+    if (!v) return -1;
+    *v = (EnVuelo){ h, tipo, es_op, inicio };
+    if (cdb_enviar(h->c, cmd, al_responder, v) != 0) {
+        free(v);
+        h->errores++;
+        return -1;
+    }
+    return 0;
+}
+
+// Una transacción completa sin esperar respuestas: BEGIN, la operación y
+// COMMIT. Si la operación aborta por conflicto, el COMMIT responde que no
+// hay transacción y el ciclo sigue con el próximo BEGIN
+static int enviar_transaccion(Hilo *h, uint64_t inicio) {
+    char cmd[256];
+    TipoOp op = elegir_op(h);
+    armar_comando(h, op, cmd, sizeof(cmd));
+    if (enviar_medido(h, OP_BEGIN, 0, "BEGIN\n", ahora_ns()) != 0) return -1;
+    if (enviar_medido(h, op, 1, cmd, inicio) != 0) return -1;
+    return enviar_medido(h, OP_COMMIT, 0, "COMMIT\n", ahora_ns());
+}
+
+static void *trabajador(void *arg) {
+    Hilo *h = arg;
+    char error[256];
+    h->c = cdb_conectar(HOST, PUERTO, COMPRIMIR ? CDB_COMPRIMIR : 0, error, sizeof(error));
+    if (!h->c) {
+        fprintf(stderr, "conexión %d: %s\n", h->num, error);
+        h->errores++;
+        return NULL;
+    }
+    if (PROFUNDIDAD > 0) cdb_tuberia(h->c, PROFUNDIDAD * 3); // BEGIN + operación + COMMIT
+
+    char cmd[256];
+    int en_tx = 0;
+    uint64_t t0 = ahora_ns();
+    uint64_t fin = t0 + (uint64_t)DURACION_S * 1000000000ULL;
+    uint64_t intervalo = TASA > 0 ? (uint64_t)(1e9 * CONEXIONES / TASA) : 0;
+    uint64_t planificada = t0 + (intervalo ? intervalo * (uint64_t)h->num / (uint64_t)CONEXIONES : 0);
+
+    while (OPS_POR_CONEXION > 0 ? (PROFUNDIDAD > 0 ? h->enviadas : (long)h->ops) < OPS_POR_CONEXION
+                                : ahora_ns() < fin) {
+        uint64_t inicio;
+        if (intervalo) {
+            // lazo abierto: esperar la hora planificada y medir desde ella
+            // (así una respuesta lenta no oculta la cola que genera)
+            struct timespec ts = { (time_t)(planificada / 1000000000ULL), (long)(planificada % 1000000000ULL) };
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+                ;
+            inicio = planificada;
+            planificada += intervalo;
+        } else {
+            inicio = ahora_ns();
+        }
+
+        if (PROFUNDIDAD > 0) {
+            // cdb_enviar bloquea mientras haya PROFUNDIDAD transacciones en vuelo
+            if (enviar_transaccion(h, inicio) != 0) break;
+            h->enviadas++;
+            continue;
+        }
+        if (!en_tx) {
+            int r = medir(h, OP_BEGIN, "BEGIN\n", ahora_ns());
+            if (r < 0) break;
+            en_tx = 1;
+        }
+        TipoOp op = elegir_op(h);
+        int escribe = armar_comando(h, op, cmd, sizeof(cmd));
+        int r = medir(h, op, cmd, inicio);
+        if (r < 0) break;
+        h->ops++;
+        if (r == 1) {
+            en_tx = 0; // abortada por wait-die: el próximo ciclo hace BEGIN
+            continue;
+        }
+        if (escribe) {
+            if (medir(h, OP_COMMIT, "COMMIT\n", ahora_ns()) < 0) break;
+            en_tx = 0;
+        }
+    }
+    cdb_esperar(h->c); // en tubería: los callbacks terminan antes del reporte
+    if (en_tx) pedir(h, "ROLLBACK\n");
+    pedir(h, "SALIR\n");
+    cdb_cerrar(h->c);
+    return NULL;
+}
+
+// ====== Reporte ======
+static int comparar(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentil(const uint64_t *v, size_t n, double p) {
+    if (n == 0) return 0;
+    size_t i = (size_t)ceil(p * (double)n);
+    if (i > 0) i--;
+    if (i >= n) i = n - 1;
+    return v[i] / 1000.0;
+}
+
+static void reportar(Hilo *hilos, double segundos) {
+    uint64_t ops = 0, fallidas = 0, abortos = 0, errores = 0;
+    for (int i = 0; i < CONEXIONES; i++) {
+        ops += hilos[i].ops;
+        fallidas += hilos[i].fallidas;
+        abortos += hilos[i].abortos;
+        errores += hilos[i].errores;
+    }
+    printf("\n=== Resultado: %d conexiones, %.2f s, %s, claves %s (%d) ===\n",
+           CONEXIONES, segundos, TASA > 0 ? "lazo abierto" : "lazo cerrado",
+           ZIPF ? "zipf" : "uniformes", CLAVES);
+    if (TASA > 0) printf("tasa objetivo: %.0f ops/s\n", TASA);
+    if (PROFUNDIDAD > 0) printf("tubería: hasta %d transacciones en vuelo por conexión\n", PROFUNDIDAD);
+    printf("operaciones: %llu (%.0f ops/s)  fallidas: %llu  abortos: %llu  errores: %llu\n",
+           (unsigned long long)ops, ops / segundos, (unsigned long long)fallidas,
+           (unsigned long long)abortos, (unsigned long long)errores);
+    printf("%-10s %10s %10s %10s %10s %10s %10s\n",
+           "comando", "n", "ops/s", "p50_us", "p99_us", "p999_us", "max_us");
+
+    for (int t = 0; t < OP_TIPOS; t++) {
+        size_t n = 0;
+        for (int i = 0; i < CONEXIONES; i++) n += hilos[i].muestras[t].n;
+        if (n == 0) continue;
+        uint64_t *v = malloc(n * sizeof(uint64_t));
+        if (!v) continue;
+        size_t k = 0;
+        for (int i = 0; i < CONEXIONES; i++) {
+            memcpy(v + k, hilos[i].muestras[t].v, hilos[i].muestras[t].n * sizeof(uint64_t));
+            k += hilos[i].muestras[t].n;
+        }
+        qsort(v, n, sizeof(uint64_t), comparar);
+        printf("%-10s %10zu %10.0f %10.1f %10.1f %10.1f %10.1f\n", nombres_op[t], n, n / segundos,
+               percentil(v, n, 0.50), percentil(v, n, 0.99), percentil(v, n, 0.999), v[n - 1] / 1000.0);
+        free(v);
+    }
+}
+
+// "BUSCAR:40,MODIFICAR:60" -> pesos
+static int parsear_mezcla(const char *s) {
+    int nueva[OP_MEZCLA] = {0};
+    char copia[256];
+    strncpy(copia, s, sizeof(copia) - 1);
+    copia[sizeof(copia) - 1] = '\0';
+    char *resto = NULL;
+    for (char *par = strtok_r(copia, ",", &resto); par; par = strtok_r(NULL, ",", &resto)) {
+        char *dos = strchr(par, ':');
+        if (!dos) return -1;
+        *dos = '\0';
+        int i;
+        for (i = 0; i < OP_MEZCLA && strcasecmp(par, nombres_op[i]) != 0; i++)
+            ;
+        if (i == OP_MEZCLA || atoi(dos + 1) < 0) return -1;
+        nueva[i] = atoi(dos + 1);
+    }
+    int total = 0;
+    for (int i = 0; i < OP_MEZCLA; i++) total += nueva[i];
+    if (total <= 0) return -1;
+    memcpy(mezcla, nueva, sizeof(mezcla));
+    return 0;
+}
+
+static void uso(const char *prog) {
+    fprintf(stderr,
+        "Uso: %s [opciones]\n"
+        "  -H host        servidor (127.0.0.1)\n"
+        "  -p puerto      puerto (8080)\n"
+        "  -c conexiones  conexiones concurrentes, un hilo cada una (4)\n"
+        "  -d segundos    duración (10)\n"
+        "  -n ops         operaciones por conexión (en lugar de -d)\n"
+        "  -r ops/s       tasa total en lazo abierto (0 = lazo cerrado)\n"
+        "  -m mezcla      pesos por comando, ej. BUSCAR:40,FILTRO:10,AGREGAR:5,MODIFICAR:40,ELIMINAR:5\n"
+        "  -k claves      IDs consultados/modificados: 1..claves (100)\n"
+        "  -z theta       claves zipfianas con ese sesgo (0.99 típico); por defecto uniformes\n"
+        "  -g n           cantidad de generadores para BUSCAR/FILTRO (4)\n"
+        "  -P n           tubería: hasta n transacciones (BEGIN+op+COMMIT) en vuelo por conexión\n"
+        "  -Z             pedir respuestas comprimidas\n",
+        prog);
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "H:p:c:d:n:r:m:k:z:g:P:Zh")) != -1) {
+        switch (opt) {
+            case 'H': strncpy(HOST, optarg, sizeof(HOST) - 1); break;
+            case 'p': PUERTO = atoi(optarg); break;
+            case 'c': CONEXIONES = atoi(optarg); break;
+            case 'd': DURACION_S = atoi(optarg); break;
+            case 'n': OPS_POR_CONEXION = atol(optarg); break;
+            case 'r': TASA = atof(optarg); break;
+            case 'm':
+                if (parsear_mezcla(optarg) != 0) {
+                    fprintf(stderr, "Mezcla inválida: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'k': CLAVES = atoi(optarg); break;
+            case 'z': ZIPF = 1; THETA = atof(optarg); break;
+            case 'g': GENERADORES = atoi(optarg); break;
+            case 'P': PROFUNDIDAD = atoi(optarg); break;
+            case 'Z': COMPRIMIR = 1; break;
+            default: uso(argv[0]); return 1;
+        }
+    }
+    if (CONEXIONES <= 0 || CLAVES <= 0 || GENERADORES <= 0 || DURACION_S <= 0 || PROFUNDIDAD < 0 ||
+        (ZIPF && (THETA <= 0 || THETA >= 1))) {
+        uso(argv[0]);
+        return 1;
+    }
+    if (ZIPF) zipf_preparar(CLAVES, THETA);
+
+    Hilo *hilos = calloc((size_t)CONEXIONES, sizeof(Hilo));
+    if (!hilos) return 1;
+    uint64_t semilla = ahora_ns();
+    uint64_t t0 = ahora_ns();
+    for (int i = 0; i < CONEXIONES; i++) {
+        hilos[i].num = i;
+        hilos[i].rng = semilla ^ (0x9E3779B97F4A7C15ULL * (uint64_t)(i + 1));
+        hilos[i].siguiente_id = 1000000L + (long)i * 1000000L;
+        if (pthread_create(&hilos[i].hilo, NULL, trabajador, &hilos[i]) != 0) {
+            perror("pthread_create");
+            CONEXIONES = i;
+            break;
+        }
+    }
+    for (int i = 0; i < CONEXIONES; i++) pthread_join(hilos[i].hilo, NULL);
+    double segundos = (ahora_ns() - t0) / 1e9;
+
+    reportar(hilos, segundos);
+
+    for (int i = 0; i < CONEXIONES; i++) {
+        for (int t = 0; t < OP_TIPOS; t++) free(hilos[i].muestras[t].v);
+    }
+    free(hilos);
+    return 0;
+}
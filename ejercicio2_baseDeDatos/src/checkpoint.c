@@ -0,0 +1,294 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <libgen.h>
+#include <pthread.h>
+#include "checkpoint.h"
+#include "db.h"
+#include "db_bin.h"
+#include "db_csv.h"
+#include "db_col.h"
+#include "db_log.h"
+#include "particiones.h"
+#include "wal.h"
+#include "utils.h"
+#include "traza.h"
+
+#define FILAS_POR_TRAMO 4096
+#define REINTENTOS_LSN  1000
+
+char ARCHIVO_CKPT[512] = "data/productos.ckpt";
+int CHECKPOINT_INTERVAL_S = CHECKPOINT_INTERVAL_S_DEF;
+long CHECKPOINT_WAL_MAX = CHECKPOINT_WAL_MAX_DEF;
+int CHECKPOINT_KB_S = CHECKPOINT_KB_S_DEF;
+
+static pthread_mutex_t mutex_checkpoint = PTHREAD_MUTEX_INITIALIZER; /* un checkpoint a la vez */
+static pthread_mutex_t mutex_hilo = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_hilo = PTHREAD_COND_INITIALIZER;
+static pthread_t hilo_ckpt;
+static int hilo_activo = 0;
+static int detener = 0;
+static uint64_t lsn_ultimo = 0;
+
+static double ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// fsync del directorio que contiene path (hace durable el rename)
+static void sincronizar_directorio(const char *path) {
+    char copia[512];
+    strncpy(copia, path, sizeof(copia) - 1);
+    copia[sizeof(copia) - 1] = '\0';
+    int fd = open(dirname(copia), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+uint64_t checkpoint_leer_lsn() {
+    FILE *f = fopen(ARCHIVO_CKPT, "r");
+    if (!f) return 0;
+    unsigned long long lsn = 0;
+    if (fscanf(f, "LSN %llu", &lsn) != 1) lsn = 0;
+    fclose(f);
+    lsn_ultimo = lsn;
+    return (uint64_t)lsn;
+}
+
+static int escribir_lsn(uint64_t lsn) {
+    char tmp[600];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", ARCHIVO_CKPT);
+    FILE *f = fopen(tmp, "w");
+    if (!f) return -1;
+    fprintf(f, "LSN %llu\n", (unsigned long long)lsn);
+    int ok = fflush(f) == 0 && fsync(fileno(f)) == 0;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp, ARCHIVO_CKPT) != 0) {
+        remove(tmp);
+        return -1;
+    }
+    sincronizar_directorio(ARCHIVO_CKPT);
+    return 0;
+}
+
+// Espera (sin mutex) lo necesario para no superar CHECKPOINT_KB_S
+static void limitar_ritmo(size_t bytes, double inicio_ms) {
+    if (CHECKPOINT_KB_S <= 0) return;
+    double esperado_ms = bytes / (CHECKPOINT_KB_S * 1024.0) * 1000.0;
+    double transcurrido = ahora_ms() - inicio_ms;
+    if (esperado_ms > transcurrido) usleep((useconds_t)((esperado_ms - transcurrido) * 1000));
+}
+
+// Motores en memoria que se vuelcan a CSV (csv y col)
+typedef struct {
+    size_t (*posiciones)(void);
+    size_t (*volcar)(FILE *f, size_t desde, size_t max_filas, size_t *bytes);
+    void (*pausar_compactacion)(int pausar); /* NULL si las posiciones no se corren */
+} VolcadoCsv;
+
+static const VolcadoCsv volcado_csv = { csv_posiciones, csv_volcar, NULL };
+static const VolcadoCsv volcado_col = { col_posiciones, col_volcar, col_pausar_compactacion };
+
+// Snapshot CSV por tramos. Entra y sale con todas las particiones tomadas.
+// Es un checkpoint "difuso": filas cambiadas durante el volcado pueden
+// quedar con un valor más nuevo que lsn, lo que es seguro porque la
+// reproducción del WAL es idempotente.
+static int volcar_csv(double inicio_ms, size_t *bytes) {
+    char tmp[600];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", ARCHIVO_DB);
+    FILE *f = fopen(tmp, "w");
+    if (!f) {
+        log_msg("Checkpoint: no se pudo crear %s: %s", tmp, strerror(errno));
+        return -1;
+    }
+    const VolcadoCsv *v = MOTOR_DB == MOTOR_COL ? &volcado_col : &volcado_csv;
+    if (v->pausar_compactacion) v->pausar_compactacion(1);
+    size_t pos = 0;
+    while (1) {
+        uint64_t t_tramo = traza_inicio();
+        pos = v->volcar(f, pos, FILAS_POR_TRAMO, bytes);
+        traza_fin("checkpoint_tramo", t_tramo); // con las particiones tomadas
+        if (pos >= v->posiciones()) break;
+        particiones_desbloquear(particiones_todas());
+        limitar_ritmo(*bytes, inicio_ms);
+        particiones_bloquear(particiones_todas());
+    }
+    if (v->pausar_compactacion) v->pausar_compactacion(0);
+    particiones_desbloquear(particiones_todas());
+
+    uint64_t t_sync = traza_inicio();
+    int ok = fflush(f) == 0 && fsync(fileno(f)) == 0;
+    traza_fin("checkpoint_fsync", t_sync);
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp, ARCHIVO_DB) != 0) {
+        log_msg("Checkpoint: error escribiendo snapshot %s: %s", ARCHIVO_DB, strerror(errno));
+        remove(tmp);
+        particiones_bloquear(particiones_todas());
+        return -1;
+    }
+    sincronizar_directorio(ARCHIVO_DB);
+    particiones_bloquear(particiones_todas());
+    return 0;
+}
+
+// LSN estable: todo commit hasta él ya está aplicado en la tabla. Con exacto
+// además no puede haber commits durables sin aplicar (ni aplicados fuera de
+// orden por encima), lo que con carga puede no darse: -1 tras REINTENTOS_LSN.
+// Si lo consigue vuelve con todas las particiones tomadas.
+static int tomar_lsn_estable(uint64_t *lsn, int exacto) {
+    int intentos = 0;
+    particiones_bloquear(particiones_todas());
+    while ((*lsn = wal_lsn_aplicado()) != wal_lsn() && exacto) {
+        particiones_desbloquear(particiones_todas());
+        if (++intentos >= REINTENTOS_LSN) return -1;
+        usleep(1000);
+        particiones_bloquear(particiones_todas());
+    }
+    return 0;
+}
+
+int checkpoint_ejecutar() {
+    pthread_mutex_lock(&mutex_checkpoint);
+    double inicio = ahora_ms();
+    traza_nuevo_pedido();
+
+    // Los commits por encima del LSN que ya estén aplicados quedan también en
+    // el snapshot y se vuelven a reproducir desde el WAL tras una caída
+    uint64_t lsn = 0;
+    tomar_lsn_estable(&lsn, 0);
+    if (lsn == lsn_ultimo) {
+        particiones_desbloquear(particiones_todas());
+        pthread_mutex_unlock(&mutex_checkpoint);
+        return 0; // nada nuevo desde el último checkpoint
+    }
+
+    size_t bytes = 0;
+    int r;
+    if (MOTOR_DB == MOTOR_BIN) {
+        r = bin_sincronizar();
+    } else if (MOTOR_DB == MOTOR_LOG) {
+        r = dblog_sincronizar(); // los cambios ya están en los segmentos
+    } else {
+        r = volcar_csv(inicio, &bytes);
+    }
+    particiones_desbloquear(particiones_todas());
+
+    if (r == 0 && escribir_lsn(lsn) == 0) {
+        lsn_ultimo = lsn;
+        wal_truncar(lsn);
+        log_msg("Checkpoint LSN=%llu completado (%zu bytes, %.1f ms)",
+                (unsigned long long)lsn, bytes, ahora_ms() - inicio);
+    } else {
+        r = -1;
+    }
+    pthread_mutex_unlock(&mutex_checkpoint);
+    return r;
+}
+
+int checkpoint_reemplazar(const char *snapshot) {
+    pthread_mutex_lock(&mutex_checkpoint);
+    double inicio = ahora_ms();
+
+    // La tabla nueva no tiene los commits aplicados por encima del LSN: tras
+    // una caída se reproducirían sobre ella, así que no puede haber ninguno
+    uint64_t lsn = 0;
+    if (tomar_lsn_estable(&lsn, 1) != 0) {
+        log_msg("Reemplazo: sin LSN estable, se cancela");
+        pthread_mutex_unlock(&mutex_checkpoint);
+        return -1;
+    }
+
+    // El binario y el de log exportan al cerrar; esa copia queda pisada por el rename
+    cerrar_motor();
+    if (rename(snapshot, ARCHIVO_DB) != 0) {
+        log_msg("Reemplazo: no se pudo renombrar %s a %s: %s", snapshot, ARCHIVO_DB, strerror(errno));
+        int r = abrir_motor();
+        particiones_desbloquear(particiones_todas());
+        pthread_mutex_unlock(&mutex_checkpoint);
+        if (r != 0) log_msg("Reemplazo: no se pudo reabrir el motor");
+        return -1;
+    }
+    sincronizar_directorio(ARCHIVO_DB);
+    // se vuelven a crear importando el CSV nuevo
+    if (MOTOR_DB == MOTOR_BIN) unlink(ARCHIVO_BIN);
+    if (MOTOR_DB == MOTOR_LOG) dblog_eliminar_segmentos(ARCHIVO_SEG);
+    int r = abrir_motor();
+    if (r == 0 && MOTOR_DB == MOTOR_BIN) r = bin_sincronizar();
+    if (r == 0 && MOTOR_DB == MOTOR_LOG) r = dblog_sincronizar();
+    particiones_desbloquear(particiones_todas());
+    if (r != 0) {
+        log_msg("Reemplazo: no se pudo cargar %s", ARCHIVO_DB);
+        pthread_mutex_unlock(&mutex_checkpoint);
+        return -1;
+    }
+
+    // Hasta escribir el LSN, una caída reproduciría sobre el snapshot nuevo
+    // commits que ya estaban en la tabla anterior
+    if (escribir_lsn(lsn) == 0) {
+        lsn_ultimo = lsn;
+        wal_truncar(lsn);
+    } else {
+        r = -1;
+    }
+    log_msg("Reemplazo de la tabla con %s en LSN=%llu (%.1f ms)",
+            ARCHIVO_DB, (unsigned long long)lsn, ahora_ms() - inicio);
+    pthread_mutex_unlock(&mutex_checkpoint);
+    return r;
+}
+
+static void *hilo_checkpoint(void *arg) {
+    (void)arg;
+    // las señales las atiende el hilo principal
+    sigset_t set;
+    sigfillset(&set);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    time_t ultimo = time(NULL);
+    pthread_mutex_lock(&mutex_hilo);
+    while (!detener) {
+        struct timespec limite;
+        clock_gettime(CLOCK_REALTIME, &limite);
+        limite.tv_sec += 1;
+        pthread_cond_timedwait(&cond_hilo, &mutex_hilo, &limite);
+        if (detener) break;
+
+        int vencido = CHECKPOINT_INTERVAL_S > 0 && time(NULL) - ultimo >= CHECKPOINT_INTERVAL_S;
+        int wal_grande = CHECKPOINT_WAL_MAX > 0 && wal_tamano() >= CHECKPOINT_WAL_MAX;
+        if (!vencido && !wal_grande) continue;
+
+        pthread_mutex_unlock(&mutex_hilo);
+        checkpoint_ejecutar();
+        ultimo = time(NULL);
+        pthread_mutex_lock(&mutex_hilo);
+    }
+    pthread_mutex_unlock(&mutex_hilo);
+    return NULL;
+}
+
+int checkpoint_iniciar() {
+    detener = 0;
+    if (pthread_create(&hilo_ckpt, NULL, hilo_checkpoint, NULL) != 0) {
+        log_msg("Checkpoint: no se pudo crear el hilo");
+        return -1;
+    }
+    hilo_activo = 1;
+    return 0;
+}
+
+void checkpoint_detener() {
+    if (!hilo_activo) return;
+    pthread_mutex_lock(&mutex_hilo);
+    detener = 1;
+    pthread_cond_signal(&cond_hilo);
+    pthread_mutex_unlock(&mutex_hilo);
+    pthread_join(hilo_ckpt, NULL);
+    hilo_activo = 0;
+}
@@ -1,31 +1,35 @@
-// cliente.c — versión mejorada y estable
-// Corrige el problema de MOSTRAR: ya no hay que presionar Enter ni se mezclan los comandos.
+// cliente.c — cliente interactivo sobre cliente_db.h.
+// Cada respuesta termina con la marca de FIN ON, así que el prompt aparece
+// justo al terminar la salida (sin esperar silencio) y los comandos no se mezclan.
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
-#include <arpa/inet.h>
 #include <sys/select.h>
-#include <fcntl.h>
+#include <sys/socket.h>
 #include <ctype.h>
-#include <termios.h>
 #include <errno.h>
-#include <pthread.h>
 #include <signal.h>
+#include "cliente_db.h"
 
 #define BUFFER_SIZE 4096
-#define TIMEOUT_MS 300 // milisegundos sin datos = fin de respuesta
+
+#define PAGINA_DEF 20 // filas por página de PAGINAR
 
 void mostrar_menu();
 static void quitar_salto(char *s);
-static void limpiar_entrada();
-void check_connection(void *arg);
+static int esperar_entrada(ConexionDb *c);
+static int pedir_y_mostrar(ConexionDb *c, const char *cmd, const char **texto);
+static void paginar(ConexionDb *c, long filas);
 void close_client(int signo);
 
 void mostrar_menu() {
     printf("Comandos disponibles:\n");
-    printf("  MOSTRAR\n");
+    printf("  MOSTRAR [LIMIT n] [OFFSET m]\n");
+    printf("  OPEN / FETCH <n> / CLOSE   (cursor sobre una copia de la tabla)\n");
+    printf("  PAGINAR [n]                (recorre la tabla de a n filas con un cursor)\n");
     printf("  BUSCAR <texto>\n");
     printf("  AGREGAR <ID,Descripcion,Cantidad,Fecha,Hora,Generador>\n");
     printf("  MODIFICAR <ID>;<ID,Descripcion,Cantidad,Fecha,Hora,Generador>\n");
@@ -42,158 +46,135 @@ static void quitar_salto(char *s) {
     s[strcspn(s, "\r\n")] = 0;
 }
 
-// función auxiliar: limpia stdin si quedó basura después de imprimir
-static void limpiar_entrada() {
-    int c;
-    while ((c = getchar()) != '\n' && c != EOF);
+void close_client(int signo) {
+    if (signo == SIGINT) {
+        printf("Cerrando cliente...\n");
+        exit(0);
+    }
 }
 
-void check_connection(void *arg) {
-    int connection_fd = *(int *)arg;
-    char temp_buffer[1];
+// Espera a que el usuario escriba algo, vigilando a la vez el socket: sin
+// pedidos en curso el servidor no manda nada, así que si se vuelve legible
+// es porque cerró la conexión. Devuelve -1 en ese caso
+static int esperar_entrada(ConexionDb *c) {
+    int sock = cdb_socket(c);
     while (1) {
-        int n = recv(connection_fd, temp_buffer, sizeof(temp_buffer), MSG_PEEK);
-        if (n <= 0) {
-            if (n < 0) {
-                perror("\nError receiving data.");
-            } else {
-                printf("\nServer closed the connection.\n");
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        FD_SET(STDIN_FILENO, &rfds);
+        FD_SET(sock, &rfds);
+        if (select(sock + 1, &rfds, NULL, NULL, NULL) < 0) {
+            if (errno == EINTR) continue;
+            perror("select");
+            return -1;
+        }
+        if (FD_ISSET(sock, &rfds)) {
+            char byte;
+            if (recv(sock, &byte, 1, MSG_PEEK) <= 0) {
+                printf("\nEl servidor cerró la conexión.\n");
+                return -1;
             }
-            close(connection_fd);
-            break;
         }
+        if (FD_ISSET(STDIN_FILENO, &rfds)) return 0;
     }
-    close_client(SIGCHLD);
 }
 
-void close_client(int signo) {
-    if (signo == SIGINT || signo == SIGCHLD) {
-        printf("Cerrando cliente...\n");
-        exit(0);
+// Envía un comando e imprime la respuesta completa; -1 si se cayó la conexión
+static int pedir_y_mostrar(ConexionDb *c, const char *cmd, const char **texto) {
+    const char *resp;
+    size_t len;
+    int r = cdb_pedir(c, cmd, &resp, &len);
+    fwrite(resp, 1, len, stdout);
+    fflush(stdout);
+    if (r != 0) printf("\n⚠️  Conexión perdida: %s\n", cdb_error(c));
+    if (texto) *texto = resp;
+    return r;
+}
+
+// Recorre la tabla con un cursor (OPEN / FETCH / CLOSE): una página por Enter, 'q' corta.
+// El cursor lee una copia, así las páginas no se mezclan con cambios posteriores
+static void paginar(ConexionDb *c, long filas) {
+    const char *resp;
+    char cmd[64];
+    if (pedir_y_mostrar(c, "OPEN", &resp) != 0 || !strstr(resp, "Cursor abierto")) {
+        printf("\n");
+        return;
+    }
+    while (1) {
+        snprintf(cmd, sizeof(cmd), "FETCH %ld", filas);
+        if (pedir_y_mostrar(c, cmd, &resp) != 0) return;
+        if (strstr(resp, "Fin del cursor")) break;
+        printf("-- Enter: siguiente página, q: terminar -- ");
+        fflush(stdout);
+        char linea[16];
+        if (!fgets(linea, sizeof(linea), stdin) || tolower((unsigned char)linea[0]) == 'q') break;
     }
+    pedir_y_mostrar(c, "CLOSE", NULL);
+    printf("\n");
 }
 
 int main(int argc, char *argv[]) {
     if (argc < 3) {
-        fprintf(stderr, "Uso: %s <IP> <PUERTO>\n", argv[0]);
+        fprintf(stderr, "Uso: %s <IP> <PUERTO> [COMPRIMIR 1|0]\n", argv[0]);
         return 1;
     }
     const char *ip = argv[1];
     int puerto = atoi(argv[2]);
-    pthread_t conn_thread;
-
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock < 0) { perror("socket"); return 1; }
-
-    struct sockaddr_in servaddr;
-    memset(&servaddr, 0, sizeof(servaddr));
-    servaddr.sin_family = AF_INET;
-    servaddr.sin_port = htons(puerto);
-    if (inet_pton(AF_INET, ip, &servaddr.sin_addr) <= 0) {
-        perror("inet_pton");
-        close(sock);
-        return 1;
-    }
+    int pedir_compresion = argc >= 4 ? atoi(argv[3]) != 0 : 1;
 
-    if (connect(sock, (struct sockaddr *)&servaddr, sizeof(servaddr)) < 0) {
-        perror("connect");
-        close(sock);
+    // las respuestas grandes llegan comprimidas si el servidor lo soporta
+    char error[256];
+    ConexionDb *c = cdb_conectar(ip, puerto, pedir_compresion ? CDB_COMPRIMIR : 0, error, sizeof(error));
+    if (!c) {
+        fprintf(stderr, "No se pudo conectar: %s\n", error);
         return 1;
     }
-
-    // mensaje inicial si el servidor lo manda
-    fd_set rfds;
-    struct timeval tv;
-    tv.tv_sec = 1; tv.tv_usec = 0;
-    FD_ZERO(&rfds);
-    FD_SET(sock, &rfds);
-    if (select(sock + 1, &rfds, NULL, NULL, &tv) > 0) {
-        char buffer[BUFFER_SIZE];
-        int n = recv(sock, buffer, sizeof(buffer) - 1, 0);
-        if (n > 0) {
-            buffer[n] = '\0';
-            fputs(buffer, stdout);
-        }
-    }
-    if (pthread_create(&conn_thread, NULL, (void *)check_connection, &sock) != 0) {
-        perror("Error creating connection thread");
-    }
+    fputs(cdb_saludo(c), stdout);
 
     mostrar_menu();
 
     char buffer[BUFFER_SIZE];
-    signal(SIGINT, close_client); // ignorar Ctrl+C para evitar cierre abrupto
-    signal(SIGCHLD, close_client);
+    signal(SIGINT, close_client);
+    // sin buffer en stdin: lo pegado de más queda en el descriptor y select lo ve
+    setvbuf(stdin, NULL, _IONBF, 0);
 
     while (1) {
         printf("> ");
         fflush(stdout);
 
+        if (esperar_entrada(c) != 0) break;
         if (!fgets(buffer, sizeof(buffer), stdin)) break;
         quitar_salto(buffer);
         if (strlen(buffer) == 0) continue; // evita líneas vacías
 
-        // preparar comando
-        size_t len = strlen(buffer);
-        buffer[len++] = '\n';
         // si es AYUDA, mostrar menú
-        if (strcasecmp(buffer, "AYUDA\n") == 0) {
+        if (strcasecmp(buffer, "AYUDA") == 0) {
             mostrar_menu();
             continue;
         }
-        // enviar comando
-        if (send(sock, buffer, len, 0) < 0) {
-            perror("send");
-            break;
+        if (strncasecmp(buffer, "PAGINAR", 7) == 0) {
+            long filas = atol(buffer + 7);
+            paginar(c, filas > 0 ? filas : PAGINA_DEF);
+            continue;
         }
-        
-        if (strcasecmp(buffer, "SALIR\n") == 0) {
-            printf("Desconectando...\n");
-            break;
+        // la conexión los fija al abrirse: cambiarlos desincronizaría las respuestas
+        if (strncasecmp(buffer, "FIN", 3) == 0 || strncasecmp(buffer, "COMPRIMIR", 9) == 0) {
+            printf("ℹ️  FIN y COMPRIMIR los maneja el cliente (la compresión se elige al iniciarlo).\n\n");
+            continue;
         }
 
-        // Lectura no bloqueante: recibimos hasta que no haya datos por TIMEOUT_MS
-        char respuesta[BUFFER_SIZE];
-        int total = 0;
-        int terminado = 0;
-        while (!terminado) {
-            FD_ZERO(&rfds);
-            FD_SET(sock, &rfds);
-            tv.tv_sec = 0;
-            tv.tv_usec = TIMEOUT_MS * 1000;
-            int rv = select(sock + 1, &rfds, NULL, NULL, &tv);
-            if (rv < 0) {
-                perror("select");
-                terminado = 1;
-                break;
-            } else if (rv == 0) {
-                // timeout: asumimos fin de respuesta
-                terminado = 1;
-                break;
-            } else {
-                if (FD_ISSET(sock, &rfds)) {
-                    int n = recv(sock, respuesta, sizeof(respuesta) - 1, 0);
-                    if (n <= 0) {
-                        terminado = 1;
-                        break;
-                    }
-                    respuesta[n] = '\0';
-                    fputs(respuesta, stdout);
-                    total += n;
-                }
-            }
+        int r = pedir_y_mostrar(c, buffer, NULL);
+        if (r != 0) break;
+        if (strcasecmp(buffer, "SALIR") == 0) {
+            printf("Desconectando...\n");
+            break;
         }
 
         // aseguramos que el prompt aparezca después de toda la salida
         printf("\n");
         fflush(stdout);
-
-        // limpiamos stdin si quedó algún \n residual (por salidas largas)
-        if (tcflush(STDIN_FILENO, TCIFLUSH) != 0) {
-            limpiar_entrada();
-        }
     }
 
-    close(sock);
+    cdb_cerrar(c);
     return 0;
 }
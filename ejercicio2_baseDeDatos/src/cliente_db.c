@@ -0,0 +1,687 @@
+// cliente_db.c — biblioteca de cliente: conexiones persistentes, pedidos
+// síncronos y asíncronos con pipelining, y un pool de conexiones.
+// Ver cliente_db.h para el modelo de uso.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include "cliente_db.h"
+#include "protocolo.h"
+#include "compresion.h"
+
+#define ENTRADA_TAM   16384
+#define RESPUESTA_MIN 65536
+
+// Pedido asíncrono en vuelo: las respuestas llegan en el orden de envío
+typedef struct Pedido {
+    CallbackDb cb;
+    void *ctx;
+    struct Pedido *sig;
+} Pedido;
+
+struct ConexionDb {
+    int sock;
+    int opciones;
+    int comprimida;
+    int caida;
+    int cerrando;
+    char saludo[512];
+    char error[256];
+
+    // envío: mutex_envio ordena los pedidos en la cola igual que en el socket
+    pthread_mutex_t mutex_envio;
+    pthread_mutex_t mutex;            // cola, pendientes, caida
+    pthread_cond_t cond;              // cambió pendientes
+    Pedido *primero, *ultimo;
+    int pendientes;
+    int tuberia_max;
+    pthread_t lector;
+    int lector_activo;
+
+    // lectura (solo la hace el hilo lector o cdb_pedir sin hilo lector)
+    char entrada[ENTRADA_TAM];
+    size_t ini, fin;
+    int saltar_salto;                 // falta el '\n' de FIN_RESPUESTA
+    char cabecera[COMPRIMIDO_CABECERA];
+    size_t n_cabecera;                // > 0: dentro de un bloque comprimido
+    size_t largo, n_datos, original;
+    char *bloque;                     // datos comprimidos del bloque actual
+    char *resp;                       // respuesta en armado (sin la marca de fin)
+    size_t resp_len, resp_cap;
+    char *sincrona;                   // respuesta de cdb_pedir vía el hilo lector
+
+    int pool_indice;                  // posición en el PoolDb, -1 si es suelta
+};
+
+struct FuturoDb {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int listo, error;
+    char *texto;
+    size_t len;
+};
+
+struct PoolDb {
+    char host[256];
+    int puerto;
+    int opciones;
+    int n;
+    ConexionDb **con;
+    int *ocupada;                     // tomada en exclusiva con cdb_pool_tomar
+    int *enviando;                    // cdb_pool_enviar en curso sobre la conexión
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+};
+
+static void poner_error(ConexionDb *c, const char *fmt, const char *detalle) {
+    snprintf(c->error, sizeof(c->error), fmt, detalle);
+}
+
+// ===== Red =====
+static int abrir_socket(const char *host, int puerto) {
+    struct addrinfo pista, *res;
+    char servicio[16];
+    memset(&pista, 0, sizeof(pista));
+    pista.ai_family = AF_INET;
+    pista.ai_socktype = SOCK_STREAM;
+    snprintf(servicio, sizeof(servicio), "%d", puerto);
+    if (getaddrinfo(host, servicio, &pista, &res) != 0) return -1;
+    int s = socket(res->ai_family, res->ai_socktype, 0);
+    if (s >= 0 && connect(s, res->ai_addr, res->ai_addrlen) != 0) {
+        close(s);
+        s = -1;
+    }
+    // los comandos pequeños salen enseguida aunque haya otros sin confirmar
+    int uno = 1;
+    if (s >= 0) setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &uno, sizeof(uno));
+    freeaddrinfo(res);
+    return s;
+}
+
+static int enviar_todo(int s, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(s, buf, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+// Envía cmd agregando el '\n' si falta
+static int enviar_comando(ConexionDb *c, const char *cmd) {
+    size_t len = strlen(cmd);
+    if (enviar_todo(c->sock, cmd, len) != 0) return -1;
+    if (len == 0 || cmd[len - 1] != '\n') return enviar_todo(c->sock, "\n", 1);
+    return 0;
+}
+
+// ===== Decodificación de respuestas =====
+static uint32_t leer32(const char *p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) v = (v << 8) | (unsigned char)p[i];
+    return v;
+}
+
+static int reservar(ConexionDb *c, size_t extra) {
+    if (c->resp_len + extra + 1 <= c->resp_cap) return 0;
+    size_t nueva = c->resp_cap ? c->resp_cap : RESPUESTA_MIN;
+    while (c->resp_len + extra + 1 > nueva) nueva *= 2;
+    char *r = realloc(c->resp, nueva);
+    if (!r) return -1;
+    c->resp = r;
+    c->resp_cap = nueva;
+    return 0;
+}
+
+static int agregar(ConexionDb *c, const char *s, size_t n) {
+    if (reservar(c, n) != 0) return -1;
+    memcpy(c->resp + c->resp_len, s, n);
+    c->resp_len += n;
+    return 0;
+}
+
+// Consume lo que haya en c->entrada. 1: respuesta completa en c->resp,
+// 0: hacen falta más datos, -1: bloque dañado o sin memoria
+static int decodificar(ConexionDb *c) {
+    while (c->ini < c->fin) {
+        char *p = c->entrada + c->ini;
+        size_t n = c->fin - c->ini;
+        if (c->saltar_salto) {
+            c->saltar_salto = 0;
+            if (*p == '\n') c->ini++;
+            continue;
+        }
+        if (c->n_cabecera == 0) {
+            char *fin = memchr(p, FIN_RESPUESTA[0], n);
+            size_t hasta = fin ? (size_t)(fin - p) : n;
+            char *marca = c->comprimida ? memchr(p, COMPRIMIDO_MARCA, hasta) : NULL;
+            size_t texto = marca ? (size_t)(marca - p) : hasta;
+            if (agregar(c, p, texto) != 0) return -1;
+            c->ini += texto;
+            if (!marca) {
+                if (!fin) continue;
+                c->ini++;
+                c->saltar_salto = 1; // el '\n' de la marca puede llegar en el próximo recv
+                c->resp[c->resp_len] = '\0';
+                return 1;
+            }
+            // sigue la cabecera del bloque, que empieza con la marca
+            p = c->entrada + c->ini;
+            n = c->fin - c->ini;
+        }
+        if (c->n_cabecera < COMPRIMIDO_CABECERA) {
+            size_t k = COMPRIMIDO_CABECERA - c->n_cabecera;
+            if (k > n) k = n;
+            memcpy(c->cabecera + c->n_cabecera, p, k);
+            c->n_cabecera += k;
+            c->ini += k;
+            if (c->n_cabecera < COMPRIMIDO_CABECERA) continue;
+            c->original = leer32(c->cabecera + 1);
+            c->largo = leer32(c->cabecera + 5);
+            c->n_datos = 0;
+            if (c->original > COMPRIMIDO_BLOQUE || c->largo > COMPRESION_COTA(COMPRIMIDO_BLOQUE)) return -1;
+            if (!c->bloque && !(c->bloque = malloc(COMPRESION_COTA(COMPRIMIDO_BLOQUE)))) return -1;
+            continue;
+        }
+        size_t k = c->largo - c->n_datos;
+        if (k > n) k = n;
+        memcpy(c->bloque + c->n_datos, p, k);
+        c->n_datos += k;
+        c->ini += k;
+        if (c->n_datos < c->largo) continue;
+        // el bloque se descomprime directo al final de la respuesta
+        if (reservar(c, c->original) != 0) return -1;
+        long largo = descomprimir_bloque(c->bloque, c->largo, c->resp + c->resp_len, c->original);
+        if (largo != (long)c->original) return -1;
+        c->resp_len += (size_t)largo;
+        c->n_cabecera = 0;
+    }
+    c->ini = c->fin = 0;
+    return 0;
+}
+
+// Lee una respuesta completa en c->resp. -1 si la conexión se cortó
+static int leer_respuesta(ConexionDb *c) {
+    c->resp_len = 0;
+    if (reservar(c, 0) != 0) {
+        poner_error(c, "%s", "sin memoria para la respuesta");
+        return -1;
+    }
+    c->resp[0] = '\0';
+    while (1) {
+        int r = decodificar(c);
+        if (r == 1) return 0;
+        if (r < 0) {
+            poner_error(c, "%s", "respuesta dañada (bloque comprimido inválido)");
+            return -1;
+        }
+        ssize_t n = recv(c->sock, c->entrada, sizeof(c->entrada), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            if (n < 0) poner_error(c, "recv: %s", strerror(errno));
+            else poner_error(c, "%s", "el servidor cerró la conexión");
+            c->resp[c->resp_len] = '\0';
+            return -1;
+        }
+        c->fin = (size_t)n;
+    }
+}
+
+// ===== Conexión =====
+static ConexionDb *nueva_conexion(void) {
+    ConexionDb *c = calloc(1, sizeof(ConexionDb));
+    if (!c) return NULL;
+    c->sock = -1;
+    c->tuberia_max = CDB_TUBERIA_DEF;
+    c->pool_indice = -1;
+    pthread_mutex_init(&c->mutex_envio, NULL);
+    pthread_mutex_init(&c->mutex, NULL);
+    pthread_cond_init(&c->cond, NULL);
+    return c;
+}
+
+static void liberar_conexion(ConexionDb *c) {
+    if (c->sock >= 0) close(c->sock);
+    pthread_mutex_destroy(&c->mutex_envio);
+    pthread_mutex_destroy(&c->mutex);
+    pthread_cond_destroy(&c->cond);
+    free(c->bloque);
+    free(c->resp);
+    free(c->sincrona);
+    free(c);
+}
+
+// Pedido síncrono sin hilo lector (durante el arranque de la conexión)
+static int pedir_directo(ConexionDb *c, const char *cmd) {
+    if (enviar_comando(c, cmd) != 0) {
+        poner_error(c, "send: %s", strerror(errno));
+        return -1;
+    }
+    return leer_respuesta(c);
+}
+
+ConexionDb *cdb_conectar(const char *host, int puerto, int opciones, char *error, size_t tam_error) {
+    ConexionDb *c = nueva_conexion();
+    if (!c) {
+        if (error) snprintf(error, tam_error, "sin memoria");
+        return NULL;
+    }
+    c->opciones = opciones;
+    c->sock = abrir_socket(host, puerto);
+    if (c->sock < 0) {
+        if (error) snprintf(error, tam_error, "no se pudo conectar a %s:%d", host, puerto);
+        liberar_conexion(c);
+        return NULL;
+    }
+
+    // el saludo (y el aviso de espera, si lo hubo) llega antes de la
+    // confirmación de FIN ON: esta primera respuesta trae todo junto
+    if (pedir_directo(c, "FIN ON") != 0 || !strstr(c->resp, "Fin de respuesta activado")) {
+        // rechazado por estar lleno: el motivo es lo que mandó antes de cerrar
+        if (error) {
+            if (c->resp && c->resp_len > 0) {
+                // la última línea (antes puede venir el aviso de espera)
+                while (c->resp_len > 0 && c->resp[c->resp_len - 1] == '\n') c->resp[--c->resp_len] = '\0';
+                char *ultima = strrchr(c->resp, '\n');
+                snprintf(error, tam_error, "%s", ultima ? ultima + 1 : c->resp);
+            } else {
+                snprintf(error, tam_error, "%s", c->error);
+            }
+        }
+        liberar_conexion(c);
+        return NULL;
+    }
+    char *confirmacion = strstr(c->resp, "✅ Fin de respuesta activado");
+    snprintf(c->saludo, sizeof(c->saludo), "%.*s", (int)(confirmacion - c->resp), c->resp);
+
+    if (opciones & CDB_COMPRIMIR) {
+        if (pedir_directo(c, "COMPRIMIR ON") != 0) goto fallo;
+        c->comprimida = strstr(c->resp, "Compresión activada") != NULL;
+    }
+    if (opciones & CDB_BEGIN) {
+        if (pedir_directo(c, "BEGIN") != 0) goto fallo;
+    }
+    return c;
+
+fallo:
+    if (error) snprintf(error, tam_error, "%s", c->error);
+    liberar_conexion(c);
+    return NULL;
+}
+
+// Saca de la cola todos los pedidos y les avisa el error
+static void fallar_pendientes(ConexionDb *c) {
+    pthread_mutex_lock(&c->mutex);
+    Pedido *p = c->primero;
+    c->primero = c->ultimo = NULL;
+    c->caida = 1;
+    pthread_mutex_unlock(&c->mutex);
+    while (p) {
+        Pedido *sig = p->sig;
+        p->cb(p->ctx, "", 0, 1);
+        free(p);
+        pthread_mutex_lock(&c->mutex);
+        c->pendientes--;
+        pthread_cond_broadcast(&c->cond);
+        pthread_mutex_unlock(&c->mutex);
+        p = sig;
+    }
+}
+
+// Hilo lector: entrega las respuestas a los pedidos en orden
+static void *hilo_lector(void *arg) {
+    ConexionDb *c = arg;
+    while (1) {
+        pthread_mutex_lock(&c->mutex);
+        while (c->pendientes == 0 && !c->cerrando) pthread_cond_wait(&c->cond, &c->mutex);
+        int salir = c->pendientes == 0;
+        pthread_mutex_unlock(&c->mutex);
+        if (salir) break;
+
+        if (leer_respuesta(c) != 0) {
+            fallar_pendientes(c);
+            break;
+        }
+        pthread_mutex_lock(&c->mutex);
+        Pedido *p = c->primero;
+        c->primero = p->sig;
+        if (!c->primero) c->ultimo = NULL;
+        pthread_mutex_unlock(&c->mutex);
+
+        p->cb(p->ctx, c->resp, c->resp_len, 0);
+        free(p);
+
+        pthread_mutex_lock(&c->mutex);
+        c->pendientes--;
+        pthread_cond_broadcast(&c->cond);
+        pthread_mutex_unlock(&c->mutex);
+    }
+    return NULL;
+}
+
+void cdb_cerrar(ConexionDb *c) {
+    if (!c) return;
+    pthread_mutex_lock(&c->mutex);
+    c->cerrando = 1;
+    pthread_cond_broadcast(&c->cond);
+    pthread_mutex_unlock(&c->mutex);
+    shutdown(c->sock, SHUT_RDWR); // despierta al hilo lector si está en recv
+    if (c->lector_activo) pthread_join(c->lector, NULL);
+    liberar_conexion(c);
+}
+
+const char *cdb_saludo(const ConexionDb *c) { return c->saludo; }
+const char *cdb_error(const ConexionDb *c) { return c->error; }
+int cdb_socket(const ConexionDb *c) { return c->sock; }
+int cdb_comprimida(const ConexionDb *c) { return c->comprimida; }
+
+int cdb_caida(const ConexionDb *c) {
+    ConexionDb *m = (ConexionDb *)c;
+    pthread_mutex_lock(&m->mutex);
+    int caida = m->caida;
+    pthread_mutex_unlock(&m->mutex);
+    return caida;
+}
+
+static int pendientes(ConexionDb *c) {
+    pthread_mutex_lock(&c->mutex);
+    int n = c->pendientes;
+    pthread_mutex_unlock(&c->mutex);
+    return n;
+}
+
+void cdb_tuberia(ConexionDb *c, int max) {
+    pthread_mutex_lock(&c->mutex);
+    c->tuberia_max = max > 0 ? max : 1;
+    pthread_cond_broadcast(&c->cond);
+    pthread_mutex_unlock(&c->mutex);
+}
+
+// ===== Asíncrona =====
+int cdb_enviar(ConexionDb *c, const char *cmd, CallbackDb cb, void *ctx) {
+    Pedido *p = malloc(sizeof(Pedido));
+    if (!p) return -1;
+    p->cb = cb;
+    p->ctx = ctx;
+    p->sig = NULL;
+
+    pthread_mutex_lock(&c->mutex_envio);
+    if (!c->lector_activo) {
+        if (pthread_create(&c->lector, NULL, hilo_lector, c) != 0) {
+            pthread_mutex_unlock(&c->mutex_envio);
+            poner_error(c, "%s", "no se pudo crear el hilo lector");
+            free(p);
+            return -1;
+        }
+        c->lector_activo = 1;
+    }
+    pthread_mutex_lock(&c->mutex);
+    // backpressure: no más de tuberia_max comandos sin respuesta
+    while (!c->caida && c->pendientes >= c->tuberia_max) pthread_cond_wait(&c->cond, &c->mutex);
+    if (c->caida) {
+        pthread_mutex_unlock(&c->mutex);
+        pthread_mutex_unlock(&c->mutex_envio);
+        free(p);
+        return -1;
+    }
+    // a la cola antes de enviar: la respuesta puede llegar antes de que send vuelva
+    if (c->ultimo) c->ultimo->sig = p;
+    else c->primero = p;
+    c->ultimo = p;
+    c->pendientes++;
+    pthread_cond_broadcast(&c->cond);
+    pthread_mutex_unlock(&c->mutex);
+
+    if (enviar_comando(c, cmd) != 0) {
+        // nadie lo vio salir: se quita de la cola y la conexión queda caída
+        poner_error(c, "send: %s", strerror(errno));
+        shutdown(c->sock, SHUT_RDWR);
+        pthread_mutex_lock(&c->mutex);
+        Pedido **q = &c->primero;
+        while (*q && *q != p) q = &(*q)->sig;
+        if (*q) {
+            *q = NULL;
+            c->ultimo = NULL;
+            for (Pedido *r = c->primero; r; r = r->sig) c->ultimo = r;
+            c->pendientes--;
+            free(p);
+        }
+        c->caida = 1;
+        pthread_cond_broadcast(&c->cond);
+        pthread_mutex_unlock(&c->mutex);
+        pthread_mutex_unlock(&c->mutex_envio);
+        return -1;
+    }
+    pthread_mutex_unlock(&c->mutex_envio);
+    return 0;
+}
+
+static void completar_futuro(void *ctx, const char *texto, size_t len, int error) {
+    FuturoDb *f = ctx;
+    pthread_mutex_lock(&f->mutex);
+    f->texto = malloc(len + 1);
+    if (f->texto) {
+        memcpy(f->texto, texto, len);
+        f->texto[len] = '\0';
+        f->len = len;
+    }
+    f->error = error || !f->texto;
+    f->listo = 1;
+    pthread_cond_signal(&f->cond);
+    pthread_mutex_unlock(&f->mutex);
+}
+
+FuturoDb *cdb_enviar_futuro(ConexionDb *c, const char *cmd) {
+    FuturoDb *f = calloc(1, sizeof(FuturoDb));
+    if (!f) return NULL;
+    pthread_mutex_init(&f->mutex, NULL);
+    pthread_cond_init(&f->cond, NULL);
+    if (cdb_enviar(c, cmd, completar_futuro, f) != 0) {
+        cdb_futuro_liberar(f);
+        return NULL;
+    }
+    return f;
+}
+
+int cdb_futuro_esperar(FuturoDb *f, const char **texto, size_t *len) {
+    pthread_mutex_lock(&f->mutex);
+    while (!f->listo) pthread_cond_wait(&f->cond, &f->mutex);
+    pthread_mutex_unlock(&f->mutex);
+    if (texto) *texto = f->texto ? f->texto : "";
+    if (len) *len = f->len;
+    return f->error ? -1 : 0;
+}
+
+void cdb_futuro_liberar(FuturoDb *f) {
+    if (!f) return;
+    pthread_mutex_destroy(&f->mutex);
+    pthread_cond_destroy(&f->cond);
+    free(f->texto);
+    free(f);
+}
+
+void cdb_esperar(ConexionDb *c) {
+    pthread_mutex_lock(&c->mutex);
+    while (c->pendientes > 0) pthread_cond_wait(&c->cond, &c->mutex);
+    pthread_mutex_unlock(&c->mutex);
+}
+
+// ===== Síncrona =====
+int cdb_pedir(ConexionDb *c, const char *cmd, const char **texto, size_t *len) {
+    pthread_mutex_lock(&c->mutex_envio);
+    if (!c->lector_activo) {
+        // sin pedidos asíncronos en la conexión: se lee acá mismo, sin hilos
+        int r = -1;
+        if (!cdb_caida(c)) {
+            r = pedir_directo(c, cmd);
+            if (r != 0) {
+                pthread_mutex_lock(&c->mutex);
+                c->caida = 1;
+                pthread_mutex_unlock(&c->mutex);
+            }
+        }
+        if (texto) *texto = c->resp ? c->resp : "";
+        if (len) *len = c->resp_len;
+        pthread_mutex_unlock(&c->mutex_envio);
+        return r;
+    }
+    pthread_mutex_unlock(&c->mutex_envio);
+
+    // con hilo lector: el pedido va a la cola detrás de los asíncronos
+    FuturoDb *f = cdb_enviar_futuro(c, cmd);
+    if (!f) {
+        if (texto) *texto = "";
+        if (len) *len = 0;
+        return -1;
+    }
+    const char *t;
+    size_t n;
+    int r = cdb_futuro_esperar(f, &t, &n);
+    free(c->sincrona);
+    c->sincrona = f->texto;
+    f->texto = NULL;
+    cdb_futuro_liberar(f);
+    if (texto) *texto = c->sincrona ? c->sincrona : "";
+    if (len) *len = c->sincrona ? n : 0;
+    return r;
+}
+
+// ===== Pool =====
+PoolDb *cdb_pool_crear(const char *host, int puerto, int conexiones, int opciones,
+                       char *error, size_t tam_error) {
+    if (conexiones <= 0) {
+        if (error) snprintf(error, tam_error, "cantidad de conexiones inválida");
+        return NULL;
+    }
+    PoolDb *p = calloc(1, sizeof(PoolDb));
+    if (!p) return NULL;
+    snprintf(p->host, sizeof(p->host), "%s", host);
+    p->puerto = puerto;
+    p->opciones = opciones;
+    p->con = calloc((size_t)conexiones, sizeof(ConexionDb *));
+    p->ocupada = calloc((size_t)conexiones, sizeof(int));
+    p->enviando = calloc((size_t)conexiones, sizeof(int));
+    pthread_mutex_init(&p->mutex, NULL);
+    pthread_cond_init(&p->cond, NULL);
+    if (!p->con || !p->ocupada || !p->enviando) {
+        if (error) snprintf(error, tam_error, "sin memoria");
+        cdb_pool_cerrar(p);
+        return NULL;
+    }
+    for (int i = 0; i < conexiones; i++) {
+        p->con[i] = cdb_conectar(host, puerto, opciones, error, tam_error);
+        if (!p->con[i]) {
+            cdb_pool_cerrar(p);
+            return NULL;
+        }
+        p->con[i]->pool_indice = i;
+        p->n++;
+    }
+    return p;
+}
+
+// Reemplaza una conexión caída; la posición i está marcada como ocupada
+static ConexionDb *reabrir(PoolDb *p, int i) {
+    ConexionDb *c = cdb_conectar(p->host, p->puerto, p->opciones, NULL, 0);
+    if (!c) return NULL;
+    c->pool_indice = i;
+    cdb_cerrar(p->con[i]);
+    p->con[i] = c;
+    return c;
+}
+
+// Posición libre con menos pedidos en vuelo (las caídas al final); -1 si no hay
+static int elegir(PoolDb *p) {
+    int mejor = -1, carga_mejor = 0;
+    for (int i = 0; i < p->n; i++) {
+        if (p->ocupada[i]) continue;
+        int carga = cdb_caida(p->con[i]) ? 1 << 30 : pendientes(p->con[i]);
+        if (mejor < 0 || carga < carga_mejor) {
+            mejor = i;
+            carga_mejor = carga;
+        }
+    }
+    return mejor;
+}
+
+ConexionDb *cdb_pool_tomar(PoolDb *p) {
+    pthread_mutex_lock(&p->mutex);
+    int i;
+    while ((i = elegir(p)) < 0) pthread_cond_wait(&p->cond, &p->mutex);
+    p->ocupada[i] = 1;
+    // los envíos sueltos que ya la eligieron terminan antes de cederla
+    while (p->enviando[i] > 0) pthread_cond_wait(&p->cond, &p->mutex);
+    pthread_mutex_unlock(&p->mutex);
+
+    ConexionDb *c = p->con[i];
+    cdb_esperar(c);
+    if (cdb_caida(c) && !(c = reabrir(p, i))) {
+        cdb_pool_devolver(p, p->con[i]);
+        return NULL;
+    }
+    return c;
+}
+
+void cdb_pool_devolver(PoolDb *p, ConexionDb *c) {
+    if (!c || c->pool_indice < 0) return;
+    pthread_mutex_lock(&p->mutex);
+    p->ocupada[c->pool_indice] = 0;
+    pthread_cond_broadcast(&p->cond);
+    pthread_mutex_unlock(&p->mutex);
+}
+
+int cdb_pool_enviar(PoolDb *p, const char *cmd, CallbackDb cb, void *ctx) {
+    pthread_mutex_lock(&p->mutex);
+    int i;
+    while ((i = elegir(p)) < 0) pthread_cond_wait(&p->cond, &p->mutex);
+    ConexionDb *c = p->con[i];
+    if (cdb_caida(c)) {
+        // todas las libres están caídas: se reabre esta fuera del mutex
+        p->ocupada[i] = 1;
+        pthread_mutex_unlock(&p->mutex);
+        c = reabrir(p, i);
+        pthread_mutex_lock(&p->mutex);
+        p->ocupada[i] = 0;
+        pthread_cond_broadcast(&p->cond);
+        if (!c) {
+            pthread_mutex_unlock(&p->mutex);
+            return -1;
+        }
+    }
+    p->enviando[i]++;
+    pthread_mutex_unlock(&p->mutex);
+
+    int r = cdb_enviar(c, cmd, cb, ctx);
+
+    pthread_mutex_lock(&p->mutex);
+    p->enviando[i]--;
+    pthread_cond_broadcast(&p->cond);
+    pthread_mutex_unlock(&p->mutex);
+    return r;
+}
+
+void cdb_pool_cerrar(PoolDb *p) {
+    if (!p) return;
+    for (int i = 0; i < p->n; i++) {
+        if (!p->con[i]) continue;
+        cdb_esperar(p->con[i]);
+        cdb_cerrar(p->con[i]);
+    }
+    pthread_mutex_destroy(&p->mutex);
+    pthread_cond_destroy(&p->cond);
+    free(p->con);
+    free(p->ocupada);
+    free(p->enviando);
+    free(p);
+}
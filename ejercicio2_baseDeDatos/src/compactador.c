@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include "compactador.h"
+#include "db.h"
+#include "db_log.h"
+#include "particiones.h"
+#include "traza.h"
+#include "utils.h"
+
+#define REGISTROS_POR_TRAMO 4096
+
+int COMPACTAR_BASURA_PCT = COMPACTAR_BASURA_PCT_DEF;
+
+static pthread_mutex_t mutex_hilo = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_hilo = PTHREAD_COND_INITIALIZER;
+static pthread_t hilo_compactador;
+static int hilo_activo = 0;
+static int detener = 0;
+
+static double ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Compacta un segmento si hay alguno con basura suficiente. 1 si compactó
+static int compactar_uno(void) {
+    CompactacionLog c;
+    particiones_bloquear(particiones_todas());
+    int hay = dblog_elegir(COMPACTAR_BASURA_PCT, &c);
+    particiones_desbloquear(particiones_todas());
+    if (!hay) return 0;
+
+    double inicio = ahora_ms();
+    traza_nuevo_pedido();
+    int r;
+    do {
+        particiones_bloquear(particiones_todas());
+        uint64_t t_tramo = traza_inicio();
+        r = dblog_compactar(&c, REGISTROS_POR_TRAMO);
+        traza_fin("compactar_tramo", t_tramo);
+        if (r == 0) {
+            uint64_t t_retirar = traza_inicio();
+            if (dblog_retirar(&c) != 0) r = -1;
+            traza_fin("compactar_retirar", t_retirar);
+        }
+        particiones_desbloquear(particiones_todas());
+    } while (r == 1 && !detener);
+
+    if (r == 0) {
+        log_msg("Compactación del segmento %u: %zu bytes vigentes copiados (%.1f ms)",
+                c.numero, c.copiados, ahora_ms() - inicio);
+    } else if (r < 0) {
+        log_msg("Compactación del segmento %u cancelada", c.numero);
+    }
+    return r == 0;
+}
+
+static void *hilo_compactar(void *arg) {
+    (void)arg;
+    // las señales las atiende el hilo principal
+    sigset_t set;
+    sigfillset(&set);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    pthread_mutex_lock(&mutex_hilo);
+    while (!detener) {
+        struct timespec limite;
+        clock_gettime(CLOCK_REALTIME, &limite);
+        limite.tv_sec += 1;
+        pthread_cond_timedwait(&cond_hilo, &mutex_hilo, &limite);
+        if (detener || COMPACTAR_BASURA_PCT <= 0) continue;
+
+        pthread_mutex_unlock(&mutex_hilo);
+        while (!detener && compactar_uno())
+            ;
+        pthread_mutex_lock(&mutex_hilo);
+    }
+    pthread_mutex_unlock(&mutex_hilo);
+    return NULL;
+}
+
+int compactador_iniciar() {
+    if (MOTOR_DB != MOTOR_LOG) return 0;
+    detener = 0;
+    if (pthread_create(&hilo_compactador, NULL, hilo_compactar, NULL) != 0) {
+        log_msg("Compactador: no se pudo crear el hilo");
+        return -1;
+    }
+    hilo_activo = 1;
+    return 0;
+}
+
+void compactador_detener() {
+    if (!hilo_activo) return;
+    pthread_mutex_lock(&mutex_hilo);
+    detener = 1;
+    pthread_cond_signal(&cond_hilo);
+    pthread_mutex_unlock(&mutex_hilo);
+    pthread_join(hilo_compactador, NULL);
+    hilo_activo = 0;
+}
@@ -0,0 +1,129 @@
+#include <string.h>
+#include <stdint.h>
+#include "compresion.h"
+
+#define HASH_BITS       12
+#define COINCIDENCIA_MIN 4
+#define DISTANCIA_MAX   65535
+// Como en LZ4: los últimos 5 bytes van siempre como literales y una
+// coincidencia no empieza en los últimos 12
+#define FIN_LITERALES   5
+#define FIN_COINCIDENCIA 12
+
+static uint32_t leer32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t hash4(uint32_t v) {
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Largo >= 15: el resto va en bytes de 255 más uno final
+static uint8_t *escribir_largo(uint8_t *op, size_t largo) {
+    while (largo >= 255) {
+        *op++ = 255;
+        largo -= 255;
+    }
+    *op++ = (uint8_t)largo;
+    return op;
+}
+
+static uint8_t *escribir_literales(uint8_t *op, uint8_t *token, const uint8_t *lit, size_t n) {
+    *token = (uint8_t)((n >= 15 ? 15 : n) << 4);
+    if (n >= 15) op = escribir_largo(op, n - 15);
+    memcpy(op, lit, n);
+    return op + n;
+}
+
+size_t comprimir_bloque(const char *src, size_t n, char *dst, size_t cap) {
+    const uint8_t *ini = (const uint8_t *)src, *fin = ini + n;
+    const uint8_t *ip = ini, *ancla = ini; // ancla: primer literal pendiente
+    uint8_t *op = (uint8_t *)dst, *op_fin = op + cap;
+    uint32_t tabla[1 << HASH_BITS];
+    memset(tabla, 0, sizeof(tabla));
+
+    if (n > FIN_COINCIDENCIA) {
+        const uint8_t *limite = fin - FIN_COINCIDENCIA;
+        while (ip < limite) {
+            uint32_t v = leer32(ip);
+            uint32_t h = hash4(v);
+            const uint8_t *ref = ini + tabla[h];
+            tabla[h] = (uint32_t)(ip - ini);
+            if (ref >= ip || ip - ref > DISTANCIA_MAX || leer32(ref) != v) {
+                ip++;
+                continue;
+            }
+            // extender hacia atrás sobre los literales pendientes y hacia adelante
+            while (ip > ancla && ref > ini && ip[-1] == ref[-1]) {
+                ip--;
+                ref--;
+            }
+            const uint8_t *m = ip + COINCIDENCIA_MIN, *r = ref + COINCIDENCIA_MIN;
+            while (m < fin - FIN_LITERALES && *m == *r) {
+                m++;
+                r++;
+            }
+            size_t lit = (size_t)(ip - ancla);
+            size_t largo = (size_t)(m - ip) - COINCIDENCIA_MIN;
+            if ((size_t)(op_fin - op) < 1 + lit / 255 + 1 + lit + 2 + largo / 255 + 1) return 0;
+
+            uint8_t *token = op++;
+            op = escribir_literales(op, token, ancla, lit);
+            uint16_t distancia = (uint16_t)(ip - ref);
+            *op++ = (uint8_t)(distancia & 0xFF);
+            *op++ = (uint8_t)(distancia >> 8);
+            *token |= (uint8_t)(largo >= 15 ? 15 : largo);
+            if (largo >= 15) op = escribir_largo(op, largo - 15);
+            ip = ancla = m;
+        }
+    }
+
+    // la última secuencia es solo de literales
+    size_t lit = (size_t)(fin - ancla);
+    if ((size_t)(op_fin - op) < 1 + lit / 255 + 1 + lit) return 0;
+    uint8_t *token = op++;
+    op = escribir_literales(op, token, ancla, lit);
+    return (size_t)(op - (uint8_t *)dst);
+}
+
+// Lee la extensión de un largo de 15; -1 si el bloque se corta
+static int leer_largo(const uint8_t **ip, const uint8_t *fin, size_t *largo) {
+    uint8_t b;
+    do {
+        if (*ip >= fin) return -1;
+        b = *(*ip)++;
+        *largo += b;
+    } while (b == 255);
+    return 0;
+}
+
+long descomprimir_bloque(const char *src, size_t n, char *dst, size_t cap) {
+    const uint8_t *ip = (const uint8_t *)src, *ip_fin = ip + n;
+    uint8_t *op = (uint8_t *)dst, *op_fin = op + cap;
+    while (ip < ip_fin) {
+        uint8_t token = *ip++;
+        size_t lit = token >> 4;
+        if (lit == 15 && leer_largo(&ip, ip_fin, &lit) != 0) return -1;
+        if (lit > (size_t)(ip_fin - ip) || lit > (size_t)(op_fin - op)) return -1;
+        memcpy(op, ip, lit);
+        op += lit;
+        ip += lit;
+        if (ip == ip_fin) break; // última secuencia: sin coincidencia
+
+        if (ip_fin - ip < 2) return -1;
+        size_t distancia = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if (distancia == 0 || distancia > (size_t)(op - (uint8_t *)dst)) return -1;
+        size_t largo = token & 15;
+        if (largo == 15 && leer_largo(&ip, ip_fin, &largo) != 0) return -1;
+        largo += COINCIDENCIA_MIN;
+        if (largo > (size_t)(op_fin - op)) return -1;
+        // byte a byte: la coincidencia puede superponerse con lo que copia
+        const uint8_t *ref = op - distancia;
+        for (size_t i = 0; i < largo; i++) op[i] = ref[i];
+        op += largo;
+    }
+    return (long)(op - (uint8_t *)dst);
+}
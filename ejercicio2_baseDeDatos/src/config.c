@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stdarg.h>
+#include "config.h"
+#include "db.h"
+#include "wal.h"
+#include "checkpoint.h"
+#include "recuperacion.h"
+#include "bloqueos.h"
+#include "metricas.h"
+#include "muestreo.h"
+#include "db_log.h"
+#include "compactador.h"
+#include "particiones.h"
+#include "traza.h"
+#include "pool.h"
+#include "admision.h"
+#include "cache.h"
+#include "importar.h"
+#include "utils.h"
+
+extern char IP_SERVIDOR[64];
+extern int PUERTO;
+extern int MAX_CLIENTES;
+extern int BACKLOG;
+extern char CSV_PATH[512];
+extern char LOG_PATH[512];
+extern char BIN_PATH[512];
+
+char CONFIG_RUTA[512] = CONFIG_RUTA_DEF;
+
+typedef enum { CLAVE_INT, CLAVE_KB, CLAVE_TEXTO, CLAVE_MOTOR } TipoClave;
+
+typedef struct {
+    const char *nombre;
+    TipoClave tipo;
+    void *destino;
+    size_t tam;        /* solo CLAVE_TEXTO */
+    long min;          /* valor mínimo aceptado (enteros) */
+    int recargable;
+} Clave;
+
+static const Clave claves[] = {
+    { "IP_ADDRESS",            CLAVE_TEXTO, IP_SERVIDOR,            sizeof(IP_SERVIDOR), 0, 0 },
+    { "PORT",                  CLAVE_INT,   &PUERTO,                0, 1, 0 },
+    { "MAX_CLIENTES",          CLAVE_INT,   &MAX_CLIENTES,          0, 1, 1 },
+    { "BACKLOG",               CLAVE_INT,   &BACKLOG,               0, 1, 0 },
+    { "CSV_PATH",              CLAVE_TEXTO, CSV_PATH,               sizeof(CSV_PATH), 0, 0 },
+    { "LOG_PATH",              CLAVE_TEXTO, LOG_PATH,               sizeof(LOG_PATH), 0, 0 },
+    { "STORAGE_ENGINE",        CLAVE_MOTOR, &MOTOR_DB,              0, 0, 0 },
+    { "BIN_PATH",              CLAVE_TEXTO, BIN_PATH,               sizeof(BIN_PATH), 0, 0 },
+    { "TABLE_SHARDS",          CLAVE_INT,   &PARTICIONES_TABLA,     0, 1, 0 },
+    { "SEGMENT_KB",            CLAVE_INT,   &SEGMENTO_KB,           0, 64, 0 },
+    { "COMPACT_GARBAGE_PCT",   CLAVE_INT,   &COMPACTAR_BASURA_PCT,  0, 0, 1 },
+    { "WORKERS",               CLAVE_INT,   &POOL_HILOS,            0, 0, 1 },
+    { "ADMISSION_QUEUE",       CLAVE_INT,   &ADMISION_COLA,         0, 0, 0 },
+    { "ADMISSION_TIMEOUT_MS",  CLAVE_INT,   &ADMISION_TIMEOUT_MS,   0, 0, 1 },
+    { "GROUP_COMMIT_US",       CLAVE_INT,   &GROUP_COMMIT_US,       0, 0, 1 },
+    { "CHECKPOINT_INTERVAL_S", CLAVE_INT,   &CHECKPOINT_INTERVAL_S, 0, 0, 1 },
+    { "CHECKPOINT_WAL_MAX_KB", CLAVE_KB,    &CHECKPOINT_WAL_MAX,    0, 0, 1 },
+    { "CHECKPOINT_KB_S",       CLAVE_INT,   &CHECKPOINT_KB_S,       0, 0, 1 },
+    { "RECOVERY_THREADS",      CLAVE_INT,   &RECUPERACION_HILOS,    0, 0, 0 },
+    { "IMPORT_THREADS",        CLAVE_INT,   &IMPORTAR_HILOS,        0, 0, 1 },
+    { "LOCK_TIMEOUT_MS",       CLAVE_INT,   &LOCK_TIMEOUT_MS,       0, 0, 1 },
+    { "METRICS_INTERVAL_S",    CLAVE_INT,   &METRICAS_INTERVALO_S,  0, 0, 1 },
+    { "SAMPLE_INTERVAL_S",     CLAVE_INT,   &MUESTREO_INTERVALO_S,  0, 0, 1 },
+    { "QUERY_CACHE_KB",        CLAVE_KB,    &CACHE_MAX,             0, 0, 1 },
+    { "LOG_BUFFER_SLOTS",      CLAVE_INT,   &LOG_ANILLO_SLOTS,      0, 16, 0 },
+    { "COMPRESS_MIN_BYTES",    CLAVE_INT,   &COMPRESION_MIN,        0, 0, 1 },
+    { "TRACE_ENABLED",         CLAVE_INT,   &TRAZA_ACTIVA,          0, 0, 1 },
+    { "TRACE_EVENTS",          CLAVE_INT,   &TRAZA_EVENTOS,         0, 16, 0 },
+};
+
+#define N_CLAVES (sizeof(claves) / sizeof(claves[0]))
+
+// Al arrancar el logger todavía no existe: los avisos van a stderr
+static void avisar(int recarga, const char *fmt, ...) {
+    char texto[512];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(texto, sizeof(texto), fmt, ap);
+    va_end(ap);
+    if (recarga) log_msg("%s", texto);
+    else fprintf(stderr, "⚠️  %s\n", texto);
+}
+
+static char *recortar(char *s) {
+    while (isspace((unsigned char)*s)) s++;
+    char *fin = s + strlen(s);
+    while (fin > s && isspace((unsigned char)fin[-1])) *--fin = '\0';
+    return s;
+}
+
+// Aplica un valor; en una recarga las claves no recargables solo se comparan
+static void aplicar(const Clave *c, const char *valor, const char *path, int linea, int recarga) {
+    long n = 0;
+    if (c->tipo == CLAVE_INT || c->tipo == CLAVE_KB) {
+        char *fin = NULL;
+        errno = 0;
+        n = strtol(valor, &fin, 10);
+        if (errno || fin == valor || *fin != '\0' || n < c->min || n > 2000000000L) {
+            avisar(recarga, "%s:%d: valor inválido para %s: '%s'", path, linea, c->nombre, valor);
+            return;
+        }
+    } else if (c->tipo == CLAVE_MOTOR) {
+        n = motor_desde_nombre(valor);
+        if (n < 0) {
+            avisar(recarga, "%s:%d: motor inválido '%s' (use csv, bin, col o log)", path, linea, valor);
+            return;
+        }
+    }
+
+    int cambia;
+    switch (c->tipo) {
+        case CLAVE_INT:
+        case CLAVE_MOTOR: cambia = *(int *)c->destino != (int)n; break;
+        case CLAVE_KB:    cambia = *(long *)c->destino != n * 1024; break;
+        default:          cambia = strcmp((char *)c->destino, valor) != 0; break;
+    }
+    if (!cambia) return;
+    if (recarga && !c->recargable) {
+        avisar(recarga, "Configuración: %s cambió en %s; se aplica al reiniciar el servidor", c->nombre, path);
+        return;
+    }
+
+    switch (c->tipo) {
+        case CLAVE_INT:
+        case CLAVE_MOTOR: *(int *)c->destino = (int)n; break;
+        case CLAVE_KB:    *(long *)c->destino = n * 1024; break;
+        default:
+            strncpy((char *)c->destino, valor, c->tam - 1);
+            ((char *)c->destino)[c->tam - 1] = '\0';
+            break;
+    }
+    if (recarga) log_msg("Configuración: %s=%s", c->nombre, valor);
+}
+
+int config_cargar(const char *path, int recarga) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        if (recarga) log_msg("Configuración: no se pudo leer %s: %s", path, strerror(errno));
+        return -1;
+    }
+    char buf[1024];
+    int linea = 0;
+    while (fgets(buf, sizeof(buf), f)) {
+        linea++;
+        char *s = recortar(buf);
+        if (*s == '\0' || *s == '#') continue;
+        char *igual = strchr(s, '=');
+        if (!igual) {
+            avisar(recarga, "%s:%d: se esperaba CLAVE=valor", path, linea);
+            continue;
+        }
+        *igual = '\0';
+        char *clave = recortar(s);
+        char *valor = recortar(igual + 1);
+
+        size_t i = 0;
+        while (i < N_CLAVES && strcasecmp(claves[i].nombre, clave) != 0) i++;
+        if (i == N_CLAVES) {
+            avisar(recarga, "%s:%d: clave desconocida %s", path, linea, clave);
+            continue;
+        }
+        aplicar(&claves[i], valor, path, linea, recarga);
+    }
+    fclose(f);
+    return 0;
+}
@@ -0,0 +1,46 @@
+#include <stdlib.h>
+#include <string.h>
+#include "cursor.h"
+#include "db.h"
+#include "utils.h"
+
+void cursor_iniciar(Cursor *c) {
+    memset(c, 0, sizeof(*c));
+}
+
+int cursor_abrir(Cursor *c, const Transaccion *t) {
+    size_t len;
+    long filas;
+    char *datos = copiar_registros(t, 0, -1, &len, &filas);
+    if (!datos) return -1;
+    cursor_cerrar(c);
+    c->datos = datos;
+    c->len = len;
+    c->filas = filas;
+    return 0;
+}
+
+long cursor_leer(Cursor *c, int socket, long n) {
+    if (!c->datos || n <= 0) return 0;
+    // el fin de la página es el '\n' de la fila n: una sola copia al socket
+    const char *ini = c->datos + c->pos, *p = ini, *fin = c->datos + c->len;
+    long enviadas = 0;
+    while (enviadas < n && p < fin) {
+        const char *nl = memchr(p, '\n', (size_t)(fin - p));
+        p = nl ? nl + 1 : fin;
+        enviadas++;
+    }
+    enviar_bytes(socket, ini, (size_t)(p - ini));
+    c->pos += (size_t)(p - ini);
+    c->enviadas += enviadas;
+    return enviadas;
+}
+
+int cursor_abierto(const Cursor *c) {
+    return c->datos != NULL;
+}
+
+void cursor_cerrar(Cursor *c) {
+    free(c->datos);
+    cursor_iniciar(c);
+}
@@ -1,222 +1,390 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
 #include <errno.h>
+#include <stdatomic.h>
 #include "db.h"
+#include "cache.h"
+#include "arena.h"
+#include "db_bin.h"
+#include "db_csv.h"
+#include "db_col.h"
+#include "db_log.h"
+#include "parser_csv.h"
 #include "utils.h"
+#include "traza.h"
 
 char ARCHIVO_DB[512] = "data/productos.csv";
-char TEMP_DB[512] = "data/temp.csv";
+char ARCHIVO_BIN[512] = "data/productos.bin";
+int MOTOR_DB = MOTOR_CSV;
 
-int copiar_archivo(const char* destino, const char* origen);
+// Se incrementa con cada cambio aplicado a la tabla compartida (invalida la cache)
+static atomic_ullong version = 0;
 
-FILE *abrir_base_datos(const char *modo) {
-    FILE *file = NULL;
-    if (strcmp(modo, "r") == 0) {
-        // si existe temp.csv, leer de ahí (transacción activa)
-        if (access(TEMP_DB, F_OK) == 0) {
-            file = fopen(TEMP_DB, modo);
-        } else {
-            file = fopen(ARCHIVO_DB, modo);
+typedef int (*FnFila)(int id, const char *linea, void *ctx);
+
+// ====== Selección de motor ======
+int motor_desde_nombre(const char *nombre) {
+    if (!nombre) return -1;
+    if (strcasecmp(nombre, "csv") == 0) return MOTOR_CSV;
+    if (strcasecmp(nombre, "bin") == 0) return MOTOR_BIN;
+    if (strcasecmp(nombre, "col") == 0) return MOTOR_COL;
+    if (strcasecmp(nombre, "log") == 0) return MOTOR_LOG;
+    return -1;
+}
+
+const char *motor_nombre(int motor) {
+    return motor == MOTOR_BIN ? "bin" : motor == MOTOR_COL ? "col" : motor == MOTOR_LOG ? "log" : "csv";
+}
+
+// Abre el motor configurado. El binario y el de log importan el CSV la primera vez.
+int abrir_motor() {
+    atomic_fetch_add(&version, 1); // puede ser otra tabla (IMPORTAR)
+    if (MOTOR_DB == MOTOR_BIN) {
+        return bin_abrir(ARCHIVO_BIN, ARCHIVO_DB);
+    }
+    if (MOTOR_DB == MOTOR_LOG) return dblog_abrir(ARCHIVO_DB);
+    if (MOTOR_DB == MOTOR_COL) return col_abrir(ARCHIVO_DB);
+    return csv_abrir(ARCHIVO_DB);
+}
+
+// Cierra el motor; el binario y el de log vuelcan una copia CSV para compatibilidad
+void cerrar_motor() {
+    if (MOTOR_DB == MOTOR_BIN) {
+        if (bin_exportar_csv(ARCHIVO_DB) != 0) {
+            log_msg("No se pudo exportar %s a %s", ARCHIVO_BIN, ARCHIVO_DB);
         }
-    } else {
-        if (access(TEMP_DB, F_OK) != 0) {
-            // crear temp.csv copiando db original
-            if (copiar_archivo(TEMP_DB, ARCHIVO_DB) != 0) {
-                perror("Error al crear archivo temporal");
-            }
+        bin_cerrar();
+    } else if (MOTOR_DB == MOTOR_LOG) {
+        if (dblog_exportar_csv(ARCHIVO_DB) != 0) {
+            log_msg("No se pudo exportar %s a %s", ARCHIVO_SEG, ARCHIVO_DB);
         }
-        // para modos de escritura, siempre usar temp.csv
-        file = fopen(TEMP_DB, modo);
+        dblog_cerrar();
+    } else if (MOTOR_DB == MOTOR_COL) {
+        col_cerrar();
+    } else {
+        csv_cerrar();
     }
-    
-    return file;
 }
 
-int copiar_archivo(const char *destino, const char *origen) {
-    FILE *src = fopen(origen, "r");
-    if (!src) return -1;
-    FILE *dst = fopen(destino, "w");
-    if (!dst) {
-        fclose(src);
-        return -1;
+// ====== Conversión de registros ======
+int id_de_linea(const char *linea) {
+    return linea ? atoi(linea) : 0;
+}
+
+// Último campo de la línea (Generador)
+static int generador_de_linea(const char *linea) {
+    const char *coma = strrchr(linea, ',');
+    return coma ? atoi(coma + 1) : 0;
+}
+
+// Parsea "ID,Descripcion,Cantidad,Fecha,Hora,Generador"
+int parsear_producto(const char *linea, Producto *p) {
+    if (!linea || !p) return -1;
+    while (*linea == ' ') linea++;
+    return csv_producto(linea, NULL, p);
+}
+
+// Entero al comienzo de un argumento de comando ("  12", "12;linea") hasta sep
+static int entero_arg(const char *s, char sep, int *v) {
+    while (*s == ' ') s++;
+    const char *fin = sep ? strchr(s, sep) : NULL;
+    if (!fin) fin = s + strlen(s);
+    while (fin > s && fin[-1] == ' ') fin--;
+    return csv_entero(s, (size_t)(fin - s), v);
+}
+
+// Formatea un registro como línea CSV terminada en '\n'
+int formatear_producto(const Producto *p, char *buf, size_t size) {
+    return snprintf(buf, size, "%d,%s,%d,%s,%s,%d\n",
+                    p->id, p->descripcion, p->cantidad, p->fecha, p->hora, p->generador);
+}
+
+// ====== Acceso uniforme a los motores ======
+// El motor binario entrega Producto: se formatea a línea
+typedef struct {
+    FnFila fn;
+    void *ctx;
+} CtxProducto;
+
+static int producto_a_linea(const Producto *p, void *arg) {
+    CtxProducto *c = arg;
+    char linea[256];
+    formatear_producto(p, linea, sizeof(linea));
+    return c->fn(p->id, linea, c->ctx);
+}
+
+static void motor_recorrer(FnFila fn, void *ctx) {
+    CtxProducto c = { fn, ctx };
+    if (MOTOR_DB == MOTOR_BIN) {
+        bin_recorrer(producto_a_linea, &c);
+    } else if (MOTOR_DB == MOTOR_COL) {
+        col_recorrer(fn, ctx);
+    } else if (MOTOR_DB == MOTOR_LOG) {
+        dblog_recorrer(fn, ctx);
+    } else {
+        csv_recorrer(fn, ctx);
     }
-    char buffer[4096];
-    size_t n;
-    while ((n = fread(buffer, 1, sizeof(buffer), src)) > 0) {
-        fwrite(buffer, 1, n, dst);
+}
+
+static int motor_existe(int id) {
+    if (MOTOR_DB == MOTOR_BIN) return bin_buscar_id(id) != NULL;
+    if (MOTOR_DB == MOTOR_COL) return col_existe(id);
+    if (MOTOR_DB == MOTOR_LOG) return dblog_buscar_id(id) != NULL;
+    return csv_buscar_id(id) != NULL;
+}
+
+// Inserta o reemplaza el registro con ese ID
+static int motor_poner(int id, const char *linea) {
+    if (MOTOR_DB == MOTOR_BIN || MOTOR_DB == MOTOR_COL) {
+        Producto p;
+        if (parsear_producto(linea, &p) != 0 || p.id != id) return -1;
+        if (MOTOR_DB == MOTOR_COL) return col_poner(&p);
+        return bin_buscar_id(id) ? bin_modificar(id, &p) : bin_insertar(&p);
     }
-    fclose(src);
-    fclose(dst);
-    return 0;
+    if (MOTOR_DB == MOTOR_LOG) return dblog_poner(id, linea);
+    return csv_poner(id, linea);
 }
 
-// Muestra todos los registros de la base de datos al socket
-void mostrar_registros(int socket_cliente) {
-    FILE *archivo = abrir_base_datos("r");
+static int motor_borrar(int id) {
+    if (MOTOR_DB == MOTOR_BIN) return bin_eliminar(id);
+    if (MOTOR_DB == MOTOR_COL) return col_borrar(id);
+    if (MOTOR_DB == MOTOR_LOG) return dblog_borrar(id);
+    return csv_borrar(id);
+}
 
-    if (!archivo) {
-        enviar(socket_cliente, "Error al abrir el archivo de base de datos.\n");
-        return;
+// Línea con los 6 campos tipados: la misma regla para todos los motores, así
+// una fila aceptada en uno se puede cargar en cualquier otro
+static int linea_valida(const char *linea, int id) {
+    Producto p;
+    return id > 0 && parsear_producto(linea, &p) == 0;
+}
+
+// ====== Vista de una transacción: tabla confirmada + cambios propios ======
+typedef struct {
+    const Transaccion *t;
+    FnFila fn;
+    void *ctx;
+} CtxVista;
+
+static int vista_fila(int id, const char *linea, void *arg) {
+    CtxVista *v = arg;
+    const CambioTrans *c = (v->t && id > 0) ? trans_buscar(v->t, id) : NULL;
+    if (c) {
+        if (!c->linea) return 0; // eliminado por la transacción
+        linea = c->linea;
     }
-    char linea[512];
-    while (fgets(linea, sizeof(linea), archivo)) {
-        enviar(socket_cliente, linea);
+    return v->fn(id, linea, v->ctx);
+}
+
+static void recorrer_vista(const Transaccion *t, FnFila fn, void *ctx) {
+    CtxVista v = { t, fn, ctx };
+    motor_recorrer(vista_fila, &v);
+    if (!t) return;
+    // registros agregados por la transacción (aún no están en la tabla)
+    for (size_t i = 0; i < t->n; i++) {
+        if (t->cambios[i].linea && !t->cambios[i].en_base) {
+            if (fn(t->cambios[i].id, t->cambios[i].linea, ctx) != 0) break;
+        }
     }
-    fclose(archivo);
 }
 
-// Busca por substring en todo el registro (query simple)
-void buscar_registro(int socket_cliente, const char *query) {
-    if (!query || strlen(query) == 0) {
-        enviar(socket_cliente, "BUSCAR requiere un criterio.\n");
-        return;
+static int existe_en_vista(const Transaccion *t, int id) {
+    const CambioTrans *c = t ? trans_buscar(t, id) : NULL;
+    if (c) return c->linea != NULL;
+    return motor_existe(id);
+}
+
+uint64_t db_version(void) {
+    return atomic_load(&version);
+}
+
+// ====== Consultas ======
+typedef struct {
+    int socket;
+    const char *query;
+    int generador;
+    int encontrado;
+    // BUSCAR / FILTRO arman la respuesta entera (un solo send y se puede cachear)
+    // en la arena del hilo, que se reinicia al terminar el comando
+    char *salida;
+    size_t len, cap;
+    int directo;  // sin memoria para acumular: se envía línea a línea
+} CtxConsulta;
+
+static void emitir(CtxConsulta *c, const char *linea) {
+    size_t n = strlen(linea);
+    if (!c->directo && c->len + n + 1 > c->cap) {
+        size_t nueva = c->cap ? c->cap * 2 : 4096;
+        while (nueva < c->len + n + 1) nueva *= 2;
+        char *s = arena_agrandar(arena_hilo(), c->salida, c->cap, nueva);
+        if (s) {
+            c->salida = s;
+            c->cap = nueva;
+        } else {
+            if (c->len) enviar(c->socket, c->salida);
+            c->directo = 1;
+        }
     }
-    // quitar posible espacio inicial
-    while (*query == ' ') query++;
-    FILE *archivo = abrir_base_datos("r");
-    if (!archivo) {
-        enviar(socket_cliente, "Error al abrir el archivo de base de datos.\n");
+    if (c->directo) {
+        enviar(c->socket, linea);
         return;
     }
-    char linea[512];
-    int encontrado = 0;
-    while (fgets(linea, sizeof(linea), archivo)) {
-        if (strstr(linea, query) != NULL) {
-            enviar(socket_cliente, linea);
-            encontrado = 1;
-        }
-    }
-    if (!encontrado) enviar(socket_cliente, "No se encontraron registros.\n");
-    fclose(archivo);
+    memcpy(c->salida + c->len, linea, n + 1);
+    c->len += n;
 }
 
-// Agrega un nuevo registro (línea completa ya formateada)
-int agregar_registro(const char *nuevo_registro) {
-    FILE *archivo = abrir_base_datos("a+");
-    if (!archivo) {
-        perror("Error al abrir el archivo de base de datos");
-        return -1;
+// Envía la respuesta acumulada y la deja en la cache
+static void terminar_consulta(CtxConsulta *c, const char *cmd, const char *arg, const Transaccion *t) {
+    if (!c->directo && c->len) {
+        enviar(c->socket, c->salida);
+        cache_guardar(cmd, arg, t, db_version(), c->salida, c->len);
     }
-    // asegurar que el archivo termina en newline antes de añadir
-    fseek(archivo, 0, SEEK_END);
-    long pos = ftell(archivo);
-    if (pos > 0) {
-        if (fseek(archivo, pos - 1, SEEK_SET) == 0) {
-            int last = fgetc(archivo);
-            if (last != '\n') fputc('\n', archivo);
-        }
+}
+
+// MOSTRAR directo al socket (sin memoria para copiar la vista)
+typedef struct {
+    int socket;
+    long saltar;  // registros que faltan saltear (OFFSET)
+    long quedan;  // registros que faltan enviar, < 0 = sin límite
+} CtxMostrar;
+
+static int enviar_fila(int id, const char *linea, void *arg) {
+    (void)id;
+    CtxMostrar *c = arg;
+    if (c->quedan == 0) return 1;
+    if (c->saltar > 0) {
+        c->saltar--;
+        return 0;
     }
-    fprintf(archivo, "%s\n", nuevo_registro);
-    fclose(archivo);
+    enviar(c->socket, linea);
+    if (c->quedan > 0) c->quedan--;
     return 0;
 }
 
-// Modifica registro: cadena esperada: "<ID>;<nueva_linea_completa>"
-int modificar_registro(int socket_cliente, const char *arg) {
-    if (!arg) return -1;
-    // formato: id;nuevo_registro
-    char copia[1024];
-    strncpy(copia, arg, sizeof(copia)-1);
-    copia[sizeof(copia)-1] = '\0';
-    char *id_str = strtok(copia, ";");
-    char *nuevo = strtok(NULL, "");
-    if (!id_str || !nuevo) {
-        enviar(socket_cliente,"MODIFICAR: formato inválido. Uso: MODIFICAR <ID>;<nueva_linea_completa>\n");
-        return -1;
+static int enviar_si_contiene(int id, const char *linea, void *arg) {
+    (void)id;
+    CtxConsulta *c = arg;
+    if (strstr(linea, c->query) != NULL) {
+        emitir(c, linea);
+        c->encontrado = 1;
     }
-    int id = atoi(id_str);
-    FILE *archivo = abrir_base_datos("r+");
-    if (!archivo) {
-        perror("Error al abrir archivo de base de datos");
-        enviar(socket_cliente,"Error al abrir archivo de base de datos.\n");
-        return -1;
+    return 0;
+}
+
+static int enviar_si_generador(int id, const char *linea, void *arg) {
+    CtxConsulta *c = arg;
+    if (id > 0 && generador_de_linea(linea) == c->generador) {
+        emitir(c, linea);
+        c->encontrado = 1;
     }
+    return 0;
+}
 
-     FILE *temp = fopen("data/temp_mod.csv", "w");
-    if (!temp) {
-        log_msg("Error al abrir archivo temporal para modificación");
-        fclose(archivo);
-        return -1;
+// Muestra los registros de la base de datos al socket (desde / limite como
+// en copiar_registros)
+void mostrar_registros(int socket_cliente, const Transaccion *t, long desde, long limite) {
+    CtxMostrar c = { socket_cliente, desde, limite };
+    uint64_t t_recorrer = traza_inicio();
+    recorrer_vista(t, enviar_fila, &c);
+    traza_fin("db_mostrar", t_recorrer);
+}
+
+// ====== Copias de la vista (MOSTRAR y cursores) ======
+typedef struct {
+    char *buf;
+    size_t len, cap;
+    long saltar;   // registros que faltan saltear (OFFSET)
+    long quedan;   // registros que faltan copiar, < 0 = sin límite
+    long filas;
+    int sin_memoria;
+} CtxCopia;
+
+static int copiar_fila(int id, const char *linea, void *arg) {
+    (void)id;
+    CtxCopia *c = arg;
+    if (c->quedan == 0 || c->sin_memoria) return 1;
+    if (c->saltar > 0) {
+        c->saltar--;
+        return 0;
     }
-    
-    char linea[1024];
-    int encontrado = 0;
-
-    while (fgets(linea, sizeof(linea), archivo)) {
-        char linea_c[1024];
-        strncpy(linea_c, linea, sizeof(linea_c)-1);
-        linea_c[sizeof(linea_c)-1] = '\0';
-        char *tok = strtok(linea_c, ",");
-        int id_arch = atoi(tok);
-        if (id_arch == id) {
-            fputs(nuevo, temp);
-            encontrado = 1;
-        }
-        else {
-            fputs(linea, temp);
+    size_t n = strlen(linea);
+    if (c->len + n + 1 > c->cap) {
+        size_t nueva = c->cap ? c->cap * 2 : 64 * 1024;
+        while (nueva < c->len + n + 1) nueva *= 2;
+        char *b = realloc(c->buf, nueva);
+        if (!b) {
+            c->sin_memoria = 1;
+            return 1;
         }
+        c->buf = b;
+        c->cap = nueva;
     }
-    fclose(archivo);
-    fclose(temp);
-    if (encontrado) {
-        rename("data/temp_mod.csv", TEMP_DB);
-        log_msg("Registro %d modificado.\n", id);
-    } else {
-        remove("data/temp_mod.csv");
-        log_msg("Registro %d no encontrado para modificar.\n", id);
-        return -1;
-    }
+    memcpy(c->buf + c->len, linea, n + 1);
+    c->len += n;
+    c->filas++;
+    if (c->quedan > 0) c->quedan--;
     return 0;
 }
 
-// Elimina registro por ID (arg = "<ID>")
-int eliminar_registro(const char *arg) {
-    if (!arg) return -1;
-    int id = atoi(arg);
-    FILE *archivo = abrir_base_datos("r+");
-    if (!archivo) {
-        log_msg("Error al abrir archivo de base de datos");
-        return -1;
+char *copiar_registros(const Transaccion *t, long desde, long limite, size_t *len, long *filas) {
+    CtxCopia c = { NULL, 0, 0, desde, limite, 0, 0 };
+    uint64_t t_recorrer = traza_inicio();
+    recorrer_vista(t, copiar_fila, &c);
+    traza_fin("db_copiar", t_recorrer);
+    if (c.sin_memoria) {
+        log_msg("Sin memoria para copiar %ld registros (%zu bytes)", c.filas, c.len);
+        free(c.buf);
+        return NULL;
     }
-    FILE *temp = fopen("data/temp_elim.csv", "w");
-    if (!temp) {
-        log_msg("Error al abrir archivo temporal para eliminación");
-        fclose(archivo);
-        return -1;
+    if (!c.buf && !(c.buf = calloc(1, 1))) return NULL;
+    *len = c.len;
+    if (filas) *filas = c.filas;
+    return c.buf;
+}
+
+// "", "LIMIT n", "OFFSET m" o "LIMIT n OFFSET m" (en cualquier orden)
+int limite_offset_arg(const char *arg, long *limite, long *desde) {
+    *limite = -1;
+    *desde = 0;
+    char palabra[16], numero[24];
+    int leidos;
+    while (arg && sscanf(arg, " %15s %23s%n", palabra, numero, &leidos) == 2) {
+        int v;
+        if (csv_entero(numero, strlen(numero), &v) != 0 || v < 0) return -1;
+        if (strcasecmp(palabra, "LIMIT") == 0) *limite = v;
+        else if (strcasecmp(palabra, "OFFSET") == 0) *desde = v;
+        else return -1;
+        arg += leidos;
     }
+    while (arg && *arg == ' ') arg++;
+    return (arg && *arg) ? -1 : 0;
+}
 
-    char linea[1024];
-    int encontrado = 0;
-    
-    while (fgets(linea, sizeof(linea), archivo)) {
-        char copia[1024];
-        strncpy(copia, linea, sizeof(copia)-1);
-        copia[sizeof(copia)-1] = '\0';
-        char *tok = strtok(copia, ",");
-        int id_arch = atoi(tok);
-        if (id_arch == id) {
-            encontrado = 1;
-            continue;
-        }
-        fputs(linea, temp);
+// Busca por substring en todo el registro (query simple)
+void buscar_registro(int socket_cliente, const char *query, const Transaccion *t) {
+    if (!query || strlen(query) == 0) {
+        enviar(socket_cliente, "BUSCAR requiere un criterio.\n");
+        return;
     }
-    fclose(archivo);
-    fclose(temp);
-    if (encontrado) {
-        log_msg("Registro %d eliminado.\n", id);
-        rename("data/temp_elim.csv", TEMP_DB);
+    // quitar posible espacio inicial
+    while (*query == ' ') query++;
+    CtxConsulta c = { socket_cliente, query, 0, 0, NULL, 0, 0, 0 };
+    uint64_t t_recorrer = traza_inicio();
+    if (MOTOR_DB == MOTOR_COL && (!t || t->n == 0)) {
+        col_buscar(query, enviar_si_contiene, &c);
     } else {
-        log_msg("Registro %d no encontrado para eliminar.\n", id);
-        remove("data/temp_elim.csv");
-        return -1;
+        recorrer_vista(t, enviar_si_contiene, &c);
     }
-    return 0;
+    traza_fin("db_buscar", t_recorrer);
+    if (!c.encontrado) emitir(&c, "No se encontraron registros.\n");
+    terminar_consulta(&c, "BUSCAR", query, t);
 }
 
 // Filtra registros por número de generador (ej. "1")
-void filtrar_generador(int socket_cliente, const char *generador) {
+void filtrar_generador(int socket_cliente, const char *generador, const Transaccion *t) {
     if (!generador) {
         enviar(socket_cliente, "FILTRO requiere un número de generador.\n");
         return;
@@ -227,76 +395,138 @@ void filtrar_generador(int socket_cliente, const char *generador) {
         enviar(socket_cliente, "FILTRO requiere un número de generador.\n");
         return;
     }
-    int gen = atoi(generador);
-    if (gen <= 0) {
+    int gen;
+    if (entero_arg(generador, 0, &gen) != 0 || gen <= 0) {
         enviar(socket_cliente, "FILTRO: generador inválido.\n");
         return;
     }
+    CtxConsulta c = { socket_cliente, NULL, gen, 0, NULL, 0, 0, 0 };
+    uint64_t t_recorrer = traza_inicio();
+    if (MOTOR_DB == MOTOR_COL && (!t || t->n == 0)) {
+        // sin cambios propios: basta con recorrer la columna Generador
+        col_filtrar(COL_GENERADOR, gen, enviar_si_generador, &c);
+    } else {
+        recorrer_vista(t, enviar_si_generador, &c);
+    }
+    traza_fin("db_filtrar", t_recorrer);
+    if (!c.encontrado) emitir(&c, "No se encontraron registros para ese generador.\n");
+    terminar_consulta(&c, "FILTRO", generador, t);
+}
 
-    FILE *archivo = abrir_base_datos("r");
-    if (!archivo) {
-        enviar(socket_cliente, "Error al abrir el archivo de base de datos.\n");
-        return;
+// ====== DML (sobre el conjunto de escrituras de la transacción) ======
+
+// Agrega un nuevo registro (línea completa ya formateada)
+int agregar_registro(const char *nuevo_registro, Transaccion *t) {
+    if (!nuevo_registro || !t) return -1;
+    int id = id_de_linea(nuevo_registro);
+    if (!linea_valida(nuevo_registro, id)) {
+        log_msg("AGREGAR: línea inválida: %s", nuevo_registro);
+        return -1;
     }
-    char linea[2048];
-    int encontrado = 0;
-    while (fgets(linea, sizeof(linea), archivo)) {
-        // copiar porque strtok modifica
-        char copia[2048];
-        strncpy(copia, linea, sizeof(copia)-1);
-        copia[sizeof(copia)-1] = '\0';
-        // obtener último token (generador)
-        char *tok = strtok(copia, ",");
-        char *last = tok;
-        while (tok) {
-            last = tok;
-            tok = strtok(NULL, ",");
-        }
-        if (last) {
-            // quitar newline y espacios
-            char *p = last;
-            while (*p && *p != '\n' && *p != '\r') p++;
-            *p = '\0';
-            if (atoi(last) == gen) {
-                enviar(socket_cliente, linea);
-                encontrado = 1;
-            }
-        }
+    if (existe_en_vista(t, id)) {
+        log_msg("AGREGAR: el registro %d ya existe.", id);
+        return -1;
     }
-    if (!encontrado) enviar(socket_cliente, "No se encontraron registros para ese generador.\n");
-    fclose(archivo);
+    return trans_poner(t, id, nuevo_registro, motor_existe(id));
 }
 
-int rollback_transaccion() {
-    // elimina temp.csv
-    if (access(TEMP_DB, F_OK) == 0) {
-        if (remove(TEMP_DB) != 0) {
-            log_msg("Error al eliminar archivo temporal en ROLLBACK: %d", errno);
+// Modifica registro: cadena esperada: "<ID>;<nueva_linea_completa>"
+int modificar_registro(int socket_cliente, const char *arg, Transaccion *t) {
+    if (!arg || !t) return -1;
+    const char *sep = strchr(arg, ';');
+    if (!sep || sep == arg || sep[1] == '\0') {
+        enviar(socket_cliente,"MODIFICAR: formato inválido. Uso: MODIFICAR <ID>;<nueva_linea_completa>\n");
+        return -1;
+    }
+    int id;
+    if (entero_arg(arg, ';', &id) != 0) {
+        enviar(socket_cliente,"MODIFICAR: formato inválido. Uso: MODIFICAR <ID>;<nueva_linea_completa>\n");
+        return -1;
+    }
+    const char *nuevo = sep + 1;
+    int nuevo_id = id_de_linea(nuevo);
+    if (!linea_valida(nuevo, nuevo_id)) {
+        enviar(socket_cliente,"MODIFICAR: formato inválido. Uso: MODIFICAR <ID>;<nueva_linea_completa>\n");
+        return -1;
+    }
+    if (!existe_en_vista(t, id)) {
+        log_msg("Registro %d no encontrado para modificar.\n", id);
+        return -1;
+    }
+    if (nuevo_id != id) {
+        // cambio de ID: equivale a borrar el viejo y agregar el nuevo
+        if (existe_en_vista(t, nuevo_id)) {
+            log_msg("Registro %d: el nuevo ID %d ya existe.\n", id, nuevo_id);
             return -1;
         }
-    } else {
-        log_msg("No hay archivo temporal para ROLLBACK.");
+        if (trans_poner(t, id, NULL, motor_existe(id)) != 0) return -1;
+    }
+    if (trans_poner(t, nuevo_id, nuevo, motor_existe(nuevo_id)) != 0) return -1;
+    log_msg("Registro %d modificado.\n", id);
+    return 0;
+}
+
+// Elimina registro por ID (arg = "<ID>")
+int eliminar_registro(const char *arg, Transaccion *t) {
+    int id;
+    if (!arg || !t || entero_arg(arg, 0, &id) != 0) return -1;
+    if (!existe_en_vista(t, id)) {
+        log_msg("Registro %d no encontrado para eliminar.\n", id);
         return -1;
     }
+    if (trans_poner(t, id, NULL, motor_existe(id)) != 0) return -1;
+    log_msg("Registro %d eliminado.\n", id);
     return 0;
 }
 
-// Aplica archivo temporal (temp.csv) sobre la base de datos (atómico)
-int commit_temp() {
-    // intenta eliminar original y renombrar temp
-    if (access(TEMP_DB, F_OK) != 0) {
-            log_msg("No hay archivo temporal para COMMIT.");
-            return -1;
+int ids_a_bloquear(const char *cmd, const char *arg, int ids[2]) {
+    if (!cmd || !arg) return 0;
+    while (*arg == ' ') arg++;
+    if (strcmp(cmd, "AGREGAR") == 0) {
+        ids[0] = id_de_linea(arg);
+        return 1;
     }
-        if (remove(ARCHIVO_DB) != 0) {
-            log_msg("Error al eliminar archivo original en COMMIT: %d", errno);
-            return -1;
+    if (strcmp(cmd, "ELIMINAR") == 0) {
+        return entero_arg(arg, 0, &ids[0]) == 0 ? 1 : 0;
+    }
+    if (strcmp(cmd, "MODIFICAR") == 0) {
+        const char *sep = strchr(arg, ';');
+        if (entero_arg(arg, ';', &ids[0]) != 0) return 0; // el comando responde el error
+        if (!sep) return 1;
+        ids[1] = id_de_linea(sep + 1);
+        return ids[1] != ids[0] ? 2 : 1;
+    }
+    return 0;
+}
+
+// ====== Aplicación de cambios confirmados ======
+int aplicar_transaccion(const Transaccion *t) {
+    int errores = 0;
+    uint64_t t_aplicar = traza_inicio();
+    for (size_t i = 0; i < t->n; i++) {
+        const CambioTrans *c = &t->cambios[i];
+        if (c->linea) {
+            if (motor_poner(c->id, c->linea) != 0) errores++;
+        } else if (c->en_base) {
+            motor_borrar(c->id);
         }
-        if (rename(TEMP_DB, ARCHIVO_DB) != 0) {
-            log_msg("Error al renombrar archivo temporal en COMMIT: %d", errno);
+    }
+    if (t->n) atomic_fetch_add(&version, 1);
+    traza_fin("db_aplicar", t_aplicar);
+    if (errores) log_msg("COMMIT: %d cambio(s) no se pudieron aplicar", errores);
+    return errores ? -1 : 0;
+}
+
+int aplicar_operacion(char op, int id, const char *linea) {
+    atomic_fetch_add(&version, 1);
+    switch (op) {
+        case 'A':
+        case 'M':
+            return linea ? motor_poner(id, linea) : -1;
+        case 'D':
+            motor_borrar(id); // puede no existir si el snapshot ya lo incluía
+            return 0;
+        default:
             return -1;
-        }
-        
-    return 0;
+    }
 }
-    
\ No newline at end of file
@@ -0,0 +1,233 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "db_bin.h"
+#include "indice.h"
+#include "utils.h"
+
+#define CAPACIDAD_INICIAL 1024
+
+// ====== Estado del archivo mapeado ======
+static int bin_fd = -1;
+static void *mapa = NULL;
+static size_t tam_mapa = 0;
+static CabeceraBin *cab = NULL;
+static RegistroBin *regs = NULL;
+
+// Índice ID -> slot
+static IndiceId idx;
+
+// ====== Mapeo del archivo ======
+// Mapea el archivo con la capacidad pedida. El mapeo anterior (si hay) se
+// suelta solo cuando el nuevo ya está listo: si falla, sigue siendo válido.
+static int mapear(uint32_t capacidad) {
+    size_t tam = sizeof(CabeceraBin) + (size_t)capacidad * sizeof(RegistroBin);
+    if (ftruncate(bin_fd, (off_t)tam) != 0) {
+        log_msg("bin: ftruncate(%zu) falló: %s", tam, strerror(errno));
+        return -1;
+    }
+    void *m = mmap(NULL, tam, PROT_READ | PROT_WRITE, MAP_SHARED, bin_fd, 0);
+    if (m == MAP_FAILED) {
+        log_msg("bin: mmap(%zu) falló: %s", tam, strerror(errno));
+        return -1;
+    }
+    if (mapa) munmap(mapa, tam_mapa);
+    mapa = m;
+    tam_mapa = tam;
+    cab = (CabeceraBin *)mapa;
+    regs = (RegistroBin *)((char *)mapa + sizeof(CabeceraBin));
+    return 0;
+}
+
+static int crecer(void) {
+    uint32_t nueva = cab->capacidad * 2;
+    if (mapear(nueva) != 0) return -1;
+    cab->capacidad = nueva;
+    return 0;
+}
+
+static int32_t asignar_slot(void) {
+    if (cab->libre >= 0) {
+        int32_t s = cab->libre;
+        cab->libre = regs[s].siguiente_libre;
+        return s;
+    }
+    if (cab->usados == cab->capacidad && crecer() != 0) return -1;
+    int32_t s = (int32_t)cab->usados;
+    cab->usados++;
+    return s;
+}
+
+// ====== API ======
+int bin_abrir(const char *path, const char *csv_import) {
+    bin_fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (bin_fd < 0) {
+        log_msg("bin: no se pudo abrir %s: %s", path, strerror(errno));
+        return -1;
+    }
+    struct stat st;
+    if (fstat(bin_fd, &st) != 0) {
+        close(bin_fd);
+        bin_fd = -1;
+        return -1;
+    }
+
+    int nuevo = (st.st_size < (off_t)sizeof(CabeceraBin));
+    if (nuevo) {
+        if (mapear(CAPACIDAD_INICIAL) != 0) { bin_cerrar(); return -1; }
+        memset(cab, 0, sizeof(CabeceraBin));
+        cab->magic = BIN_MAGIC;
+        cab->version = BIN_VERSION;
+        cab->tam_registro = sizeof(RegistroBin);
+        cab->capacidad = CAPACIDAD_INICIAL;
+        cab->libre = -1;
+    } else {
+        CabeceraBin tmp;
+        if (pread(bin_fd, &tmp, sizeof(tmp), 0) != (ssize_t)sizeof(tmp) ||
+            tmp.magic != BIN_MAGIC || tmp.tam_registro != sizeof(RegistroBin)) {
+            log_msg("bin: %s no es un archivo de base binaria válido", path);
+            close(bin_fd);
+            bin_fd = -1;
+            return -1;
+        }
+        // La capacidad sale del tamaño del archivo: la cabecera puede haber
+        // quedado a medio escribir si el proceso cayó mientras crecía
+        uint32_t en_archivo = (uint32_t)((st.st_size - (off_t)sizeof(CabeceraBin)) /
+                                         (off_t)sizeof(RegistroBin));
+        uint32_t capacidad = tmp.capacidad > en_archivo ? tmp.capacidad : en_archivo;
+        if (capacidad == 0) capacidad = CAPACIDAD_INICIAL;
+        if (mapear(capacidad) != 0) { bin_cerrar(); return -1; }
+        cab->capacidad = capacidad;
+    }
+
+    // Reconstruir índice, contadores y free-list desde los flags de ocupado
+    // (igual que el índice, no se confía en lo que diga la cabecera)
+    indice_iniciar(&idx);
+    uint32_t usados = 0, vivos = 0;
+    for (uint32_t s = 0; s < cab->capacidad; s++) {
+        if (!regs[s].ocupado) continue;
+        indice_poner(&idx, regs[s].p.id, (int32_t)s);
+        usados = s + 1;
+        vivos++;
+    }
+    cab->usados = usados;
+    cab->vivos = vivos;
+    cab->libre = -1;
+    for (uint32_t s = usados; s-- > 0;) {
+        if (regs[s].ocupado) continue;
+        regs[s].siguiente_libre = cab->libre;
+        cab->libre = (int32_t)s;
+    }
+
+    if (nuevo && csv_import && access(csv_import, F_OK) == 0) {
+        int n = bin_importar_csv(csv_import);
+        log_msg("bin: importados %d registros desde %s", n, csv_import);
+    }
+    log_msg("bin: %s abierto (%u registros, capacidad %u)", path, cab->vivos, cab->capacidad);
+    return 0;
+}
+
+void bin_cerrar(void) {
+    if (mapa) {
+        msync(mapa, tam_mapa, MS_SYNC);
+        munmap(mapa, tam_mapa);
+    }
+    if (bin_fd >= 0) close(bin_fd);
+    mapa = NULL; cab = NULL; regs = NULL; tam_mapa = 0;
+    bin_fd = -1;
+    indice_liberar(&idx);
+}
+
+const Producto *bin_buscar_id(int id) {
+    int32_t s = indice_buscar(&idx, id);
+    return s >= 0 ? &regs[s].p : NULL;
+}
+
+int bin_insertar(const Producto *p) {
+    if (!cab || p->id <= 0 || indice_buscar(&idx, p->id) >= 0) return -1;
+    int32_t s = asignar_slot();
+    if (s < 0) return -1;
+    regs[s].p = *p;
+    regs[s].siguiente_libre = -1;
+    regs[s].ocupado = 1;
+    cab->vivos++;
+    return indice_poner(&idx, p->id, s);
+}
+
+int bin_modificar(int id, const Producto *p) {
+    int32_t s = indice_buscar(&idx, id);
+    if (s < 0) return -1;
+    // cambio de ID: no puede pisar otro registro existente
+    if (p->id != id && (p->id <= 0 || indice_buscar(&idx, p->id) >= 0)) return -1;
+    regs[s].p = *p;
+    if (p->id != id) {
+        indice_borrar(&idx, id);
+        indice_poner(&idx, p->id, s);
+    }
+    return 0;
+}
+
+int bin_eliminar(int id) {
+    int32_t s = indice_buscar(&idx, id);
+    if (s < 0) return -1;
+    regs[s].ocupado = 0;
+    regs[s].siguiente_libre = cab->libre;
+    cab->libre = s;
+    cab->vivos--;
+    indice_borrar(&idx, id);
+    return 0;
+}
+
+void bin_recorrer(int (*fn)(const Producto *p, void *ctx), void *ctx) {
+    if (!cab) return;
+    for (uint32_t s = 0; s < cab->usados; s++) {
+        if (regs[s].ocupado && fn(&regs[s].p, ctx) != 0) break;
+    }
+}
+
+int bin_sincronizar(void) {
+    if (!mapa) return -1;
+    return msync(mapa, tam_mapa, MS_SYNC);
+}
+
+int bin_importar_csv(const char *csv_path) {
+    FILE *f = fopen(csv_path, "r");
+    if (!f) return -1;
+    char linea[2048];
+    int n = 0;
+    Producto p;
+    while (fgets(linea, sizeof(linea), f)) {
+        if (parsear_producto(linea, &p) != 0) continue; // encabezado, comentarios, #MISSING
+        if (bin_insertar(&p) == 0) n++;
+        else log_msg("bin: registro %d duplicado o inválido al importar, omitido", p.id);
+    }
+    fclose(f);
+    return n;
+}
+
+int bin_exportar_csv(const char *csv_path) {
+    if (!cab) return -1;
+    char tmp[600];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", csv_path);
+    FILE *f = fopen(tmp, "w");
+    if (!f) return -1;
+    char linea[256];
+    for (uint32_t s = 0; s < cab->usados; s++) {
+        if (!regs[s].ocupado) continue;
+        formatear_producto(&regs[s].p, linea, sizeof(linea));
+        fputs(linea, f);
+    }
+    int ok = fflush(f) == 0 && fsync(fileno(f)) == 0;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp, csv_path) != 0) {
+        log_msg("bin: error exportando a %s: %s", csv_path, strerror(errno));
+        remove(tmp);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,408 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "db.h"
+#include "db_col.h"
+#include "indice.h"
+#include "utils.h"
+
+#define HEAP_MIN_COMPACTAR (1024 * 1024)
+
+// Columnas (misma posición = misma fila). c_id == 0 marca una fila borrada
+static int32_t *c_id = NULL, *c_cantidad = NULL, *c_generador = NULL;
+static uint32_t *c_fecha = NULL, *c_hora = NULL, *c_desc = NULL;
+static size_t n_filas = 0, cap_filas = 0;
+static size_t n_borradas = 0;
+static int compactacion_pausada = 0;
+static IndiceId idx;
+
+// Heap de cadenas internadas: tabla abierta de desplazamiento + 1 (0 = vacío)
+static char *heap = NULL;
+static size_t heap_len = 0, heap_cap = 0;
+static size_t heap_tras_compactar = 0;
+static uint32_t *internas = NULL;
+static size_t cap_internas = 0, n_internas = 0;
+
+// ====== Heap de cadenas ======
+static uint32_t hash_cadena(const char *s) {
+    uint32_t h = 2166136261u;
+    for (; *s; s++) h = (h ^ (unsigned char)*s) * 16777619u;
+    return h;
+}
+
+static int agrandar_internas(void) {
+    size_t nueva = cap_internas ? cap_internas * 2 : 1024;
+    uint32_t *t = calloc(nueva, sizeof(uint32_t));
+    if (!t) return -1;
+    for (size_t i = 0; i < cap_internas; i++) {
+        if (!internas[i]) continue;
+        size_t j = hash_cadena(heap + internas[i] - 1) & (nueva - 1);
+        while (t[j]) j = (j + 1) & (nueva - 1);
+        t[j] = internas[i];
+    }
+    free(internas);
+    internas = t;
+    cap_internas = nueva;
+    return 0;
+}
+
+// Desplazamiento de s en el heap, agregándola si no estaba
+static int internar(const char *s, uint32_t *off) {
+    if ((n_internas + 1) * 10 > cap_internas * 7 && agrandar_internas() != 0) return -1;
+    size_t j = hash_cadena(s) & (cap_internas - 1);
+    while (internas[j]) {
+        if (strcmp(heap + internas[j] - 1, s) == 0) {
+            *off = internas[j] - 1;
+            return 0;
+        }
+        j = (j + 1) & (cap_internas - 1);
+    }
+    size_t n = strlen(s) + 1;
+    if (heap_len + n >= COL_EN_HEAP) return -1;
+    if (heap_len + n > heap_cap) {
+        size_t nueva = heap_cap ? heap_cap * 2 : 64 * 1024;
+        while (nueva < heap_len + n) nueva *= 2;
+        char *h = realloc(heap, nueva);
+        if (!h) return -1;
+        heap = h;
+        heap_cap = nueva;
+    }
+    memcpy(heap + heap_len, s, n);
+    *off = (uint32_t)heap_len;
+    internas[j] = (uint32_t)heap_len + 1;
+    heap_len += n;
+    n_internas++;
+    return 0;
+}
+
+// ====== Fecha y hora como enteros ======
+static int digitos(const char *s, int n, unsigned *v) {
+    *v = 0;
+    for (int i = 0; i < n; i++) {
+        if (s[i] < '0' || s[i] > '9') return -1;
+        *v = *v * 10 + (unsigned)(s[i] - '0');
+    }
+    return 0;
+}
+
+// "AAAA-MM-DD" -> AAAAMMDD; otro formato va al heap
+static int codificar_fecha(const char *s, uint32_t *v) {
+    unsigned a, m, d;
+    if (strlen(s) == 10 && s[4] == '-' && s[7] == '-' &&
+        digitos(s, 4, &a) == 0 && digitos(s + 5, 2, &m) == 0 && digitos(s + 8, 2, &d) == 0) {
+        *v = a * 10000 + m * 100 + d;
+        return 0;
+    }
+    if (internar(s, v) != 0) return -1;
+    *v |= COL_EN_HEAP;
+    return 0;
+}
+
+// "HH:MM:SS" -> segundos; otro formato (o minutos/segundos >= 60) va al heap
+static int codificar_hora(const char *s, uint32_t *v) {
+    unsigned h, m, sg;
+    if (strlen(s) == 8 && s[2] == ':' && s[5] == ':' &&
+        digitos(s, 2, &h) == 0 && digitos(s + 3, 2, &m) == 0 && digitos(s + 6, 2, &sg) == 0 &&
+        m < 60 && sg < 60) {
+        *v = h * 3600 + m * 60 + sg;
+        return 0;
+    }
+    if (internar(s, v) != 0) return -1;
+    *v |= COL_EN_HEAP;
+    return 0;
+}
+
+// Línea CSV de la fila i sin pasar por snprintf (es el costo de cada fila recorrida)
+static char *escribir_entero(char *d, int32_t v) {
+    char tmp[12];
+    int n = 0;
+    uint32_t u = v < 0 ? (uint32_t)0 - (uint32_t)v : (uint32_t)v;
+    do { tmp[n++] = (char)('0' + u % 10); u /= 10; } while (u);
+    if (v < 0) *d++ = '-';
+    while (n) *d++ = tmp[--n];
+    return d;
+}
+
+static char *escribir_digitos(char *d, uint32_t v, int n) {
+    for (int i = n - 1; i >= 0; i--) { d[i] = (char)('0' + v % 10); v /= 10; }
+    return d + n;
+}
+
+static char *escribir_cadena(char *d, const char *s, size_t max) {
+    size_t n = strnlen(s, max);
+    memcpy(d, s, n);
+    return d + n;
+}
+
+static size_t formatear_fila(size_t i, char *buf) {
+    char *d = escribir_entero(buf, c_id[i]);
+    *d++ = ',';
+    d = escribir_cadena(d, heap + c_desc[i], DESC_MAX - 1);
+    *d++ = ',';
+    d = escribir_entero(d, c_cantidad[i]);
+    *d++ = ',';
+    uint32_t f = c_fecha[i];
+    if (f & COL_EN_HEAP) {
+        d = escribir_cadena(d, heap + (f & ~COL_EN_HEAP), FECHA_MAX - 1);
+    } else {
+        d = escribir_digitos(d, f / 10000, 4); *d++ = '-';
+        d = escribir_digitos(d, f / 100 % 100, 2); *d++ = '-';
+        d = escribir_digitos(d, f % 100, 2);
+    }
+    *d++ = ',';
+    uint32_t h = c_hora[i];
+    if (h & COL_EN_HEAP) {
+        d = escribir_cadena(d, heap + (h & ~COL_EN_HEAP), HORA_MAX - 1);
+    } else {
+        d = escribir_digitos(d, h / 3600, 2); *d++ = ':';
+        d = escribir_digitos(d, h / 60 % 60, 2); *d++ = ':';
+        d = escribir_digitos(d, h % 60, 2);
+    }
+    *d++ = ',';
+    d = escribir_entero(d, c_generador[i]);
+    *d++ = '\n';
+    *d = '\0';
+    return (size_t)(d - buf);
+}
+
+// Las cadenas de filas modificadas o borradas quedan en el heap: cuando
+// duplica lo que tenía tras la última compactación se reconstruye con las
+// vivas. Se arma aparte y se reemplaza solo si todo salió bien
+static int reinternar(uint32_t v, const char *viejo, int con_marca, uint32_t *nuevo) {
+    if (con_marca && !(v & COL_EN_HEAP)) {
+        *nuevo = v;
+        return 0;
+    }
+    if (internar(viejo + (v & ~COL_EN_HEAP), nuevo) != 0) return -1;
+    if (con_marca) *nuevo |= COL_EN_HEAP;
+    return 0;
+}
+
+static void compactar_heap(void) {
+    uint32_t *desc = malloc(cap_filas * sizeof(uint32_t));
+    uint32_t *fecha = malloc(cap_filas * sizeof(uint32_t));
+    uint32_t *hora = malloc(cap_filas * sizeof(uint32_t));
+    char *viejo = heap;
+    uint32_t *viejas = internas;
+    size_t v_len = heap_len, v_cap = heap_cap, v_cap_int = cap_internas, v_n_int = n_internas;
+    heap = NULL;
+    internas = NULL;
+    heap_len = heap_cap = cap_internas = n_internas = 0;
+
+    int ok = desc && fecha && hora;
+    for (size_t i = 0; ok && i < n_filas; i++) {
+        if (!c_id[i]) continue;
+        ok = reinternar(c_desc[i], viejo, 0, &desc[i]) == 0 &&
+             reinternar(c_fecha[i], viejo, 1, &fecha[i]) == 0 &&
+             reinternar(c_hora[i], viejo, 1, &hora[i]) == 0;
+    }
+    if (!ok) {
+        // sin memoria: se sigue con el heap viejo
+        free(heap);
+        free(internas);
+        heap = viejo;
+        internas = viejas;
+        heap_len = v_len; heap_cap = v_cap; cap_internas = v_cap_int; n_internas = v_n_int;
+        free(desc); free(fecha); free(hora);
+        heap_tras_compactar = heap_len; // no reintentar en cada escritura
+        return;
+    }
+    free(viejo);
+    free(viejas);
+    free(c_desc); free(c_fecha); free(c_hora);
+    c_desc = desc;
+    c_fecha = fecha;
+    c_hora = hora;
+    log_msg("col: heap de cadenas compactado (%zu -> %zu bytes)", v_len, heap_len);
+    heap_tras_compactar = heap_len;
+}
+
+// ====== Filas ======
+static int agrandar_columnas(void) {
+    size_t nueva = cap_filas ? cap_filas * 2 : 1024;
+#define AGRANDAR(col) do { \
+        void *_p = realloc(col, nueva * sizeof(*col)); \
+        if (!_p) return -1; \
+        col = _p; \
+    } while (0)
+    AGRANDAR(c_id);
+    AGRANDAR(c_cantidad);
+    AGRANDAR(c_generador);
+    AGRANDAR(c_fecha);
+    AGRANDAR(c_hora);
+    AGRANDAR(c_desc);
+#undef AGRANDAR
+    cap_filas = nueva;
+    return 0;
+}
+
+// Elimina los huecos de filas borradas y reconstruye el índice
+static void compactar(void) {
+    size_t j = 0;
+    indice_vaciar(&idx);
+    for (size_t i = 0; i < n_filas; i++) {
+        if (!c_id[i]) continue;
+        c_id[j] = c_id[i];
+        c_cantidad[j] = c_cantidad[i];
+        c_generador[j] = c_generador[i];
+        c_fecha[j] = c_fecha[i];
+        c_hora[j] = c_hora[i];
+        c_desc[j] = c_desc[i];
+        indice_poner(&idx, c_id[j], (int32_t)j);
+        j++;
+    }
+    n_filas = j;
+    n_borradas = 0;
+}
+
+int col_abrir(const char *csv_path) {
+    indice_iniciar(&idx);
+    FILE *f = fopen(csv_path, "r");
+    if (!f) {
+        if (errno == ENOENT) return 0; // base vacía
+        log_msg("col: no se pudo abrir %s: %s", csv_path, strerror(errno));
+        return -1;
+    }
+    char linea[2048];
+    Producto p;
+    size_t omitidas = 0;
+    while (fgets(linea, sizeof(linea), f)) {
+        if (parsear_producto(linea, &p) != 0) { // encabezado, comentarios, #MISSING
+            if (linea[0] != '\n' && linea[0] != '\r') omitidas++;
+            continue;
+        }
+        if (col_existe(p.id)) {
+            log_msg("col: registro %d duplicado al cargar, omitido", p.id);
+            continue;
+        }
+        if (col_poner(&p) != 0) {
+            fclose(f);
+            log_msg("col: sin memoria cargando %s", csv_path);
+            return -1;
+        }
+    }
+    fclose(f);
+    heap_tras_compactar = heap_len;
+    log_msg("col: %s cargado en memoria (%zu filas, %zu bytes de cadenas, %zu líneas sin registro)",
+            csv_path, n_filas, heap_len, omitidas);
+    return 0;
+}
+
+void col_cerrar(void) {
+    free(c_id); free(c_cantidad); free(c_generador);
+    free(c_fecha); free(c_hora); free(c_desc);
+    c_id = c_cantidad = c_generador = NULL;
+    c_fecha = c_hora = c_desc = NULL;
+    n_filas = cap_filas = n_borradas = 0;
+    free(heap);
+    free(internas);
+    heap = NULL;
+    internas = NULL;
+    heap_len = heap_cap = heap_tras_compactar = 0;
+    cap_internas = n_internas = 0;
+    indice_liberar(&idx);
+}
+
+int col_existe(int id) {
+    return indice_buscar(&idx, id) >= 0;
+}
+
+int col_poner(const Producto *p) {
+    if (p->id <= 0) return -1;
+    if (heap_len > HEAP_MIN_COMPACTAR && heap_len > 2 * heap_tras_compactar) compactar_heap();
+
+    uint32_t desc, fecha, hora;
+    if (internar(p->descripcion, &desc) != 0 || codificar_fecha(p->fecha, &fecha) != 0 ||
+        codificar_hora(p->hora, &hora) != 0) return -1;
+
+    int32_t pos = indice_buscar(&idx, p->id);
+    if (pos < 0) {
+        if (n_filas == cap_filas && agrandar_columnas() != 0) return -1;
+        if (indice_poner(&idx, p->id, (int32_t)n_filas) != 0) return -1;
+        pos = (int32_t)n_filas++;
+    }
+    c_id[pos] = p->id;
+    c_cantidad[pos] = p->cantidad;
+    c_generador[pos] = p->generador;
+    c_fecha[pos] = fecha;
+    c_hora[pos] = hora;
+    c_desc[pos] = desc;
+    return 0;
+}
+
+int col_borrar(int id) {
+    int32_t pos = indice_buscar(&idx, id);
+    if (pos < 0) return -1;
+    c_id[pos] = 0;
+    indice_borrar(&idx, id);
+    n_borradas++;
+    if (!compactacion_pausada && n_borradas > 1024 && n_borradas * 2 > n_filas) compactar();
+    return 0;
+}
+
+// Largo máximo de una línea armada por formatear_fila
+#define LINEA_MAX (3 * 12 + DESC_MAX + FECHA_MAX + HORA_MAX + 8)
+
+void col_recorrer(int (*fn)(int id, const char *linea, void *ctx), void *ctx) {
+    char linea[LINEA_MAX];
+    for (size_t i = 0; i < n_filas; i++) {
+        if (!c_id[i]) continue;
+        formatear_fila(i, linea);
+        if (fn(c_id[i], linea, ctx) != 0) break;
+    }
+}
+
+void col_filtrar(ColumnaCol col, int valor, int (*fn)(int id, const char *linea, void *ctx), void *ctx) {
+    const int32_t *c = col == COL_ID ? c_id : col == COL_CANTIDAD ? c_cantidad : c_generador;
+    char linea[LINEA_MAX];
+    for (size_t i = 0; i < n_filas; i++) {
+        if (c[i] != valor || !c_id[i]) continue;
+        formatear_fila(i, linea);
+        if (fn(c_id[i], linea, ctx) != 0) break;
+    }
+}
+
+static int en_heap_contiene(uint32_t v, const char *texto) {
+    return (v & COL_EN_HEAP) && strstr(heap + (v & ~COL_EN_HEAP), texto) != NULL;
+}
+
+void col_buscar(const char *texto, int (*fn)(int id, const char *linea, void *ctx), void *ctx) {
+    char linea[LINEA_MAX];
+    int solo_cadenas = texto[strspn(texto, "0123456789-:")] != '\0' && !strchr(texto, ',');
+    for (size_t i = 0; i < n_filas; i++) {
+        if (!c_id[i]) continue;
+        if (solo_cadenas && !strstr(heap + c_desc[i], texto) &&
+            !en_heap_contiene(c_fecha[i], texto) && !en_heap_contiene(c_hora[i], texto)) continue;
+        formatear_fila(i, linea);
+        if (!solo_cadenas && !strstr(linea, texto)) continue;
+        if (fn(c_id[i], linea, ctx) != 0) break;
+    }
+}
+
+size_t col_posiciones(void) {
+    return n_filas;
+}
+
+size_t col_volcar(FILE *f, size_t desde, size_t max_filas, size_t *bytes) {
+    size_t i = desde, escritos = 0;
+    char linea[LINEA_MAX];
+    for (; i < n_filas && i - desde < max_filas; i++) {
+        if (!c_id[i]) continue;
+        size_t n = formatear_fila(i, linea);
+        fwrite(linea, 1, n, f);
+        escritos += n;
+    }
+    if (bytes) *bytes += escritos;
+    return i;
+}
+
+void col_pausar_compactacion(int pausar) {
+    compactacion_pausada = pausar;
+}
+
+void col_estadisticas(size_t *filas, size_t *bytes_columnas, size_t *bytes_heap) {
+    if (filas) *filas = n_filas - n_borradas;
+    if (bytes_columnas) *bytes_columnas = cap_filas * 6 * sizeof(uint32_t);
+    if (bytes_heap) *bytes_heap = heap_len;
+}
@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include "db.h"
+#include "db_csv.h"
+#include "indice.h"
+#include "particiones.h"
+#include "utils.h"
+
+typedef struct {
+    FilaCsv *filas;
+    size_t n_filas, cap_filas;
+    size_t n_borradas;
+    IndiceId idx;
+} ParticionCsv;
+
+static ParticionCsv particiones[PARTICIONES_MAX];
+static int n_particiones = 1;
+// Se toma con la partición bloqueada: dentro de cada una el orden es creciente
+static atomic_ullong orden_siguiente = 1;
+
+#define VENTANA_MEZCLA 4096
+
+// Recorrido de todas las particiones en orden de llegada: los números de
+// orden son casi consecutivos, así que en vez de comparar las cabezas de las
+// particiones en cada fila se reparten las filas de una ventana de números
+// en su casillero y después se leen los casilleros en orden
+typedef struct {
+    size_t pos[PARTICIONES_MAX];              // próxima fila de cada partición
+    const FilaCsv *ventana[VENTANA_MEZCLA];   // casillero = orden - base
+    size_t usados, leido;
+} Mezcla;
+
+// Copia la línea asegurando un único '\n' final
+static char *duplicar_linea(const char *linea) {
+    size_t n = strcspn(linea, "\r\n");
+    char *copia = malloc(n + 2);
+    if (!copia) return NULL;
+    memcpy(copia, linea, n);
+    copia[n] = '\n';
+    copia[n + 1] = '\0';
+    return copia;
+}
+
+static int agregar_fila(ParticionCsv *p, int id, char *linea) {
+    if (p->n_filas == p->cap_filas) {
+        size_t nueva = p->cap_filas ? p->cap_filas * 2 : 1024;
+        FilaCsv *f = realloc(p->filas, nueva * sizeof(FilaCsv));
+        if (!f) return -1;
+        p->filas = f;
+        p->cap_filas = nueva;
+    }
+    // si el ID está repetido en el archivo, el índice apunta a la primera aparición
+    if (id > 0 && indice_buscar(&p->idx, id) < 0 && indice_poner(&p->idx, id, (int32_t)p->n_filas) != 0) return -1;
+    p->filas[p->n_filas].id = id;
+    p->filas[p->n_filas].orden = atomic_fetch_add(&orden_siguiente, 1);
+    p->filas[p->n_filas].linea = linea;
+    p->n_filas++;
+    return 0;
+}
+
+// Elimina los huecos de filas borradas y reconstruye el índice
+static void compactar(ParticionCsv *p) {
+    size_t j = 0;
+    indice_vaciar(&p->idx);
+    for (size_t i = 0; i < p->n_filas; i++) {
+        if (!p->filas[i].linea) continue;
+        p->filas[j] = p->filas[i];
+        if (p->filas[j].id > 0 && indice_buscar(&p->idx, p->filas[j].id) < 0) {
+            indice_poner(&p->idx, p->filas[j].id, (int32_t)j);
+        }
+        j++;
+    }
+    p->n_filas = j;
+    p->n_borradas = 0;
+}
+
+// Posiciona cada partición en su primera fila con orden >= desde
+static void mezcla_iniciar(Mezcla *m, uint64_t desde) {
+    for (int i = 0; i < n_particiones; i++) {
+        const ParticionCsv *p = &particiones[i];
+        size_t lo = 0, hi = p->n_filas;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (p->filas[mid].orden < desde) lo = mid + 1;
+            else hi = mid;
+        }
+        m->pos[i] = lo;
+    }
+    memset(m->ventana, 0, sizeof(m->ventana));
+    m->usados = m->leido = 0;
+}
+
+// Reparte la próxima ventana (desde la menor cabeza). 0 si no quedan filas
+static int mezcla_llenar(Mezcla *m) {
+    uint64_t base = UINT64_MAX;
+    for (int i = 0; i < n_particiones; i++) {
+        const ParticionCsv *p = &particiones[i];
+        while (m->pos[i] < p->n_filas && !p->filas[m->pos[i]].linea) m->pos[i]++;
+        if (m->pos[i] < p->n_filas && p->filas[m->pos[i]].orden < base) base = p->filas[m->pos[i]].orden;
+    }
+    if (base == UINT64_MAX) return 0;
+    m->usados = m->leido = 0;
+    for (int i = 0; i < n_particiones; i++) {
+        const ParticionCsv *p = &particiones[i];
+        size_t j = m->pos[i];
+        for (; j < p->n_filas && p->filas[j].orden - base < VENTANA_MEZCLA; j++) {
+            if (!p->filas[j].linea) continue;
+            size_t casillero = p->filas[j].orden - base;
+            m->ventana[casillero] = &p->filas[j];
+            if (casillero >= m->usados) m->usados = casillero + 1;
+        }
+        m->pos[i] = j;
+    }
+    return 1;
+}
+
+// Próxima fila viva en orden o NULL al terminar
+static const FilaCsv *mezcla_siguiente(Mezcla *m) {
+    while (1) {
+        while (m->leido < m->usados) {
+            const FilaCsv *f = m->ventana[m->leido];
+            m->ventana[m->leido++] = NULL;
+            if (f) return f;
+        }
+        if (!mezcla_llenar(m)) return NULL;
+    }
+}
+
+int csv_abrir(const char *path) {
+    n_particiones = particiones_cantidad();
+    for (int i = 0; i < n_particiones; i++) indice_iniciar(&particiones[i].idx);
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        if (errno == ENOENT) return 0; // base vacía
+        log_msg("csv: no se pudo abrir %s: %s", path, strerror(errno));
+        return -1;
+    }
+    char linea[2048];
+    size_t filas = 0, nro = 0, omitidas = 0;
+    Producto prod;
+    while (fgets(linea, sizeof(linea), f)) {
+        nro++;
+        if (linea[0] == '\n' || linea[0] == '\r') continue;
+        // misma validación que AGREGAR/MODIFICAR (campos, caracteres de control)
+        if (parsear_producto(linea, &prod) != 0) { // encabezado, comentarios, #MISSING
+            log_msg("csv: línea %zu de %s no es un registro válido, omitida", nro, path);
+            omitidas++;
+            continue;
+        }
+        char *copia = duplicar_linea(linea);
+        int id = prod.id;
+        if (!copia || agregar_fila(&particiones[particion_de(id)], id, copia) != 0) {
+            free(copia);
+            fclose(f);
+            log_msg("csv: sin memoria cargando %s", path);
+            return -1;
+        }
+        filas++;
+    }
+    fclose(f);
+    log_msg("csv: %s cargado en memoria (%zu filas, %d particiones, %zu líneas sin registro)",
+            path, filas, n_particiones, omitidas);
+    return 0;
+}
+
+void csv_cerrar(void) {
+    for (int i = 0; i < n_particiones; i++) {
+        ParticionCsv *p = &particiones[i];
+        for (size_t j = 0; j < p->n_filas; j++) free(p->filas[j].linea);
+        free(p->filas);
+        p->filas = NULL;
+        p->n_filas = p->cap_filas = p->n_borradas = 0;
+        indice_liberar(&p->idx);
+    }
+}
+
+const char *csv_buscar_id(int id) {
+    const ParticionCsv *p = &particiones[particion_de(id)];
+    int32_t pos = indice_buscar(&p->idx, id);
+    return pos >= 0 ? p->filas[pos].linea : NULL;
+}
+
+int csv_poner(int id, const char *linea) {
+    char *copia = duplicar_linea(linea);
+    if (!copia) return -1;
+    ParticionCsv *p = &particiones[particion_de(id)];
+    int32_t pos = indice_buscar(&p->idx, id);
+    if (pos >= 0) {
+        free(p->filas[pos].linea);
+        p->filas[pos].linea = copia;
+        return 0;
+    }
+    if (agregar_fila(p, id, copia) != 0) {
+        free(copia);
+        return -1;
+    }
+    return 0;
+}
+
+int csv_borrar(int id) {
+    ParticionCsv *p = &particiones[particion_de(id)];
+    int32_t pos = indice_buscar(&p->idx, id);
+    if (pos < 0) return -1;
+    free(p->filas[pos].linea);
+    p->filas[pos].linea = NULL;
+    indice_borrar(&p->idx, id);
+    p->n_borradas++;
+    if (p->n_borradas > 1024 && p->n_borradas * 2 > p->n_filas) compactar(p);
+    return 0;
+}
+
+void csv_recorrer(int (*fn)(int id, const char *linea, void *ctx), void *ctx) {
+    if (n_particiones == 1) {
+        const ParticionCsv *p = &particiones[0];
+        for (size_t i = 0; i < p->n_filas; i++) {
+            if (p->filas[i].linea && fn(p->filas[i].id, p->filas[i].linea, ctx) != 0) break;
+        }
+        return;
+    }
+    Mezcla m;
+    mezcla_iniciar(&m, 0);
+    const FilaCsv *f;
+    while ((f = mezcla_siguiente(&m)) && fn(f->id, f->linea, ctx) == 0)
+        ;
+}
+
+size_t csv_posiciones(void) {
+    return (size_t)atomic_load(&orden_siguiente);
+}
+
+size_t csv_volcar(FILE *f, size_t desde, size_t max_filas, size_t *bytes) {
+    Mezcla m;
+    mezcla_iniciar(&m, desde);
+    size_t n = 0, escritos = 0;
+    const FilaCsv *fila;
+    while (n < max_filas && (fila = mezcla_siguiente(&m))) {
+        escritos += strlen(fila->linea);
+        fputs(fila->linea, f);
+        desde = fila->orden + 1;
+        n++;
+    }
+    if (bytes) *bytes += escritos;
+    return n < max_filas ? csv_posiciones() : desde;
+}
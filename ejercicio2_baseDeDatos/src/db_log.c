@@ -0,0 +1,603 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "db.h"
+#include "db_log.h"
+#include "indice.h"
+#include "utils.h"
+
+#define HOLGURA_MAPA   (64 * 1024)         /* el último registro puede pasar el tamaño del segmento */
+#define BASURA_MIN     (1024 * 1024)       /* menos basura que esto no vale una compactación */
+#define REG_MAX        4096
+
+char ARCHIVO_SEG[512] = "data/productos.seg";
+int SEGMENTO_KB = SEGMENTO_KB_DEF;
+
+typedef struct {
+    uint32_t numero;
+    int fd;
+    char *mapa;          /* solo lectura; se escribe con pwrite */
+    size_t tam_mapa;
+    size_t fin;          /* bytes válidos */
+    size_t vivos;        /* bytes de registros vigentes */
+    size_t lapidas;      /* bytes de lápidas */
+    int sucio;           /* escrito desde el último fdatasync */
+} SegmentoLog;
+
+typedef struct {
+    int id;
+    SegmentoLog *seg;    /* NULL si la fila fue borrada */
+    uint32_t off;
+} FilaLog;
+
+// Segmentos ordenados por número; el último es el activo
+static SegmentoLog **segs = NULL;
+static size_t n_segs = 0, cap_segs = 0;
+// Filas en orden de llegada, como el motor CSV
+static FilaLog *filas = NULL;
+static size_t n_filas = 0, cap_filas = 0, n_borradas = 0;
+static IndiceId idx;
+static size_t tam_segmento = 0;
+static uint32_t generacion = 0;
+static int abierto = 0;
+
+// Totales para STATS (se leen sin lock)
+static size_t total_bytes = 0, total_vivos = 0;
+
+// ====== Registros ======
+static size_t tam_reg(uint32_t largo) {
+    return (sizeof(CabeceraRegLog) + largo + 7) & ~(size_t)7;
+}
+
+static const CabeceraRegLog *registro(const SegmentoLog *s, uint32_t off) {
+    return (const CabeceraRegLog *)(s->mapa + off);
+}
+
+static const char *linea_de(const SegmentoLog *s, uint32_t off) {
+    return s->mapa + off + sizeof(CabeceraRegLog);
+}
+
+static uint32_t suma_reg(int32_t id, uint32_t largo, const char *linea) {
+    uint32_t h = 2166136261u;
+    const unsigned char *p = (const unsigned char *)&id;
+    for (size_t i = 0; i < sizeof(id); i++) h = (h ^ p[i]) * 16777619u;
+    p = (const unsigned char *)&largo;
+    for (size_t i = 0; i < sizeof(largo); i++) h = (h ^ p[i]) * 16777619u;
+    for (uint32_t i = 0; i < largo; i++) h = (h ^ (unsigned char)linea[i]) * 16777619u;
+    return h;
+}
+
+// Registro completo y sano en [off, limite)
+static int registro_valido(const SegmentoLog *s, size_t off, size_t limite) {
+    if (off + sizeof(CabeceraRegLog) > limite) return 0;
+    const CabeceraRegLog *h = registro(s, (uint32_t)off);
+    if (h->magia != REG_MAGIA || h->largo > REG_MAX || off + tam_reg(h->largo) > limite) return 0;
+    const char *linea = linea_de(s, (uint32_t)off);
+    if (h->largo > 0 && (h->largo < 2 || linea[h->largo - 1] != '\0' || linea[h->largo - 2] != '\n'))
+        return 0;
+    return h->suma == suma_reg(h->id, h->largo, linea);
+}
+
+// ====== Archivos de segmento ======
+static void ruta_segmento(uint32_t numero, char *dst, size_t size) {
+    snprintf(dst, size, "%s.%06u", ARCHIVO_SEG, numero);
+}
+
+// Directorio y nombre base de un prefijo ("data/productos.seg" -> "data", "productos.seg")
+static void separar_prefijo(const char *prefijo, char *dir, size_t tam_dir, const char **base) {
+    const char *barra = strrchr(prefijo, '/');
+    if (!barra) {
+        snprintf(dir, tam_dir, ".");
+        *base = prefijo;
+        return;
+    }
+    snprintf(dir, tam_dir, "%.*s", (int)(barra - prefijo), prefijo);
+    if (!dir[0]) snprintf(dir, tam_dir, "/");
+    *base = barra + 1;
+}
+
+// Número de segmento si nombre es "<base>.NNNNNN", 0 si no
+static uint32_t numero_de(const char *nombre, const char *base) {
+    size_t n = strlen(base);
+    if (strncmp(nombre, base, n) != 0 || nombre[n] != '.') return 0;
+    const char *d = nombre + n + 1;
+    if (strlen(d) != 6 || strspn(d, "0123456789") != 6) return 0;
+    return (uint32_t)strtoul(d, NULL, 10);
+}
+
+static void sincronizar_directorio(void) {
+    char dir[512];
+    const char *base;
+    separar_prefijo(ARCHIVO_SEG, dir, sizeof(dir), &base);
+    int fd = open(dir, O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+static int comparar_numeros(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+// Números de los segmentos existentes, ordenados. -1 si falla
+static long listar_segmentos(const char *prefijo, uint32_t **numeros) {
+    char dir[512];
+    const char *base;
+    separar_prefijo(prefijo, dir, sizeof(dir), &base);
+    *numeros = NULL;
+    DIR *d = opendir(dir);
+    if (!d) return errno == ENOENT ? 0 : -1;
+    size_t n = 0, cap = 0;
+    struct dirent *e;
+    while ((e = readdir(d))) {
+        uint32_t num = numero_de(e->d_name, base);
+        if (num == 0) continue;
+        if (n == cap) {
+            cap = cap ? cap * 2 : 16;
+            uint32_t *nuevo = realloc(*numeros, cap * sizeof(uint32_t));
+            if (!nuevo) {
+                closedir(d);
+                free(*numeros);
+                *numeros = NULL;
+                return -1;
+            }
+            *numeros = nuevo;
+        }
+        (*numeros)[n++] = num;
+    }
+    closedir(d);
+    qsort(*numeros, n, sizeof(uint32_t), comparar_numeros);
+    return (long)n;
+}
+
+static void liberar_segmento(SegmentoLog *s) {
+    if (s->mapa) munmap(s->mapa, s->tam_mapa);
+    if (s->fd >= 0) close(s->fd);
+    free(s);
+}
+
+static int agregar_segmento(SegmentoLog *s) {
+    if (n_segs == cap_segs) {
+        size_t nueva = cap_segs ? cap_segs * 2 : 16;
+        SegmentoLog **v = realloc(segs, nueva * sizeof(SegmentoLog *));
+        if (!v) return -1;
+        segs = v;
+        cap_segs = nueva;
+    }
+    segs[n_segs++] = s;
+    return 0;
+}
+
+// Abre y mapea un segmento; con crear, lo crea vacío con su cabecera
+static SegmentoLog *mapear_segmento(uint32_t numero, int crear) {
+    char ruta[600];
+    ruta_segmento(numero, ruta, sizeof(ruta));
+    SegmentoLog *s = calloc(1, sizeof(SegmentoLog));
+    if (!s) return NULL;
+    s->numero = numero;
+    s->fd = open(ruta, O_RDWR | O_CLOEXEC | (crear ? O_CREAT | O_EXCL : 0), 0644);
+    if (s->fd < 0) {
+        log_msg("log: no se pudo abrir %s: %s", ruta, strerror(errno));
+        free(s);
+        return NULL;
+    }
+    size_t tam = sizeof(CabeceraSegLog);
+    if (crear) {
+        CabeceraSegLog cab = { SEG_MAGIA, SEG_VERSION, numero, {0} };
+        if (pwrite(s->fd, &cab, sizeof(cab), 0) != (ssize_t)sizeof(cab)) {
+            log_msg("log: no se pudo escribir la cabecera de %s: %s", ruta, strerror(errno));
+            liberar_segmento(s);
+            unlink(ruta);
+            return NULL;
+        }
+        s->sucio = 1;
+    } else {
+        struct stat st;
+        CabeceraSegLog cab;
+        if (fstat(s->fd, &st) != 0 || pread(s->fd, &cab, sizeof(cab), 0) != (ssize_t)sizeof(cab) ||
+            cab.magia != SEG_MAGIA || cab.version != SEG_VERSION || cab.numero != numero) {
+            log_msg("log: %s no es un segmento válido", ruta);
+            liberar_segmento(s);
+            return NULL;
+        }
+        tam = (size_t)st.st_size;
+    }
+    // Se mapea más de lo escrito: las escrituras con pwrite quedan visibles en el mapa
+    s->tam_mapa = (tam > tam_segmento ? tam : tam_segmento) + HOLGURA_MAPA;
+    s->mapa = mmap(NULL, s->tam_mapa, PROT_READ, MAP_SHARED, s->fd, 0);
+    if (s->mapa == MAP_FAILED) {
+        log_msg("log: mmap de %s falló: %s", ruta, strerror(errno));
+        s->mapa = NULL;
+        liberar_segmento(s);
+        return NULL;
+    }
+    s->fin = tam;
+    return s;
+}
+
+static SegmentoLog *nuevo_segmento(void) {
+    uint32_t numero = n_segs ? segs[n_segs - 1]->numero + 1 : 1;
+    SegmentoLog *s = mapear_segmento(numero, 1);
+    if (!s) return NULL;
+    if (agregar_segmento(s) != 0) {
+        char ruta[600];
+        ruta_segmento(numero, ruta, sizeof(ruta));
+        liberar_segmento(s);
+        unlink(ruta);
+        return NULL;
+    }
+    total_bytes += s->fin;
+    sincronizar_directorio();
+    return s;
+}
+
+static SegmentoLog *buscar_segmento(uint32_t numero) {
+    for (size_t i = 0; i < n_segs; i++) {
+        if (segs[i]->numero == numero) return segs[i];
+    }
+    return NULL;
+}
+
+// Agrega un registro ya armado al segmento activo (abre otro si está lleno)
+static SegmentoLog *escribir(const void *reg, size_t tam, uint32_t *off) {
+    SegmentoLog *s = n_segs ? segs[n_segs - 1] : NULL;
+    if (!s || (s->fin + tam > tam_segmento && s->fin > sizeof(CabeceraSegLog))) {
+        s = nuevo_segmento();
+        if (!s) return NULL;
+    }
+    if (pwrite(s->fd, reg, tam, (off_t)s->fin) != (ssize_t)tam) {
+        log_msg("log: error escribiendo el segmento %u: %s", s->numero, strerror(errno));
+        return NULL;
+    }
+    *off = (uint32_t)s->fin;
+    s->fin += tam;
+    s->sucio = 1;
+    total_bytes += tam;
+    return s;
+}
+
+// ====== Índice ======
+static int agregar_fila(int id, SegmentoLog *s, uint32_t off) {
+    if (n_filas == cap_filas) {
+        size_t nueva = cap_filas ? cap_filas * 2 : 1024;
+        FilaLog *f = realloc(filas, nueva * sizeof(FilaLog));
+        if (!f) return -1;
+        filas = f;
+        cap_filas = nueva;
+    }
+    if (indice_poner(&idx, id, (int32_t)n_filas) != 0) return -1;
+    filas[n_filas].id = id;
+    filas[n_filas].seg = s;
+    filas[n_filas].off = off;
+    n_filas++;
+    return 0;
+}
+
+// Elimina los huecos de filas borradas y reconstruye el índice
+static void compactar_filas(void) {
+    size_t j = 0;
+    indice_vaciar(&idx);
+    for (size_t i = 0; i < n_filas; i++) {
+        if (!filas[i].seg) continue;
+        filas[j] = filas[i];
+        indice_poner(&idx, filas[j].id, (int32_t)j);
+        j++;
+    }
+    n_filas = j;
+    n_borradas = 0;
+}
+
+// La versión anterior de una fila pasa a ser basura
+static void descontar(const FilaLog *f) {
+    size_t tam = tam_reg(registro(f->seg, f->off)->largo);
+    f->seg->vivos -= tam;
+    total_vivos -= tam;
+}
+
+// El registro en (s, off) pasa a ser la última versión de su ID
+static int indexar(SegmentoLog *s, uint32_t off) {
+    const CabeceraRegLog *h = registro(s, off);
+    int32_t pos = indice_buscar(&idx, h->id);
+    if (pos >= 0) descontar(&filas[pos]);
+    if (h->largo == 0) {
+        s->lapidas += tam_reg(0);
+        if (pos >= 0) {
+            filas[pos].seg = NULL;
+            indice_borrar(&idx, h->id);
+            n_borradas++;
+            if (n_borradas > 1024 && n_borradas * 2 > n_filas) compactar_filas();
+        }
+        return 0;
+    }
+    s->vivos += tam_reg(h->largo);
+    total_vivos += tam_reg(h->largo);
+    if (pos >= 0) {
+        filas[pos].seg = s;
+        filas[pos].off = off;
+        return 0;
+    }
+    return agregar_fila(h->id, s, off);
+}
+
+// Recorre los registros de un segmento; descarta el final dañado
+static void cargar_segmento(SegmentoLog *s, int ultimo) {
+    size_t off = sizeof(CabeceraSegLog);
+    size_t registros = 0;
+    while (registro_valido(s, off, s->fin)) {
+        if (indexar(s, (uint32_t)off) != 0) {
+            log_msg("log: sin memoria cargando el segmento %u", s->numero);
+            break;
+        }
+        off += tam_reg(registro(s, (uint32_t)off)->largo);
+        registros++;
+    }
+    if (off < s->fin) {
+        if (ultimo) {
+            log_msg("log: segmento %u: %zu bytes cortados al final descartados", s->numero, s->fin - off);
+            if (ftruncate(s->fd, (off_t)off) != 0)
+                log_msg("log: no se pudo truncar el segmento %u: %s", s->numero, strerror(errno));
+        } else {
+            log_msg("⚠️  log: segmento %u dañado desde el byte %zu (%zu bytes ignorados)",
+                    s->numero, off, s->fin - off);
+        }
+        s->fin = off;
+    }
+    total_bytes += s->fin;
+}
+
+// ====== API ======
+int dblog_abrir(const char *csv_import) {
+    indice_iniciar(&idx);
+    tam_segmento = (size_t)(SEGMENTO_KB > 0 ? SEGMENTO_KB : SEGMENTO_KB_DEF) * 1024;
+    total_bytes = total_vivos = 0;
+    generacion++;
+
+    uint32_t *numeros;
+    long n = listar_segmentos(ARCHIVO_SEG, &numeros);
+    if (n < 0) {
+        log_msg("log: no se pudieron listar los segmentos de %s", ARCHIVO_SEG);
+        return -1;
+    }
+    for (long i = 0; i < n; i++) {
+        SegmentoLog *s = mapear_segmento(numeros[i], 0);
+        if (!s || agregar_segmento(s) != 0) {
+            if (s) liberar_segmento(s);
+            free(numeros);
+            dblog_cerrar();
+            return -1;
+        }
+        cargar_segmento(s, i == n - 1);
+    }
+    free(numeros);
+    abierto = 1;
+
+    if (n == 0) {
+        if (!nuevo_segmento()) {
+            dblog_cerrar();
+            return -1;
+        }
+        if (csv_import && access(csv_import, F_OK) == 0) {
+            int importados = dblog_importar_csv(csv_import);
+            log_msg("log: importados %d registros desde %s", importados, csv_import);
+        }
+        dblog_sincronizar();
+    }
+    log_msg("log: %s abierto (%zu segmento(s), %zu registros, %zu KB, %zu KB de basura)",
+            ARCHIVO_SEG, n_segs, idx.vivas, total_bytes / 1024, (total_bytes - total_vivos) / 1024);
+    return 0;
+}
+
+void dblog_cerrar(void) {
+    if (abierto) dblog_sincronizar();
+    for (size_t i = 0; i < n_segs; i++) liberar_segmento(segs[i]);
+    free(segs);
+    free(filas);
+    segs = NULL;
+    filas = NULL;
+    n_segs = cap_segs = 0;
+    n_filas = cap_filas = n_borradas = 0;
+    total_bytes = total_vivos = 0;
+    indice_liberar(&idx);
+    abierto = 0;
+}
+
+int dblog_eliminar_segmentos(const char *prefijo) {
+    uint32_t *numeros;
+    long n = listar_segmentos(prefijo, &numeros);
+    if (n < 0) return -1;
+    int r = 0;
+    for (long i = 0; i < n; i++) {
+        char ruta[600];
+        snprintf(ruta, sizeof(ruta), "%s.%06u", prefijo, numeros[i]);
+        if (unlink(ruta) != 0 && errno != ENOENT) r = -1;
+    }
+    free(numeros);
+    return r;
+}
+
+const char *dblog_buscar_id(int id) {
+    int32_t pos = indice_buscar(&idx, id);
+    return pos >= 0 ? linea_de(filas[pos].seg, filas[pos].off) : NULL;
+}
+
+int dblog_poner(int id, const char *linea) {
+    if (!abierto || id <= 0) return -1;
+    size_t n = strcspn(linea, "\r\n");
+    uint32_t largo = (uint32_t)n + 2;
+    size_t tam = tam_reg(largo);
+    if (largo > REG_MAX) return -1;
+    char reg[sizeof(CabeceraRegLog) + REG_MAX + 8];
+    CabeceraRegLog *h = (CabeceraRegLog *)reg;
+    char *dst = reg + sizeof(CabeceraRegLog);
+    memcpy(dst, linea, n);
+    dst[n] = '\n';
+    dst[n + 1] = '\0';
+    memset(dst + largo, 0, tam - sizeof(CabeceraRegLog) - largo);
+    h->magia = REG_MAGIA;
+    h->id = id;
+    h->largo = largo;
+    h->suma = suma_reg(id, largo, dst);
+
+    uint32_t off;
+    SegmentoLog *s = escribir(reg, tam, &off);
+    return s ? indexar(s, off) : -1;
+}
+
+int dblog_borrar(int id) {
+    if (!abierto || indice_buscar(&idx, id) < 0) return -1;
+    CabeceraRegLog h = { REG_MAGIA, suma_reg(id, 0, NULL), id, 0 };
+    uint32_t off;
+    SegmentoLog *s = escribir(&h, sizeof(h), &off);
+    return s ? indexar(s, off) : -1;
+}
+
+void dblog_recorrer(int (*fn)(int id, const char *linea, void *ctx), void *ctx) {
+    for (size_t i = 0; i < n_filas; i++) {
+        if (filas[i].seg && fn(filas[i].id, linea_de(filas[i].seg, filas[i].off), ctx) != 0) break;
+    }
+}
+
+int dblog_sincronizar(void) {
+    int r = 0;
+    for (size_t i = 0; i < n_segs; i++) {
+        if (!segs[i]->sucio) continue;
+        if (fdatasync(segs[i]->fd) != 0) {
+            log_msg("log: fdatasync del segmento %u falló: %s", segs[i]->numero, strerror(errno));
+            r = -1;
+            continue;
+        }
+        segs[i]->sucio = 0;
+    }
+    return r;
+}
+
+// ====== Compactación ======
+// Basura que se recupera al compactar s: las lápidas solo se pueden tirar en
+// el segmento más viejo (en otro todavía pueden tapar una versión anterior)
+static size_t basura_recuperable(size_t i) {
+    const SegmentoLog *s = segs[i];
+    size_t datos = s->fin - sizeof(CabeceraSegLog);
+    size_t basura = datos - s->vivos;
+    if (i > 0) basura = basura > s->lapidas ? basura - s->lapidas : 0;
+    return basura;
+}
+
+int dblog_elegir(int pct, CompactacionLog *c) {
+    if (!abierto || pct <= 0 || n_segs == 0) return 0;
+    size_t minimo = tam_segmento / 4 < BASURA_MIN ? tam_segmento / 4 : BASURA_MIN;
+    size_t elegido = n_segs, mayor = 0;
+    for (size_t i = 0; i < n_segs; i++) {
+        size_t datos = segs[i]->fin - sizeof(CabeceraSegLog);
+        size_t basura = basura_recuperable(i);
+        if (basura < minimo || basura * 100 < (size_t)pct * datos) continue;
+        if (basura > mayor) {
+            mayor = basura;
+            elegido = i;
+        }
+    }
+    if (elegido == n_segs) return 0;
+    // el activo se sella: lo vigente se copia a uno nuevo
+    if (elegido == n_segs - 1 && !nuevo_segmento()) return 0;
+    c->numero = segs[elegido]->numero;
+    c->generacion = generacion;
+    c->pos = sizeof(CabeceraSegLog);
+    c->copiados = 0;
+    return 1;
+}
+
+int dblog_compactar(CompactacionLog *c, size_t max_regs) {
+    if (!abierto || c->generacion != generacion) return -1;
+    SegmentoLog *s = buscar_segmento(c->numero);
+    if (!s) return -1;
+    int hay_mas_viejos = segs[0] != s;
+    for (size_t n = 0; c->pos < s->fin && n < max_regs; n++) {
+        uint32_t off = (uint32_t)c->pos;
+        const CabeceraRegLog *h = registro(s, off);
+        size_t tam = tam_reg(h->largo);
+        c->pos += tam;
+        int32_t pos = indice_buscar(&idx, h->id);
+        int vigente = h->largo ? (pos >= 0 && filas[pos].seg == s && filas[pos].off == off)
+                               : (pos < 0 && hay_mas_viejos);
+        if (!vigente) continue;
+        uint32_t nuevo;
+        SegmentoLog *d = escribir(h, tam, &nuevo); // el registro se copia tal cual
+        if (!d || indexar(d, nuevo) != 0) return -1;
+        c->copiados += tam;
+    }
+    return c->pos < s->fin ? 1 : 0;
+}
+
+int dblog_retirar(const CompactacionLog *c) {
+    if (!abierto || c->generacion != generacion) return -1;
+    SegmentoLog *s = buscar_segmento(c->numero);
+    if (!s || s == segs[n_segs - 1]) return -1;
+    if (s->vivos != 0) {
+        log_msg("log: el segmento %u todavía tiene %zu bytes vigentes, no se borra", s->numero, s->vivos);
+        return -1;
+    }
+    // lo copiado tiene que estar en disco antes de borrar el original
+    if (dblog_sincronizar() != 0) return -1;
+    char ruta[600];
+    ruta_segmento(s->numero, ruta, sizeof(ruta));
+    if (unlink(ruta) != 0) {
+        log_msg("log: no se pudo borrar %s: %s", ruta, strerror(errno));
+        return -1;
+    }
+    sincronizar_directorio();
+    size_t i = 0;
+    while (segs[i] != s) i++;
+    memmove(&segs[i], &segs[i + 1], (n_segs - i - 1) * sizeof(SegmentoLog *));
+    n_segs--;
+    total_bytes -= s->fin;
+    liberar_segmento(s);
+    return 0;
+}
+
+void dblog_estadisticas(size_t *segmentos, size_t *filas_vivas, size_t *bytes, size_t *basura) {
+    size_t total = total_bytes, vivos = total_vivos;
+    if (segmentos) *segmentos = n_segs;
+    if (filas_vivas) *filas_vivas = idx.vivas;
+    if (bytes) *bytes = total;
+    if (basura) *basura = total > vivos ? total - vivos : 0;
+}
+
+// ====== Compatibilidad CSV ======
+int dblog_importar_csv(const char *csv_path) {
+    FILE *f = fopen(csv_path, "r");
+    if (!f) return -1;
+    char linea[2048];
+    int n = 0;
+    Producto p;
+    while (fgets(linea, sizeof(linea), f)) {
+        if (parsear_producto(linea, &p) != 0) continue; // encabezado, comentarios, #MISSING
+        if (p.id > 0 && indice_buscar(&idx, p.id) < 0 && dblog_poner(p.id, linea) == 0) n++;
+        else log_msg("log: registro %d duplicado o inválido al importar, omitido", p.id);
+    }
+    fclose(f);
+    return n;
+}
+
+int dblog_exportar_csv(const char *csv_path) {
+    if (!abierto) return -1;
+    char tmp[600];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", csv_path);
+    FILE *f = fopen(tmp, "w");
+    if (!f) return -1;
+    for (size_t i = 0; i < n_filas; i++) {
+        if (filas[i].seg) fputs(linea_de(filas[i].seg, filas[i].off), f);
+    }
+    if (fclose(f) != 0 || rename(tmp, csv_path) != 0) {
+        log_msg("log: error exportando a %s: %s", csv_path, strerror(errno));
+        remove(tmp);
+        return -1;
+    }
+    return 0;
+}
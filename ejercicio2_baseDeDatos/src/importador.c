@@ -0,0 +1,82 @@
+// importador.c — carga masiva sin servidor.
+// Valida la salida de ejercicio1_productos (o un archivo del motor binario)
+// con importar_snapshot y deja el resultado como snapshot de la base. El WAL,
+// el checkpoint, el archivo binario y los segmentos del motor de log de esa
+// base son de la tabla anterior:
+// se eliminan para que el próximo arranque cargue solo el snapshot nuevo.
+// Con el servidor corriendo usar el comando IMPORTAR en su lugar.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <getopt.h>
+#include "importar.h"
+#include "db_log.h"
+
+static void uso(const char *prog) {
+    fprintf(stderr,
+        "Uso: %s [opciones] origen\n"
+        "  origen         CSV de ejercicio1_productos o archivo .bin del motor binario\n"
+        "  -d archivo     snapshot CSV a generar (data/productos.csv)\n"
+        "  -t hilos       hilos de validación (0 = uno por CPU)\n",
+        prog);
+}
+
+// Ruta hermana del CSV con otra extensión (data/productos.csv -> data/productos.wal)
+static void ruta_derivada(const char *csv, const char *ext, char *dst, size_t size) {
+    size_t largo_ext = strlen(ext);
+    strncpy(dst, csv, size - largo_ext - 1);
+    dst[size - largo_ext - 1] = '\0';
+    char *punto = strrchr(dst, '.');
+    if (punto && !strchr(punto, '/')) *punto = '\0';
+    strcat(dst, ext);
+}
+
+int main(int argc, char *argv[]) {
+    char destino[512] = "data/productos.csv";
+    int opt;
+    while ((opt = getopt(argc, argv, "d:t:h")) != -1) {
+        switch (opt) {
+            case 'd': strncpy(destino, optarg, sizeof(destino) - 1); break;
+            case 't': IMPORTAR_HILOS = atoi(optarg); break;
+            default: uso(argv[0]); return 1;
+        }
+    }
+    if (optind != argc - 1) {
+        uso(argv[0]);
+        return 1;
+    }
+    const char *origen = argv[optind];
+
+    ResultadoImportar r;
+    if (importar_snapshot(origen, destino, &r) != 0) {
+        fprintf(stderr, "❌ %s\n", r.error);
+        return 1;
+    }
+
+    static const char *derivados[] = { ".wal", ".ckpt", ".bin" };
+    for (size_t i = 0; i < sizeof(derivados) / sizeof(derivados[0]); i++) {
+        char ruta[600];
+        ruta_derivada(destino, derivados[i], ruta, sizeof(ruta));
+        if (unlink(ruta) == 0) {
+            printf("🗑️  %s eliminado (era de la tabla anterior)\n", ruta);
+        } else if (errno != ENOENT) {
+            fprintf(stderr, "⚠️  No se pudo eliminar %s: %s\n", ruta, strerror(errno));
+        }
+    }
+    char prefijo[600];
+    ruta_derivada(destino, ".seg", prefijo, sizeof(prefijo));
+    if (dblog_eliminar_segmentos(prefijo) != 0)
+        fprintf(stderr, "⚠️  No se pudieron eliminar los segmentos %s.*\n", prefijo);
+
+    printf("✅ %s -> %s (%s)\n", origen, destino, r.binario ? "binario" : "CSV");
+    printf("   filas:       %ld\n", r.filas);
+    printf("   inválidas:   %ld\n", r.invalidas);
+    printf("   duplicadas:  %ld\n", r.duplicadas);
+    printf("   hilos:       %d\n", r.hilos);
+    printf("   validación:  %.1f ms\n", r.ms_lectura);
+    printf("   total:       %.1f ms\n", r.ms_total);
+    return 0;
+}
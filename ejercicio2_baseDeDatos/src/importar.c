@@ -0,0 +1,335 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <libgen.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "importar.h"
+#include "db.h"
+#include "db_bin.h"
+#include "indice.h"
+#include "parser_csv.h"
+#include "utils.h"
+
+#define LINEA_MAX   2048
+#define BUFFER_SALIDA (1024 * 1024)
+
+int IMPORTAR_HILOS = 0;
+
+// Fila válida: desplazamiento desde la base del texto, largo sin '\n'
+typedef struct {
+    uint64_t desde;
+    uint32_t largo;
+    int32_t id;
+} FilaImp;
+
+// Tramo del origen que valida un hilo (empieza y termina en un borde de línea)
+typedef struct {
+    const char *base, *ini, *fin;
+    FilaImp *filas;
+    size_t n, cap;
+    long invalidas;
+    int error;
+} TramoImp;
+
+static double ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static int agregar_fila(FilaImp **filas, size_t *n, size_t *cap, uint64_t desde, size_t largo, int id) {
+    if (*n == *cap) {
+        size_t nueva = *cap ? *cap * 2 : 4096;
+        FilaImp *f = realloc(*filas, nueva * sizeof(FilaImp));
+        if (!f) return -1;
+        *filas = f;
+        *cap = nueva;
+    }
+    (*filas)[*n].desde = desde;
+    (*filas)[*n].largo = (uint32_t)largo;
+    (*filas)[*n].id = id;
+    (*n)++;
+    return 0;
+}
+
+// Valida las líneas sobre el archivo mapeado, sin copiarlas: csv_separar
+// encuentra comas y fin de línea en una sola pasada
+static void *validar_tramo(void *arg) {
+    TramoImp *t = arg;
+    const char *p = t->ini;
+    while (p < t->fin) {
+        CamposCsv c;
+        Producto prod;
+        const char *fin_linea = t->fin;
+        int completa = 0;
+        if (csv_separar(p, t->fin, &c) >= 0) {
+            fin_linea = c.fin;
+            if (fin_linea < t->fin - 1 && fin_linea[0] == '\r' && fin_linea[1] == '\n') fin_linea++; // CRLF
+            completa = fin_linea == t->fin || *fin_linea == '\n';
+        }
+        if (!completa) {
+            // demasiados campos o un '\r'/'\0' suelto: la línea sigue hasta el '\n'
+            const char *nl = memchr(p, '\n', (size_t)(t->fin - p));
+            fin_linea = nl ? nl : t->fin;
+        }
+        size_t largo = completa ? (size_t)(c.fin - p) : 0;
+
+        if (completa && largo == 0) {
+            // línea vacía: no cuenta
+        } else if (completa && p == t->base && c.largo[0] == 2 && memcmp(p, "ID", 2) == 0) {
+            // encabezado del generador
+        } else if (!completa || csv_campos_producto(&c, &prod) != 0) {
+            t->invalidas++;
+        } else if (agregar_fila(&t->filas, &t->n, &t->cap, (uint64_t)(p - t->base), largo, prod.id) != 0) {
+            t->error = 1;
+            return NULL;
+        }
+        p = fin_linea + 1;
+    }
+    return NULL;
+}
+
+static int hilos_para(size_t tam) {
+    int hilos = IMPORTAR_HILOS;
+    if (hilos <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        hilos = cpus > 0 ? (int)cpus : 1;
+    }
+    if (hilos > IMPORTAR_HILOS_MAX) hilos = IMPORTAR_HILOS_MAX;
+    size_t por_tamano = tam / IMPORTAR_TRAMO_MIN + 1;
+    if ((size_t)hilos > por_tamano) hilos = (int)por_tamano;
+    return hilos;
+}
+
+// Valida un CSV mapeado repartiendo tramos entre hilos
+static int validar_csv(const char *base, size_t tam, TramoImp *tramos, int *n_tramos) {
+    int hilos = hilos_para(tam);
+    const char *fin = base + tam;
+    const char *p = base;
+    *n_tramos = 0;
+    for (int i = 0; i < hilos && p < fin; i++) {
+        const char *corte = fin;
+        if (i < hilos - 1) {
+            const char *desde = base + tam / hilos * (i + 1);
+            if (desde < p) desde = p;
+            const char *nl = memchr(desde, '\n', (size_t)(fin - desde));
+            corte = nl ? nl + 1 : fin;
+        }
+        if (corte <= p) continue;
+        memset(&tramos[*n_tramos], 0, sizeof(TramoImp));
+        tramos[*n_tramos].base = base;
+        tramos[*n_tramos].ini = p;
+        tramos[*n_tramos].fin = corte;
+        (*n_tramos)++;
+        p = corte;
+    }
+
+    pthread_t ids[IMPORTAR_HILOS_MAX];
+    int lanzados = 0;
+    for (int i = 1; i < *n_tramos; i++) {
+        if (pthread_create(&ids[i], NULL, validar_tramo, &tramos[i]) != 0) break;
+        lanzados = i;
+    }
+    if (*n_tramos > 0) validar_tramo(&tramos[0]);
+    for (int i = lanzados + 1; i < *n_tramos; i++) validar_tramo(&tramos[i]); // sin hilo
+    for (int i = 1; i <= lanzados; i++) pthread_join(ids[i], NULL);
+
+    for (int i = 0; i < *n_tramos; i++) {
+        if (tramos[i].error) return -1;
+    }
+    return 0;
+}
+
+// Archivo del motor binario: los registros ya están tipados, solo se
+// formatean a un texto propio (un único tramo)
+static int leer_binario(const char *base, size_t tam, TramoImp *t, char **texto, char *error, size_t error_tam) {
+    const CabeceraBin *cab = (const CabeceraBin *)base;
+    if (cab->version != BIN_VERSION || cab->tam_registro != sizeof(RegistroBin) ||
+        sizeof(CabeceraBin) + (size_t)cab->usados * sizeof(RegistroBin) > tam) {
+        snprintf(error, error_tam, "archivo binario con cabecera inválida");
+        return -1;
+    }
+    const RegistroBin *regs = (const RegistroBin *)(base + sizeof(CabeceraBin));
+    size_t cap = (size_t)cab->vivos * 48 + 1;
+    size_t len = 0;
+    char *buf = malloc(cap);
+    if (!buf) {
+        snprintf(error, error_tam, "sin memoria");
+        return -1;
+    }
+    memset(t, 0, sizeof(*t));
+    for (uint32_t i = 0; i < cab->usados; i++) {
+        if (!regs[i].ocupado) continue;
+        const Producto *p = &regs[i].p;
+        if (p->id <= 0 || !memchr(p->descripcion, '\0', DESC_MAX) ||
+            !memchr(p->fecha, '\0', FECHA_MAX) || !memchr(p->hora, '\0', HORA_MAX)) {
+            t->invalidas++;
+            continue;
+        }
+        if (cap - len < LINEA_MAX) {
+            char *b = realloc(buf, cap * 2);
+            if (!b) {
+                free(buf);
+                free(t->filas);
+                snprintf(error, error_tam, "sin memoria");
+                return -1;
+            }
+            buf = b;
+            cap *= 2;
+        }
+        int n = formatear_producto(p, buf + len, cap - len);
+        if (agregar_fila(&t->filas, &t->n, &t->cap, len, (size_t)n - 1, p->id) != 0) {
+            free(buf);
+            free(t->filas);
+            snprintf(error, error_tam, "sin memoria");
+            return -1;
+        }
+        len += (size_t)n;
+    }
+    *texto = buf;
+    t->base = buf;
+    return 0;
+}
+
+// Marca con id 0 las filas cuyo ID ya apareció antes. Devuelve cuántas o -1.
+static long descartar_duplicados(TramoImp *tramos, int n_tramos) {
+    size_t total = 0;
+    for (int i = 0; i < n_tramos; i++) total += tramos[i].n;
+    IndiceId vistos;
+    indice_iniciar(&vistos);
+    if (indice_reservar(&vistos, total) != 0) return -1;
+    long duplicadas = 0;
+    for (int i = 0; i < n_tramos; i++) {
+        for (size_t j = 0; j < tramos[i].n; j++) {
+            int id = tramos[i].filas[j].id;
+            if (indice_buscar(&vistos, id) >= 0) {
+                tramos[i].filas[j].id = 0;
+                duplicadas++;
+            } else if (indice_poner(&vistos, id, 0) != 0) {
+                indice_liberar(&vistos);
+                return -1;
+            }
+        }
+    }
+    indice_liberar(&vistos);
+    return duplicadas;
+}
+
+// fsync del directorio que contiene path (hace durable el rename)
+static void sincronizar_directorio(const char *path) {
+    char copia[512];
+    strncpy(copia, path, sizeof(copia) - 1);
+    copia[sizeof(copia) - 1] = '\0';
+    int fd = open(dirname(copia), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+static int escribir_snapshot(const char *destino, const TramoImp *tramos, int n_tramos, long *filas) {
+    char tmp[600];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", destino);
+    FILE *f = fopen(tmp, "w");
+    if (!f) return -1;
+    setvbuf(f, NULL, _IOFBF, BUFFER_SALIDA);
+    *filas = 0;
+    for (int i = 0; i < n_tramos; i++) {
+        for (size_t j = 0; j < tramos[i].n; j++) {
+            const FilaImp *fila = &tramos[i].filas[j];
+            if (fila->id == 0) continue; // duplicada
+            fwrite(tramos[i].base + fila->desde, 1, fila->largo, f);
+            putc('\n', f);
+            (*filas)++;
+        }
+    }
+    int ok = fflush(f) == 0 && fsync(fileno(f)) == 0;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp, destino) != 0) {
+        remove(tmp);
+        return -1;
+    }
+    sincronizar_directorio(destino);
+    return 0;
+}
+
+int importar_snapshot(const char *origen, const char *destino, ResultadoImportar *r) {
+    memset(r, 0, sizeof(*r));
+    double inicio = ahora_ms();
+
+    int fd = open(origen, O_RDONLY);
+    if (fd < 0) {
+        snprintf(r->error, sizeof(r->error), "no se pudo abrir %s: %s", origen, strerror(errno));
+        log_msg("Importar: %s", r->error);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        snprintf(r->error, sizeof(r->error), "%s no es un archivo regular", origen);
+        log_msg("Importar: %s", r->error);
+        return -1;
+    }
+    size_t tam = (size_t)st.st_size;
+    const char *base = NULL;
+    if (tam > 0) {
+        base = mmap(NULL, tam, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED) {
+            close(fd);
+            snprintf(r->error, sizeof(r->error), "no se pudo mapear %s: %s", origen, strerror(errno));
+            log_msg("Importar: %s", r->error);
+            return -1;
+        }
+        madvise((void *)base, tam, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    TramoImp tramos[IMPORTAR_HILOS_MAX];
+    int n_tramos = 0;
+    char *texto = NULL;
+    int res = 0;
+    r->binario = tam >= sizeof(CabeceraBin) && ((const CabeceraBin *)base)->magic == BIN_MAGIC;
+    if (r->binario) {
+        res = leer_binario(base, tam, &tramos[0], &texto, r->error, sizeof(r->error));
+        n_tramos = res == 0 ? 1 : 0;
+    } else if (tam > 0 && validar_csv(base, tam, tramos, &n_tramos) != 0) {
+        snprintf(r->error, sizeof(r->error), "sin memoria validando %s", origen);
+        res = -1;
+    }
+    r->hilos = n_tramos;
+
+    if (res == 0) {
+        for (int i = 0; i < n_tramos; i++) r->invalidas += tramos[i].invalidas;
+        r->duplicadas = descartar_duplicados(tramos, n_tramos);
+        if (r->duplicadas < 0) {
+            snprintf(r->error, sizeof(r->error), "sin memoria descartando duplicados");
+            res = -1;
+        }
+    }
+    r->ms_lectura = ahora_ms() - inicio;
+
+    if (res == 0 && escribir_snapshot(destino, tramos, n_tramos, &r->filas) != 0) {
+        snprintf(r->error, sizeof(r->error), "no se pudo escribir %s: %s", destino, strerror(errno));
+        res = -1;
+    }
+    for (int i = 0; i < n_tramos; i++) free(tramos[i].filas);
+    free(texto);
+    if (base) munmap((void *)base, tam);
+
+    r->ms_total = ahora_ms() - inicio;
+    if (res != 0) {
+        log_msg("Importar: %s", r->error);
+        return -1;
+    }
+    log_msg("Importar: %s -> %s en %.1f ms (lectura %.1f ms, %d hilo(s)): "
+            "%ld filas, %ld inválidas, %ld duplicadas",
+            origen, destino, r->ms_total, r->ms_lectura, r->hilos,
+            r->filas, r->invalidas, r->duplicadas);
+    return 0;
+}
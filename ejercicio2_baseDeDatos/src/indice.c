@@ -0,0 +1,104 @@
+#include <stdlib.h>
+#include <string.h>
+#include "indice.h"
+
+#define IDX_VACIO   0
+#define IDX_BORRADO (-1)
+#define CAP_INICIAL 64
+
+static size_t hash_id(int id) {
+    uint32_t x = (uint32_t)id;
+    x ^= x >> 16; x *= 0x7feb352dU;
+    x ^= x >> 15; x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+void indice_iniciar(IndiceId *ix) {
+    ix->t = NULL;
+    ix->cap = ix->usadas = ix->vivas = 0;
+}
+
+void indice_liberar(IndiceId *ix) {
+    free(ix->t);
+    indice_iniciar(ix);
+}
+
+void indice_vaciar(IndiceId *ix) {
+    if (ix->t) memset(ix->t, 0, ix->cap * sizeof(EntradaIdx));
+    ix->usadas = ix->vivas = 0;
+}
+
+static int redimensionar(IndiceId *ix, size_t nueva_cap) {
+    EntradaIdx *nuevo = calloc(nueva_cap, sizeof(EntradaIdx));
+    if (!nuevo) return -1;
+    size_t n = 0;
+    for (size_t i = 0; i < ix->cap; i++) {
+        if (ix->t[i].id <= 0) continue;
+        size_t j = hash_id(ix->t[i].id) & (nueva_cap - 1);
+        while (nuevo[j].id != IDX_VACIO) j = (j + 1) & (nueva_cap - 1);
+        nuevo[j] = ix->t[i];
+        n++;
+    }
+    free(ix->t);
+    ix->t = nuevo;
+    ix->cap = nueva_cap;
+    ix->usadas = ix->vivas = n;
+    return 0;
+}
+
+int indice_reservar(IndiceId *ix, size_t n) {
+    size_t cap = ix->cap ? ix->cap : CAP_INICIAL;
+    while (n * 10 >= cap * 5) cap *= 2;
+    if (cap == ix->cap) return 0;
+    return redimensionar(ix, cap);
+}
+
+int32_t indice_buscar(const IndiceId *ix, int id) {
+    if (!ix->t || id <= 0) return -1;
+    size_t j = hash_id(id) & (ix->cap - 1);
+    while (ix->t[j].id != IDX_VACIO) {
+        if (ix->t[j].id == id) return ix->t[j].pos;
+        j = (j + 1) & (ix->cap - 1);
+    }
+    return -1;
+}
+
+int indice_poner(IndiceId *ix, int id, int32_t pos) {
+    if (id <= 0) return 0;
+    if (!ix->t || (ix->usadas + 1) * 10 >= ix->cap * 7) {
+        // si sobran borrados basta con rehacer la tabla del mismo tamaño
+        size_t nueva = ix->cap ? ix->cap : CAP_INICIAL;
+        if ((ix->vivas + 1) * 10 >= nueva * 5) nueva *= 2;
+        if (redimensionar(ix, nueva) != 0) return -1;
+    }
+    size_t j = hash_id(id) & (ix->cap - 1);
+    size_t hueco = (size_t)-1;
+    while (ix->t[j].id != IDX_VACIO) {
+        if (ix->t[j].id == id) { ix->t[j].pos = pos; return 0; }
+        if (ix->t[j].id == IDX_BORRADO && hueco == (size_t)-1) hueco = j;
+        j = (j + 1) & (ix->cap - 1);
+    }
+    if (hueco != (size_t)-1) {
+        j = hueco;
+    } else {
+        ix->usadas++;
+    }
+    ix->t[j].id = id;
+    ix->t[j].pos = pos;
+    ix->vivas++;
+    return 0;
+}
+
+void indice_borrar(IndiceId *ix, int id) {
+    if (!ix->t || id <= 0) return;
+    size_t j = hash_id(id) & (ix->cap - 1);
+    while (ix->t[j].id != IDX_VACIO) {
+        if (ix->t[j].id == id) {
+            ix->t[j].id = IDX_BORRADO;
+            ix->vivas--;
+            return;
+        }
+        j = (j + 1) & (ix->cap - 1);
+    }
+}
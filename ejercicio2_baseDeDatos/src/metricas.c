@@ -0,0 +1,282 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "metricas.h"
+#include "bloqueos.h"
+#include "wal.h"
+#include "pool.h"
+#include "admision.h"
+#include "cache.h"
+#include "arena.h"
+#include "db.h"
+#include "db_col.h"
+#include "db_log.h"
+#include "utils.h"
+
+#define SUB_BITS 4
+#define SUB      (1 << SUB_BITS)
+#define CUBETAS  ((64 - SUB_BITS + 1) * SUB)  /* cubre todo uint64_t */
+
+typedef struct {
+    atomic_ullong cubetas[CUBETAS];
+    atomic_ullong n;
+    atomic_ullong suma;
+    atomic_ullong max;
+} Histograma;
+
+static const char *nombres[MET_TOTAL] = {
+    "MOSTRAR", "BUSCAR", "FILTRO", "AGREGAR", "MODIFICAR", "ELIMINAR",
+    "BEGIN", "COMMIT", "ROLLBACK", "STATS", "OTRO",
+    "espera_particion", "espera_fila", "espera_admision"
+};
+
+int METRICAS_INTERVALO_S = METRICAS_INTERVALO_S_DEF;
+
+static Histograma histogramas[MET_TOTAL];
+static atomic_llong conexiones_activas = 0;
+static atomic_ullong conexiones_aceptadas = 0;
+static atomic_ullong conexiones_rechazadas = 0;
+static atomic_ullong bytes_entrada = 0;
+static time_t inicio = 0;
+
+static pthread_mutex_t mutex_hilo = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_hilo = PTHREAD_COND_INITIALIZER;
+static pthread_t hilo_metricas;
+static int hilo_activo = 0;
+static int detener = 0;
+
+uint64_t metricas_ahora_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+Metrica metrica_de_comando(const char *cmd) {
+    for (int m = MET_MOSTRAR; m < MET_OTRO; m++) {
+        if (strcmp(cmd, nombres[m]) == 0) return (Metrica)m;
+    }
+    return MET_OTRO;
+}
+
+const char *metricas_nombre(Metrica m) {
+    return (m >= 0 && m < MET_TOTAL) ? nombres[m] : "?";
+}
+
+// Valores < SUB van a su propia cubeta; el resto, SUB sub-cubetas por potencia de 2
+static int cubeta_de(uint64_t v) {
+    if (v < SUB) return (int)v;
+    int e = 63 - __builtin_clzll(v);
+    int sub = (int)((v >> (e - SUB_BITS)) & (SUB - 1));
+    return (e - SUB_BITS + 1) * SUB + sub;
+}
+
+// Punto medio del rango de valores de una cubeta
+static uint64_t valor_de(int c) {
+    if (c < SUB) return (uint64_t)c;
+    int e = c / SUB + SUB_BITS - 1;
+    uint64_t ancho = 1ULL << (e - SUB_BITS);
+    return ((uint64_t)(SUB + c % SUB) << (e - SUB_BITS)) + ancho / 2;
+}
+
+void metricas_registrar(Metrica m, uint64_t ns) {
+    if (m < 0 || m >= MET_TOTAL) return;
+    Histograma *h = &histogramas[m];
+    atomic_fetch_add_explicit(&h->cubetas[cubeta_de(ns)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->n, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->suma, ns, memory_order_relaxed);
+    unsigned long long max = atomic_load_explicit(&h->max, memory_order_relaxed);
+    while (ns > max && !atomic_compare_exchange_weak(&h->max, &max, ns))
+        ;
+}
+
+void metricas_conexion_abierta() {
+    atomic_fetch_add(&conexiones_activas, 1);
+    atomic_fetch_add(&conexiones_aceptadas, 1);
+}
+
+void metricas_conexion_cerrada() {
+    atomic_fetch_sub(&conexiones_activas, 1);
+}
+
+void metricas_conexion_rechazada() {
+    atomic_fetch_add(&conexiones_rechazadas, 1);
+}
+
+void metricas_bytes_recibidos(size_t n) {
+    atomic_fetch_add_explicit(&bytes_entrada, n, memory_order_relaxed);
+}
+
+// Percentiles p (0..1) de una copia del histograma, en ns
+static void percentiles(const unsigned long long *cubetas, uint64_t n,
+                        const double *p, uint64_t *res, int k) {
+    uint64_t acumulado = 0;
+    int j = 0;
+    for (int c = 0; c < CUBETAS && j < k; c++) {
+        acumulado += cubetas[c];
+        while (j < k && acumulado > 0 && (double)acumulado >= p[j] * (double)n) {
+            res[j++] = valor_de(c);
+        }
+    }
+    while (j < k) res[j++] = 0;
+}
+
+size_t metricas_formatear(char *buf, size_t size) {
+    size_t len = 0;
+    // Con el buffer lleno no se escribe más: len queda en size - 1 (el '\0')
+#define AGREGAR(...) do { \
+        if (len + 1 >= size) break; \
+        int _n = snprintf(buf + len, size - len, __VA_ARGS__); \
+        if (_n < 0) break; \
+        if ((size_t)_n >= size - len) _n = (int)(size - len - 1); \
+        len += (size_t)_n; \
+    } while (0)
+
+    uint64_t commits = 0, syncs = 0, esperas = 0, abortos = 0, timeouts = 0;
+    wal_estadisticas(&commits, &syncs);
+    bloqueo_estadisticas(&esperas, &abortos, &timeouts);
+    int hilos = 0, ocupados = 0, encolados = 0;
+    pool_estadisticas(&hilos, &ocupados, &encolados);
+    int activos = 0, en_espera = 0, pico = 0;
+    uint64_t tras_espera = 0, vencidos = 0;
+    admision_estadisticas(&activos, &en_espera, &pico, &tras_espera, &vencidos);
+    int entradas = 0;
+    size_t bytes_cache = 0;
+    uint64_t aciertos = 0, fallos = 0, desalojos = 0, invalidadas = 0;
+    cache_estadisticas(&entradas, &bytes_cache, &aciertos, &fallos, &desalojos, &invalidadas);
+    uint64_t arena_asig = 0, arena_bytes = 0, arena_bloques = 0, arena_reservado = 0;
+    arena_estadisticas(&arena_asig, &arena_bytes, &arena_bloques, &arena_reservado);
+
+    AGREGAR("=== STATS (uptime %lds) ===\n", inicio ? (long)(time(NULL) - inicio) : 0L);
+    AGREGAR("conexiones: activas=%lld aceptadas=%llu rechazadas=%llu\n",
+            atomic_load(&conexiones_activas), atomic_load(&conexiones_aceptadas),
+            atomic_load(&conexiones_rechazadas));
+    AGREGAR("pool: hilos=%d ocupados=%d en_cola=%d\n", hilos, ocupados, encolados);
+    AGREGAR("admision: activos=%d en_espera=%d pico_espera=%d admitidos_tras_espera=%llu vencidos=%llu\n",
+            activos, en_espera, pico, (unsigned long long)tras_espera, (unsigned long long)vencidos);
+    AGREGAR("cache: entradas=%d bytes=%zu/%ld aciertos=%llu fallos=%llu desalojos=%llu invalidadas=%llu\n",
+            entradas, bytes_cache, CACHE_MAX, (unsigned long long)aciertos, (unsigned long long)fallos,
+            (unsigned long long)desalojos, (unsigned long long)invalidadas);
+    AGREGAR("arena: asignaciones=%llu bytes=%llu bloques_malloc=%llu reservado=%llu\n",
+            (unsigned long long)arena_asig, (unsigned long long)arena_bytes,
+            (unsigned long long)arena_bloques, (unsigned long long)arena_reservado);
+    if (MOTOR_DB == MOTOR_COL) {
+        size_t filas = 0, bytes_col = 0, bytes_heap = 0;
+        col_estadisticas(&filas, &bytes_col, &bytes_heap);
+        AGREGAR("col: filas=%zu bytes_columnas=%zu bytes_cadenas=%zu\n", filas, bytes_col, bytes_heap);
+    }
+    if (MOTOR_DB == MOTOR_LOG) {
+        size_t segmentos = 0, filas = 0, bytes_seg = 0, basura = 0;
+        dblog_estadisticas(&segmentos, &filas, &bytes_seg, &basura);
+        AGREGAR("log: segmentos=%zu filas=%zu bytes=%zu basura=%zu\n", segmentos, filas, bytes_seg, basura);
+    }
+    AGREGAR("bytes: enviados=%llu recibidos=%llu\n",
+            (unsigned long long)total_bytes_enviados(), atomic_load(&bytes_entrada));
+    uint64_t bloques, originales, comprimidos;
+    compresion_estadisticas(&bloques, &originales, &comprimidos);
+    AGREGAR("compresion: bloques=%llu originales=%llu comprimidos=%llu\n",
+            (unsigned long long)bloques, (unsigned long long)originales,
+            (unsigned long long)comprimidos);
+    AGREGAR("wal: commits=%llu fdatasync=%llu\n",
+            (unsigned long long)commits, (unsigned long long)syncs);
+    AGREGAR("bloqueos_fila: esperas=%llu abortos=%llu timeouts=%llu\n",
+            (unsigned long long)esperas, (unsigned long long)abortos, (unsigned long long)timeouts);
+    AGREGAR("%-15s %10s %10s %10s %10s %10s %10s\n",
+            "metrica", "n", "media_us", "p50_us", "p99_us", "p999_us", "max_us");
+
+    static const double p[3] = { 0.50, 0.99, 0.999 };
+    unsigned long long copia[CUBETAS];
+    for (int m = 0; m < MET_TOTAL; m++) {
+        Histograma *h = &histogramas[m];
+        uint64_t n = 0;
+        for (int c = 0; c < CUBETAS; c++) {
+            copia[c] = atomic_load_explicit(&h->cubetas[c], memory_order_relaxed);
+            n += copia[c];
+        }
+        if (n == 0) continue;
+        uint64_t res[3];
+        percentiles(copia, n, p, res, 3);
+        uint64_t max = atomic_load(&h->max);
+        for (int j = 0; j < 3; j++) if (res[j] > max) res[j] = max; // el punto medio puede pasarse
+        double media = (double)atomic_load(&h->suma) / (double)atomic_load(&h->n);
+        AGREGAR("%-15s %10llu %10.1f %10.1f %10.1f %10.1f %10.1f\n", nombres[m],
+                (unsigned long long)n, media / 1000.0, res[0] / 1000.0, res[1] / 1000.0,
+                res[2] / 1000.0, max / 1000.0);
+    }
+#undef AGREGAR
+    return len;
+}
+
+static void *hilo_volcado(void *arg) {
+    (void)arg;
+    // las señales las atiende el hilo principal
+    sigset_t set;
+    sigfillset(&set);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    char *reporte = malloc(16384);
+    if (!reporte) return NULL;
+    pthread_mutex_lock(&mutex_hilo);
+    while (!detener) {
+        // con intervalo 0 (recarga de la configuración) espera a que cambie
+        if (METRICAS_INTERVALO_S <= 0) {
+            pthread_cond_wait(&cond_hilo, &mutex_hilo);
+            continue;
+        }
+        struct timespec limite;
+        clock_gettime(CLOCK_REALTIME, &limite);
+        limite.tv_sec += METRICAS_INTERVALO_S;
+        if (pthread_cond_timedwait(&cond_hilo, &mutex_hilo, &limite) != ETIMEDOUT) continue;
+        if (detener) break;
+
+        pthread_mutex_unlock(&mutex_hilo);
+        metricas_formatear(reporte, 16384);
+        // una entrada de log por línea (el log trunca entradas largas)
+        char *resto = NULL;
+        for (char *linea = strtok_r(reporte, "\n", &resto); linea; linea = strtok_r(NULL, "\n", &resto)) {
+            log_msg("%s", linea);
+        }
+        pthread_mutex_lock(&mutex_hilo);
+    }
+    pthread_mutex_unlock(&mutex_hilo);
+    free(reporte);
+    return NULL;
+}
+
+int metricas_iniciar() {
+    inicio = time(NULL);
+    if (METRICAS_INTERVALO_S <= 0) return 0;
+    return metricas_reconfigurar();
+}
+
+int metricas_reconfigurar() {
+    if (hilo_activo) {
+        // el hilo vuelve a calcular su próximo volcado con el intervalo nuevo
+        pthread_mutex_lock(&mutex_hilo);
+        pthread_cond_signal(&cond_hilo);
+        pthread_mutex_unlock(&mutex_hilo);
+        return 0;
+    }
+    if (METRICAS_INTERVALO_S <= 0) return 0;
+    detener = 0;
+    if (pthread_create(&hilo_metricas, NULL, hilo_volcado, NULL) != 0) {
+        log_msg("Métricas: no se pudo crear el hilo de volcado");
+        return -1;
+    }
+    hilo_activo = 1;
+    return 0;
+}
+
+void metricas_detener() {
+    if (!hilo_activo) return;
+    pthread_mutex_lock(&mutex_hilo);
+    detener = 1;
+    pthread_cond_signal(&cond_hilo);
+    pthread_mutex_unlock(&mutex_hilo);
+    pthread_join(hilo_metricas, NULL);
+    hilo_activo = 0;
+}
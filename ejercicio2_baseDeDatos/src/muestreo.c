@@ -0,0 +1,234 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include "muestreo.h"
+#include "metricas.h"
+#include "utils.h"
+
+int MUESTREO_INTERVALO_S = MUESTREO_INTERVALO_S_DEF;
+
+typedef struct {
+    uint64_t t_ns;
+    int hilos;
+    int fds, sockets;
+    long rss_kb, pico_kb;
+    unsigned long long utime, stime;     /* ticks */
+    unsigned long long fallos_men, fallos_may;
+    unsigned long long ctx_vol, ctx_invol;
+    int tcp_establecidas, tcp_escucha, tcp_close_wait, tcp_otras;
+} Muestra;
+
+static pthread_mutex_t mutex_hilo = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_hilo = PTHREAD_COND_INITIALIZER;
+static pthread_t hilo_muestreo;
+static int hilo_activo = 0;
+static int detener = 0;
+
+// Descriptores que quedan abiertos entre muestras (solo los usa el hilo)
+static int fd_stat = -1, fd_status = -1;
+static long ticks_por_s = 100;
+
+// Lee un archivo de /proc desde el principio. -1 si no se pudo
+static ssize_t leer_proc(int fd, char *buf, size_t size) {
+    ssize_t n = pread(fd, buf, size - 1, 0);
+    if (n < 0) return -1;
+    buf[n] = '\0';
+    return n;
+}
+
+// /proc/self/stat: los campos van después del ")" del nombre (que puede tener espacios)
+static void leer_stat(Muestra *m) {
+    char buf[1024];
+    if (leer_proc(fd_stat, buf, sizeof(buf)) <= 0) return;
+    char *p = strrchr(buf, ')');
+    if (!p) return;
+    // campos 3.. : estado ppid pgrp sesion tty tpgid flags minflt cminflt majflt cmajflt utime stime
+    unsigned long long minflt, majflt, utime, stime;
+    if (sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %llu %*u %llu %*u %llu %llu",
+               &minflt, &majflt, &utime, &stime) == 4) {
+        m->fallos_men = minflt;
+        m->fallos_may = majflt;
+        m->utime = utime;
+        m->stime = stime;
+    }
+}
+
+static const char *campo_status(const char *buf, const char *clave) {
+    const char *p = strstr(buf, clave);
+    return p ? p + strlen(clave) : NULL;
+}
+
+// /proc/self/status: hilos y RSS. Sus cambios de contexto son solo los del
+// hilo principal: los de todo el proceso salen de getrusage
+static void leer_status(Muestra *m) {
+    char buf[4096];
+    if (leer_proc(fd_status, buf, sizeof(buf)) <= 0) return;
+    const char *v;
+    if ((v = campo_status(buf, "\nThreads:"))) m->hilos = atoi(v);
+    if ((v = campo_status(buf, "\nVmRSS:"))) m->rss_kb = atol(v);
+    if ((v = campo_status(buf, "\nVmHWM:"))) m->pico_kb = atol(v);
+    struct rusage uso;
+    if (getrusage(RUSAGE_SELF, &uso) == 0) {
+        m->ctx_vol = (unsigned long long)uso.ru_nvcsw;
+        m->ctx_invol = (unsigned long long)uso.ru_nivcsw;
+    }
+}
+
+// Estado TCP de un socket propio (los que no son TCP no cuentan)
+static void contar_socket(Muestra *m, int fd) {
+    struct tcp_info info;
+    socklen_t largo = sizeof(info);
+    if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &largo) != 0) return;
+    switch (info.tcpi_state) {
+        case TCP_ESTABLISHED: m->tcp_establecidas++; break;
+        case TCP_LISTEN:      m->tcp_escucha++; break;
+        case TCP_CLOSE_WAIT:  m->tcp_close_wait++; break; // el cliente cerró y el servidor todavía no
+        default:              m->tcp_otras++; break;
+    }
+}
+
+// /proc/self/fd: descriptores abiertos, cuántos son sockets y el estado de
+// los TCP. Se mira cada socket con TCP_INFO en vez de leer /proc/net/tcp,
+// que recorre todas las conexiones del sistema (~1 ms)
+static void contar_fds(Muestra *m) {
+    DIR *d = opendir("/proc/self/fd");
+    if (!d) return;
+    int propio = dirfd(d);
+    struct dirent *e;
+    char destino[32];
+    while ((e = readdir(d))) {
+        if (e->d_name[0] == '.') continue;
+        int fd = atoi(e->d_name);
+        if (fd == propio) continue;
+        m->fds++;
+        ssize_t n = readlinkat(propio, e->d_name, destino, sizeof(destino) - 1);
+        if (n > 7 && memcmp(destino, "socket:", 7) == 0) {
+            m->sockets++;
+            contar_socket(m, fd);
+        }
+    }
+    closedir(d);
+}
+
+static void tomar_muestra(Muestra *m) {
+    memset(m, 0, sizeof(*m));
+    m->t_ns = metricas_ahora_ns();
+    leer_stat(m);
+    leer_status(m);
+    contar_fds(m);
+}
+
+static double por_segundo(unsigned long long ahora, unsigned long long antes, double s) {
+    return s > 0 && ahora >= antes ? (double)(ahora - antes) / s : 0;
+}
+
+// Dos entradas de log: proceso y red
+static void registrar(const Muestra *m, const Muestra *ant, uint64_t costo_ns) {
+    double s = ant ? (m->t_ns - ant->t_ns) / 1e9 : 0;
+    double cpu = 0;
+    if (ant && s > 0) {
+        unsigned long long ticks = (m->utime + m->stime) - (ant->utime + ant->stime);
+        cpu = 100.0 * (double)ticks / (double)ticks_por_s / s;
+    }
+    log_msg("muestreo: hilos=%d fds=%d rss_kb=%ld pico_kb=%ld cpu=%.1f%% usr_s=%.2f sis_s=%.2f "
+            "fallos_may=%llu fallos_men/s=%.0f ctx_vol/s=%.0f ctx_invol/s=%.0f",
+            m->hilos, m->fds, m->rss_kb, m->pico_kb, cpu,
+            (double)m->utime / ticks_por_s, (double)m->stime / ticks_por_s, m->fallos_may,
+            ant ? por_segundo(m->fallos_men, ant->fallos_men, s) : 0,
+            ant ? por_segundo(m->ctx_vol, ant->ctx_vol, s) : 0,
+            ant ? por_segundo(m->ctx_invol, ant->ctx_invol, s) : 0);
+    log_msg("muestreo: sockets=%d tcp_establecidas=%d tcp_escucha=%d tcp_close_wait=%d tcp_otras=%d muestra_us=%.0f",
+            m->sockets, m->tcp_establecidas, m->tcp_escucha, m->tcp_close_wait, m->tcp_otras,
+            costo_ns / 1e3);
+}
+
+static void *hilo_muestrear(void *arg) {
+    (void)arg;
+    // las señales las atiende el hilo principal
+    sigset_t set;
+    sigfillset(&set);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    Muestra muestras[2];
+    int actual = 0, hay_anterior = 0, tomar = 1;
+    pthread_mutex_lock(&mutex_hilo);
+    while (!detener) {
+        // con intervalo 0 (recarga de la configuración) espera a que cambie
+        if (MUESTREO_INTERVALO_S <= 0) {
+            pthread_cond_wait(&cond_hilo, &mutex_hilo);
+            hay_anterior = 0;
+            tomar = 1;
+            continue;
+        }
+        if (tomar) {
+            pthread_mutex_unlock(&mutex_hilo);
+            uint64_t inicio = metricas_ahora_ns();
+            tomar_muestra(&muestras[actual]);
+            registrar(&muestras[actual], hay_anterior ? &muestras[actual ^ 1] : NULL,
+                      metricas_ahora_ns() - inicio);
+            hay_anterior = 1;
+            actual ^= 1;
+            tomar = 0;
+            pthread_mutex_lock(&mutex_hilo);
+            continue;
+        }
+        struct timespec limite;
+        clock_gettime(CLOCK_REALTIME, &limite);
+        limite.tv_sec += MUESTREO_INTERVALO_S;
+        if (pthread_cond_timedwait(&cond_hilo, &mutex_hilo, &limite) == ETIMEDOUT) tomar = 1;
+    }
+    pthread_mutex_unlock(&mutex_hilo);
+    return NULL;
+}
+
+int muestreo_iniciar() {
+    long t = sysconf(_SC_CLK_TCK);
+    if (t > 0) ticks_por_s = t;
+    if (MUESTREO_INTERVALO_S <= 0) return 0;
+    return muestreo_reconfigurar();
+}
+
+int muestreo_reconfigurar() {
+    if (hilo_activo) {
+        // el hilo vuelve a calcular su próxima muestra con el intervalo nuevo
+        pthread_mutex_lock(&mutex_hilo);
+        pthread_cond_signal(&cond_hilo);
+        pthread_mutex_unlock(&mutex_hilo);
+        return 0;
+    }
+    if (MUESTREO_INTERVALO_S <= 0) return 0;
+    if (fd_stat < 0) fd_stat = open("/proc/self/stat", O_RDONLY | O_CLOEXEC);
+    if (fd_status < 0) fd_status = open("/proc/self/status", O_RDONLY | O_CLOEXEC);
+    if (fd_stat < 0 || fd_status < 0) {
+        log_msg("Muestreo: /proc no disponible, sin muestreo del proceso");
+        return -1;
+    }
+    detener = 0;
+    if (pthread_create(&hilo_muestreo, NULL, hilo_muestrear, NULL) != 0) {
+        log_msg("Muestreo: no se pudo crear el hilo");
+        return -1;
+    }
+    hilo_activo = 1;
+    return 0;
+}
+
+void muestreo_detener() {
+    if (!hilo_activo) return;
+    pthread_mutex_lock(&mutex_hilo);
+    detener = 1;
+    pthread_cond_signal(&cond_hilo);
+    pthread_mutex_unlock(&mutex_hilo);
+    pthread_join(hilo_muestreo, NULL);
+    hilo_activo = 0;
+}
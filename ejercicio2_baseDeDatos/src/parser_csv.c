@@ -0,0 +1,127 @@
+#include <string.h>
+#include <limits.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "parser_csv.h"
+
+static int agregar_campo(CamposCsv *c, const char *ini, const char *fin) {
+    if (c->n == CSV_CAMPOS_MAX) return -1;
+    c->campo[c->n] = ini;
+    c->largo[c->n] = (uint32_t)(fin - ini);
+    c->n++;
+    return 0;
+}
+
+#ifdef __SSE2__
+// Se leen bloques alineados de 16 bytes: un bloque nunca cruza de página, así
+// que leer bytes más allá del fin de la línea (o de fin) no puede fallar
+int csv_separar(const char *p, const char *fin, CamposCsv *c) {
+    const __m128i coma = _mm_set1_epi8(',');
+    const __m128i nl = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i cero = _mm_setzero_si128();
+    const char *bloque = (const char *)((uintptr_t)p & ~(uintptr_t)15);
+    unsigned previos = (unsigned)(p - bloque); // bytes del primer bloque antes de p
+    const char *ini = p;
+    c->n = 0;
+
+    while (1) {
+        if (fin && bloque >= fin) {
+            c->fin = fin;
+            return agregar_campo(c, ini, fin) == 0 ? c->n : -1;
+        }
+        __m128i v = _mm_load_si128((const __m128i *)bloque);
+        unsigned m_coma = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, coma));
+        unsigned m_fin = (unsigned)_mm_movemask_epi8(
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, nl), _mm_cmpeq_epi8(v, cr)),
+                         _mm_cmpeq_epi8(v, cero)));
+        m_coma &= ~0u << previos;
+        m_fin &= ~0u << previos;
+        previos = 0;
+        if (fin && fin - bloque < 16) m_fin |= 1u << (fin - bloque);
+
+        unsigned pos_fin = 16;
+        if (m_fin) {
+            pos_fin = (unsigned)__builtin_ctz(m_fin);
+            m_coma &= (1u << pos_fin) - 1;
+        }
+        while (m_coma) {
+            const char *sep = bloque + __builtin_ctz(m_coma);
+            if (agregar_campo(c, ini, sep) != 0) return -1;
+            ini = sep + 1;
+            m_coma &= m_coma - 1;
+        }
+        if (m_fin) {
+            c->fin = bloque + pos_fin;
+            return agregar_campo(c, ini, c->fin) == 0 ? c->n : -1;
+        }
+        bloque += 16;
+    }
+}
+#else
+int csv_separar(const char *p, const char *fin, CamposCsv *c) {
+    const char *ini = p;
+    c->n = 0;
+    for (; !fin || p < fin; p++) {
+        if (*p == ',') {
+            if (agregar_campo(c, ini, p) != 0) return -1;
+            ini = p + 1;
+        } else if (*p == '\n' || *p == '\r' || *p == '\0') {
+            break;
+        }
+    }
+    c->fin = p;
+    return agregar_campo(c, ini, p) == 0 ? c->n : -1;
+}
+#endif
+
+int csv_entero(const char *s, size_t n, int *v) {
+    size_t i = 0;
+    int negativo = 0;
+    if (n > 0 && (s[0] == '-' || s[0] == '+')) {
+        negativo = s[0] == '-';
+        i = 1;
+    }
+    if (i == n) return -1;
+    long long r = 0;
+    long long limite = negativo ? -(long long)INT_MIN : INT_MAX;
+    for (; i < n; i++) {
+        unsigned d = (unsigned char)s[i] - '0';
+        if (d > 9) return -1;
+        r = r * 10 + d;
+        if (r > limite) return -1;
+    }
+    *v = (int)(negativo ? -r : r);
+    return 0;
+}
+
+// Los textos no admiten caracteres de control: las marcas del protocolo
+// (FIN_RESPUESTA, COMPRIMIDO_MARCA) y los saltos del WAL son de ese rango
+static int copiar_texto(char *dst, size_t tam, const char *s, uint32_t n) {
+    if (n >= tam) return -1;
+    for (uint32_t i = 0; i < n; i++) {
+        if ((unsigned char)s[i] < 0x20 || s[i] == 0x7f) return -1;
+    }
+    memcpy(dst, s, n);
+    dst[n] = '\0';
+    return 0;
+}
+
+int csv_campos_producto(const CamposCsv *c, Producto *prod) {
+    if (c->n != 6) return -1;
+    memset(prod, 0, sizeof(*prod));
+    if (csv_entero(c->campo[0], c->largo[0], &prod->id) != 0 || prod->id <= 0) return -1;
+    if (copiar_texto(prod->descripcion, DESC_MAX, c->campo[1], c->largo[1]) != 0) return -1;
+    if (csv_entero(c->campo[2], c->largo[2], &prod->cantidad) != 0) return -1;
+    if (copiar_texto(prod->fecha, FECHA_MAX, c->campo[3], c->largo[3]) != 0) return -1;
+    if (copiar_texto(prod->hora, HORA_MAX, c->campo[4], c->largo[4]) != 0) return -1;
+    if (csv_entero(c->campo[5], c->largo[5], &prod->generador) != 0) return -1;
+    return 0;
+}
+
+int csv_producto(const char *p, const char *fin, Producto *prod) {
+    CamposCsv c;
+    if (csv_separar(p, fin, &c) < 0) return -1;
+    return csv_campos_producto(&c, prod);
+}
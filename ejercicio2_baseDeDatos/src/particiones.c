@@ -0,0 +1,57 @@
+#include <time.h>
+#include <pthread.h>
+#include "particiones.h"
+
+int PARTICIONES_TABLA = PARTICIONES_DEF;
+
+static pthread_mutex_t mutexes[PARTICIONES_MAX] = {
+    [0 ... PARTICIONES_MAX - 1] = PTHREAD_MUTEX_INITIALIZER
+};
+static int n_particiones = 1;
+static int bits = 0;
+
+static uint64_t ahora_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Potencia de 2 más grande que no supera n (entre 1 y PARTICIONES_MAX)
+void particiones_configurar(int n) {
+    bits = 0;
+    while ((2 << bits) <= n && (2 << bits) <= PARTICIONES_MAX) bits++;
+    n_particiones = 1 << bits;
+}
+
+int particiones_cantidad() {
+    return n_particiones;
+}
+
+// Los rangos de IDs de cada generador son contiguos: mezclar antes de elegir
+int particion_de(int id) {
+    if (bits == 0) return 0;
+    uint32_t h = (uint32_t)id * 2654435761u;
+    return (int)(h >> (32 - bits));
+}
+
+uint64_t particiones_todas() {
+    return n_particiones == PARTICIONES_MAX ? ~0ULL : (1ULL << n_particiones) - 1;
+}
+
+uint64_t particiones_bloquear(uint64_t mascara) {
+    uint64_t espera = 0;
+    for (uint64_t m = mascara; m; m &= m - 1) {
+        pthread_mutex_t *mx = &mutexes[__builtin_ctzll(m)];
+        if (pthread_mutex_trylock(mx) == 0) continue;
+        uint64_t inicio = ahora_ns();
+        pthread_mutex_lock(mx);
+        espera += ahora_ns() - inicio;
+    }
+    return espera;
+}
+
+void particiones_desbloquear(uint64_t mascara) {
+    for (uint64_t m = mascara; m; m &= m - 1) {
+        pthread_mutex_unlock(&mutexes[__builtin_ctzll(m)]);
+    }
+}
@@ -0,0 +1,230 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include "pool.h"
+#include "arena.h"
+#include "utils.h"
+
+int POOL_HILOS = POOL_HILOS_DEF;
+
+// Celda de la cola: seq indica de quién es el turno (ver encolar/desencolar)
+typedef struct {
+    atomic_size_t seq;
+    int socket;
+} Celda;
+
+static Celda cola[POOL_COLA];
+static atomic_size_t pos_encolar = 0;
+static atomic_size_t pos_desencolar = 0;
+static sem_t pendientes;
+
+#define RETIRAR -1  /* socket centinela: el hilo que lo toma termina */
+
+static void (*atender_fn)(int socket) = NULL;
+static int hilos_objetivo = 0;      /* solo lo tocan pool_iniciar/pool_redimensionar */
+static atomic_int hilos_vivos = 0;
+static atomic_int hilos_ocupados = 0;
+
+// Conexiones en atención, para cortarlas al cerrar (protegidas por mutex_servicio)
+typedef struct Servicio {
+    int socket;
+    struct Servicio *ant, *sig;
+} Servicio;
+
+static Servicio *en_servicio = NULL;
+static int cerrando = 0;
+static pthread_mutex_t mutex_servicio = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_fin = PTHREAD_COND_INITIALIZER;  /* hilos_vivos llegó a 0 */
+
+// La celda pos está libre para escribir cuando seq == pos y lista para leer
+// cuando seq == pos + 1; al leerla pasa a pos + POOL_COLA (la vuelta siguiente).
+static int encolar(int socket) {
+    size_t pos = atomic_load_explicit(&pos_encolar, memory_order_relaxed);
+    for (;;) {
+        Celda *c = &cola[pos & (POOL_COLA - 1)];
+        size_t seq = atomic_load_explicit(&c->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&pos_encolar, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                c->socket = socket;
+                atomic_store_explicit(&c->seq, pos + 1, memory_order_release);
+                return 0;
+            }
+        } else if (dif < 0) {
+            return -1; // llena
+        } else {
+            pos = atomic_load_explicit(&pos_encolar, memory_order_relaxed);
+        }
+    }
+}
+
+static int desencolar(int *socket) {
+    size_t pos = atomic_load_explicit(&pos_desencolar, memory_order_relaxed);
+    for (;;) {
+        Celda *c = &cola[pos & (POOL_COLA - 1)];
+        size_t seq = atomic_load_explicit(&c->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&pos_desencolar, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                *socket = c->socket;
+                atomic_store_explicit(&c->seq, pos + POOL_COLA, memory_order_release);
+                return 0;
+            }
+        } else if (dif < 0) {
+            return -1; // vacía
+        } else {
+            pos = atomic_load_explicit(&pos_desencolar, memory_order_relaxed);
+        }
+    }
+}
+
+// Con el pool cerrando, la conexión solo termina lo que ya recibió: el
+// próximo recv devuelve 0 y el cliente se da por desconectado
+static void servicio_entrar(Servicio *s, int socket) {
+    s->socket = socket;
+    s->ant = NULL;
+    pthread_mutex_lock(&mutex_servicio);
+    s->sig = en_servicio;
+    if (en_servicio) en_servicio->ant = s;
+    en_servicio = s;
+    if (cerrando) shutdown(socket, SHUT_RD);
+    pthread_mutex_unlock(&mutex_servicio);
+}
+
+static void servicio_salir(Servicio *s) {
+    pthread_mutex_lock(&mutex_servicio);
+    if (s->ant) s->ant->sig = s->sig;
+    else en_servicio = s->sig;
+    if (s->sig) s->sig->ant = s->ant;
+    pthread_mutex_unlock(&mutex_servicio);
+}
+
+static void cortar_conexiones(int como) {
+    for (Servicio *s = en_servicio; s; s = s->sig) shutdown(s->socket, como);
+}
+
+static void *trabajador(void *arg) {
+    (void)arg;
+    // las señales las atiende el hilo principal
+    sigset_t set;
+    sigfillset(&set);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    for (;;) {
+        if (sem_wait(&pendientes) != 0) continue; // EINTR
+        int socket;
+        // el semáforo garantiza un elemento, pero puede no estar publicado aún
+        while (desencolar(&socket) != 0) sched_yield();
+        if (socket == RETIRAR) break;
+        Servicio s;
+        servicio_entrar(&s, socket);
+        atomic_fetch_add(&hilos_ocupados, 1);
+        atender_fn(socket);
+        atomic_fetch_sub(&hilos_ocupados, 1);
+        servicio_salir(&s);
+    }
+    arena_liberar(arena_hilo());
+    pthread_mutex_lock(&mutex_servicio);
+    if (atomic_fetch_sub(&hilos_vivos, 1) == 1) pthread_cond_broadcast(&cond_fin);
+    pthread_mutex_unlock(&mutex_servicio);
+    return NULL;
+}
+
+static int crear_hilos(int n) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int creados = 0;
+    for (; creados < n; creados++) {
+        pthread_t hilo;
+        atomic_fetch_add(&hilos_vivos, 1);
+        if (pthread_create(&hilo, &attr, trabajador, NULL) != 0) {
+            atomic_fetch_sub(&hilos_vivos, 1);
+            log_msg("Pool: solo se pudieron crear %d de %d hilos", creados, n);
+            break;
+        }
+    }
+    pthread_attr_destroy(&attr);
+    hilos_objetivo += creados;
+    return creados;
+}
+
+int pool_iniciar(int n, void (*atender)(int socket)) {
+    if (n <= 0 || !atender) return -1;
+    for (size_t i = 0; i < POOL_COLA; i++) atomic_init(&cola[i].seq, i);
+    if (sem_init(&pendientes, 0, 0) != 0) {
+        log_msg("Pool: sem_init falló: %s", strerror(errno));
+        return -1;
+    }
+    atender_fn = atender;
+    if (crear_hilos(n) == 0) return -1;
+    log_msg("Pool: %d hilos de atención", hilos_objetivo);
+    return 0;
+}
+
+int pool_redimensionar(int n) {
+    if (n <= 0 || !atender_fn) return -1;
+    if (n > hilos_objetivo) {
+        crear_hilos(n - hilos_objetivo);
+    } else {
+        // cada centinela retira un hilo cuando termine con lo que ya estaba en cola
+        while (hilos_objetivo > n && pool_despachar(RETIRAR) == 0) hilos_objetivo--;
+    }
+    log_msg("Pool: %d hilos de atención", hilos_objetivo);
+    return hilos_objetivo == n ? 0 : -1;
+}
+
+int pool_despachar(int socket) {
+    if (encolar(socket) != 0) return -1;
+    sem_post(&pendientes);
+    return 0;
+}
+
+void pool_detener(void) {
+    if (!atender_fn) return;
+    pthread_mutex_lock(&mutex_servicio);
+    cerrando = 1;
+    cortar_conexiones(SHUT_RD);
+    pthread_mutex_unlock(&mutex_servicio);
+
+    // los centinelas van detrás de lo ya encolado, que se atiende y se corta igual
+    int a_retirar = atomic_load(&hilos_vivos);
+    for (int i = 0; i < a_retirar; i++) {
+        while (pool_despachar(RETIRAR) != 0) sched_yield();
+    }
+    hilos_objetivo = 0;
+
+    struct timespec limite;
+    clock_gettime(CLOCK_REALTIME, &limite);
+    limite.tv_sec += POOL_CIERRE_S;
+    pthread_mutex_lock(&mutex_servicio);
+    while (atomic_load(&hilos_vivos) > 0) {
+        if (pthread_cond_timedwait(&cond_fin, &mutex_servicio, &limite) != ETIMEDOUT) continue;
+        // un cliente que no lee deja al hilo trabado en send: se corta también la escritura
+        log_msg("Pool: %d hilos siguen atendiendo tras %d s, se cortan sus conexiones",
+                atomic_load(&hilos_vivos), POOL_CIERRE_S);
+        cortar_conexiones(SHUT_RDWR);
+        pthread_cond_wait(&cond_fin, &mutex_servicio);
+    }
+    pthread_mutex_unlock(&mutex_servicio);
+    log_msg("Pool: detenido");
+}
+
+void pool_estadisticas(int *hilos, int *ocupados, int *encolados) {
+    int sem = 0;
+    sem_getvalue(&pendientes, &sem);
+    if (hilos) *hilos = atomic_load(&hilos_vivos);
+    if (ocupados) *ocupados = atomic_load(&hilos_ocupados);
+    if (encolados) *encolados = sem > 0 ? sem : 0;
+}
@@ -0,0 +1,276 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <libgen.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "recuperacion.h"
+#include "checkpoint.h"
+#include "db.h"
+#include "wal.h"
+#include "utils.h"
+
+int RECUPERACION_HILOS = 0;
+
+// Operación del WAL; linea apunta dentro del archivo mapeado (termina en '\n')
+typedef struct {
+    char op;
+    int id;
+    const char *linea;
+} OpWal;
+
+// Tramo del WAL que analiza un hilo. Empieza en una línea "T" (o al inicio)
+// y termina donde empieza el siguiente, así ningún bloque queda partido.
+typedef struct {
+    const char *ini, *fin;
+    uint64_t desde;
+    OpWal *ops;
+    size_t n, cap;
+    long transacciones;
+    long ignoradas;
+    uint64_t ultimo_lsn;   /* mayor LSN confirmado del tramo */
+    const char *fin_valido; /* fin de la última línea C completa (NULL si no hay) */
+    int error;
+} Tramo;
+
+static double ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Temporales de la versión anterior (copia de la base durante una transacción).
+// Nunca fueron confirmados, así que se descartan.
+static void limpiar_temporales(void) {
+    static const char *nombres[] = { "temp.csv", "temp_mod.csv", "temp_elim.csv" };
+    char copia[512], ruta[600];
+    strncpy(copia, ARCHIVO_DB, sizeof(copia) - 1);
+    copia[sizeof(copia) - 1] = '\0';
+    const char *dir = dirname(copia);
+    for (size_t i = 0; i < sizeof(nombres) / sizeof(nombres[0]); i++) {
+        snprintf(ruta, sizeof(ruta), "%s/%s", dir, nombres[i]);
+        if (access(ruta, F_OK) != 0) continue;
+        log_msg("Recuperación: %s es de una transacción sin confirmar, se elimina", ruta);
+        fprintf(stderr, "⚠️  Se descarta %s (transacción sin confirmar)\n", ruta);
+        remove(ruta);
+    }
+}
+
+static int agregar_op(Tramo *t, char op, int id, const char *linea) {
+    if (t->n == t->cap) {
+        size_t nueva = t->cap ? t->cap * 2 : 1024;
+        OpWal *o = realloc(t->ops, nueva * sizeof(OpWal));
+        if (!o) return -1;
+        t->ops = o;
+        t->cap = nueva;
+    }
+    t->ops[t->n].op = op;
+    t->ops[t->n].id = id;
+    t->ops[t->n].linea = linea;
+    t->n++;
+    return 0;
+}
+
+static void *analizar_tramo(void *arg) {
+    Tramo *t = arg;
+    const char *p = t->ini;
+    size_t inicio_bloque = 0;
+    uint64_t lsn_bloque = 0;
+    int en_bloque = 0;
+
+    while (p < t->fin) {
+        const char *nl = memchr(p, '\n', (size_t)(t->fin - p));
+        if (!nl) break; // línea cortada al final del archivo
+        size_t largo = (size_t)(nl - p);
+
+        if (largo >= 3 && p[0] == 'T' && p[1] == ' ') {
+            // un bloque sin su línea C (escritura cortada) se descarta
+            t->n = en_bloque ? inicio_bloque : t->n;
+            en_bloque = 1;
+            lsn_bloque = strtoull(p + 2, NULL, 10);
+            inicio_bloque = t->n;
+        } else if (largo >= 3 && p[0] == 'C' && p[1] == ' ') {
+            uint64_t lsn = strtoull(p + 2, NULL, 10);
+            if (en_bloque && lsn == lsn_bloque) {
+                if (lsn > t->ultimo_lsn) t->ultimo_lsn = lsn;
+                if (lsn > t->desde) t->transacciones++;
+                else t->n = inicio_bloque; // ya incluido en el checkpoint
+                t->fin_valido = nl + 1;
+            } else if (en_bloque) {
+                t->n = inicio_bloque;
+            }
+            en_bloque = 0;
+        } else if (en_bloque) {
+            char op = p[0];
+            if (largo >= 3 && p[1] == ' ' && (op == 'A' || op == 'M' || op == 'D')) {
+                int id = atoi(p + 2);
+                const char *esp = memchr(p + 2, ' ', largo - 2);
+                if (agregar_op(t, op, id, esp ? esp + 1 : NULL) != 0) {
+                    t->error = 1;
+                    return NULL;
+                }
+            } else {
+                t->ignoradas++;
+            }
+        }
+        p = nl + 1;
+    }
+    if (en_bloque) t->n = inicio_bloque;
+    return NULL;
+}
+
+// Próximo inicio de bloque ("T " al comienzo de línea) en [p, fin)
+static const char *siguiente_bloque(const char *base, const char *p, const char *fin) {
+    if (p <= base) return base;
+    while (p < fin) {
+        const char *nl = memchr(p - 1, '\n', (size_t)(fin - p + 1));
+        if (!nl || nl + 1 >= fin) return fin;
+        if (nl[1] == 'T' && nl + 2 < fin && nl[2] == ' ') return nl + 1;
+        p = nl + 2;
+    }
+    return fin;
+}
+
+static int hilos_para(size_t tam) {
+    int hilos = RECUPERACION_HILOS;
+    if (hilos <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        hilos = cpus > 0 ? (int)cpus : 1;
+    }
+    if (hilos > RECUPERACION_HILOS_MAX) hilos = RECUPERACION_HILOS_MAX;
+    size_t por_tamano = tam / RECUPERACION_TRAMO_MIN + 1;
+    if ((size_t)hilos > por_tamano) hilos = (int)por_tamano;
+    return hilos;
+}
+
+// Aplica todas las operaciones en orden de LSN, en este hilo. No se saltea
+// ninguna aunque una posterior la reemplace: un ID que no está se agrega al
+// final, así que el orden de aplicación decide el orden de las filas.
+static long aplicar_tramos(Tramo *tramos, int n_tramos) {
+    long aplicadas = 0;
+    for (int i = 0; i < n_tramos; i++) {
+        for (size_t j = 0; j < tramos[i].n; j++) {
+            const OpWal *o = &tramos[i].ops[j];
+            if (aplicar_operacion(o->op, o->id, o->linea) != 0) {
+                log_msg("WAL: operación no aplicable al reproducir: %c %d", o->op, o->id);
+            }
+            aplicadas++;
+        }
+    }
+    return aplicadas;
+}
+
+// Reproduce el WAL sobre la tabla ya cargada. Devuelve transacciones o -1.
+static long reproducir_wal(uint64_t desde, uint64_t *ultimo_lsn, long *ops, int *n_hilos) {
+    int fd = open(ARCHIVO_WAL, O_RDONLY);
+    if (fd < 0) return (errno == ENOENT) ? 0 : -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+    size_t tam = (size_t)st.st_size;
+    if (tam == 0) {
+        close(fd);
+        return 0;
+    }
+    const char *base = mmap(NULL, tam, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        log_msg("Recuperación: no se pudo mapear %s: %s", ARCHIVO_WAL, strerror(errno));
+        return -1;
+    }
+    madvise((void *)base, tam, MADV_SEQUENTIAL);
+    const char *fin = base + tam;
+
+    int hilos = hilos_para(tam);
+    Tramo tramos[RECUPERACION_HILOS_MAX];
+    pthread_t ids[RECUPERACION_HILOS_MAX];
+    int n_tramos = 0;
+    const char *p = base;
+    for (int i = 0; i < hilos && p < fin; i++) {
+        const char *corte = (i == hilos - 1) ? fin
+                          : siguiente_bloque(base, base + tam / hilos * (i + 1), fin);
+        if (corte <= p) continue;
+        memset(&tramos[n_tramos], 0, sizeof(Tramo));
+        tramos[n_tramos].ini = p;
+        tramos[n_tramos].fin = corte;
+        tramos[n_tramos].desde = desde;
+        n_tramos++;
+        p = corte;
+    }
+
+    int lanzados = 0;
+    for (int i = 1; i < n_tramos; i++) {
+        if (pthread_create(&ids[i], NULL, analizar_tramo, &tramos[i]) != 0) break;
+        lanzados = i;
+    }
+    analizar_tramo(&tramos[0]);
+    for (int i = lanzados + 1; i < n_tramos; i++) analizar_tramo(&tramos[i]); // sin hilo
+    for (int i = 1; i <= lanzados; i++) pthread_join(ids[i], NULL);
+
+    long transacciones = 0, ignoradas = 0;
+    int error = 0;
+    const char *fin_valido = base;
+    for (int i = 0; i < n_tramos; i++) {
+        transacciones += tramos[i].transacciones;
+        ignoradas += tramos[i].ignoradas;
+        error |= tramos[i].error;
+        if (tramos[i].ultimo_lsn > *ultimo_lsn) *ultimo_lsn = tramos[i].ultimo_lsn;
+        if (tramos[i].fin_valido) fin_valido = tramos[i].fin_valido;
+    }
+    if (!error) *ops = aplicar_tramos(tramos, n_tramos);
+    for (int i = 0; i < n_tramos; i++) free(tramos[i].ops);
+
+    size_t valido = (size_t)(fin_valido - base);
+    munmap((void *)base, tam);
+    if (error) {
+        log_msg("Recuperación: sin memoria analizando %s", ARCHIVO_WAL);
+        return -1;
+    }
+    if (ignoradas > 0) log_msg("Recuperación: %ld línea(s) del WAL no reconocidas", ignoradas);
+
+    // Una cola sin su línea C es un commit que nunca fue confirmado: se corta
+    // para que los bloques nuevos no queden pegados a una línea incompleta
+    if (valido < tam) {
+        log_msg("Recuperación: se descartan %zu bytes sin confirmar al final de %s",
+                tam - valido, ARCHIVO_WAL);
+        if (truncate(ARCHIVO_WAL, (off_t)valido) != 0) {
+            log_msg("Recuperación: no se pudo truncar %s: %s", ARCHIVO_WAL, strerror(errno));
+        }
+    }
+    *n_hilos = n_tramos;
+    return transacciones;
+}
+
+int recuperar_base(uint64_t *lsn) {
+    limpiar_temporales();
+
+    double inicio = ahora_ms();
+    if (abrir_motor() != 0) return -1;
+    double t_snapshot = ahora_ms() - inicio;
+
+    uint64_t desde = checkpoint_leer_lsn();
+    uint64_t ultimo = desde;
+    long ops = 0;
+    int hilos = 0;
+    long n = reproducir_wal(desde, &ultimo, &ops, &hilos);
+    if (n < 0) {
+        log_msg("Recuperación: no se pudo leer el WAL %s", ARCHIVO_WAL);
+        return -1;
+    }
+    double t_total = ahora_ms() - inicio;
+
+    log_msg("Recuperación en %.1f ms: snapshot %.1f ms, WAL %.1f ms "
+            "(%ld transacciones, %ld operaciones aplicadas, %d hilo(s), LSN %llu..%llu)",
+            t_total, t_snapshot, t_total - t_snapshot, n, ops, hilos,
+            (unsigned long long)desde, (unsigned long long)ultimo);
+    printf("🔄 Recuperación: %ld transacciones del WAL en %.1f ms\n", n, t_total);
+    *lsn = ultimo;
+    return 0;
+}
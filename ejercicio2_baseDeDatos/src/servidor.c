@@ -1,9 +1,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <arpa/inet.h>
+#include <netinet/tcp.h>
 #include <signal.h>
 #include <stdatomic.h>
 #include <errno.h>
@@ -13,29 +15,61 @@
 #include "db.h"
 #include "transaction.h"
 #include "utils.h"
+#include "wal.h"
+#include "checkpoint.h"
+#include "recuperacion.h"
+#include "bloqueos.h"
+#include "metricas.h"
+#include "protocolo.h"
+#include "pool.h"
+#include "admision.h"
+#include "config.h"
+#include "cache.h"
+#include "arena.h"
+#include "importar.h"
+#include "cursor.h"
+#include "muestreo.h"
+#include "db_log.h"
+#include "compactador.h"
+#include "traza.h"
+#include "particiones.h"
 
 #define BUFFER_SIZE 1024
 
 // ====== Variables globales y sincronización ======
-pthread_mutex_t mutex_archivo = PTHREAD_MUTEX_INITIALIZER;
-pthread_mutex_t mutex_transaccion = PTHREAD_MUTEX_INITIALIZER;
-pthread_mutex_t mutex_clientes = PTHREAD_MUTEX_INITIALIZER;
-
-int transaccion_activa = 0;
-pthread_t trans_owner;
-atomic_int clientes_activos = 0;
-
+char IP_SERVIDOR[64] = "0.0.0.0";
+int PUERTO = 8080;
 int MAX_CLIENTES = 5;
 int BACKLOG = 10;
 uint8_t FOREGROUND = 0;
 char CSV_PATH[512] = "data/productos.csv";
 char LOG_PATH[512] = "server.log";
+char BIN_PATH[512] = "data/productos.bin";
 
+static volatile sig_atomic_t cerrar = 0;     /* número de la señal que pidió el cierre */
+static volatile sig_atomic_t recargar = 0;
+static volatile sig_atomic_t volcar_traza = 0;
+static pthread_mutex_t mutex_importar = PTHREAD_MUTEX_INITIALIZER; /* una importación a la vez */
 
 // ====== Prototipos ======
-void *manejador_cliente(void *arg);
-void cerrar_servidor(int signo);
-void liberar_transaccion_si_propietario(pthread_t self);
+static void atender_cliente(int socket_cliente);
+static void cerrar_servidor(int signo);
+static void abortar_transaccion(Transaccion *tx, int *en_transaccion);
+static void importar_tabla(int socket_cliente, const char *arg);
+static void procesar_comando(int socket_cliente, const char *arg, const char *cmd,
+                             Transaccion *tx, int *en_transaccion, Cursor *cursor);
+static void mostrar_tabla(int socket_cliente, const char *arg, const Transaccion *tx);
+static void leer_cursor(int socket_cliente, const char *arg, Cursor *cursor);
+static void comando_traza(int socket_cliente, const char *arg);
+static int bloquear_escritura(int socket_cliente, const char *cmd, const char *arg,
+                              Transaccion *tx, int *en_transaccion, uint64_t *particiones);
+static int ruta_derivada(const char *csv, const char *ext, char *dst, size_t size);
+static int clientes_activos(void);
+static void pedir_cierre(int signo);
+static void pedir_recarga(int signo);
+static void pedir_traza(int signo);
+static int ruta_traza(const char *nombre, char *dst, size_t size);
+static void recargar_configuracion(void);
 
 // ====== Función principal ======
 int main(int argc, char *argv[]) {
@@ -43,23 +77,37 @@ int main(int argc, char *argv[]) {
     struct sockaddr_in direccion;
     socklen_t addrlen = sizeof(direccion);
 
-    if (argc < 3) {
+    if (argc >= 2 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)) {
         fprintf(stderr,
-            "Uso: %s <IP_O_HOST> <PUERTO> [MAX_CLIENTES] [BACKLOG] [CSV_PATH] [LOG_PATH]\n"
-            "Ejemplo: %s 8080 10 20 data/productos.csv server.log\n",
-            argv[0], argv[0]);
+            "Uso: %s [PUERTO] [MAX_CLIENTES] [BACKLOG] [CSV_PATH] [LOG_PATH] [FOREGROUND] [MOTOR csv|bin|col|log] [BIN_PATH]\n"
+            "Ejemplo: %s 8080 10 20 data/productos.csv server.log 0 bin data/productos.bin\n"
+            "Los valores omitidos se toman de %s (variable SERVER_CONF) o de los predeterminados.\n",
+            argv[0], argv[0], CONFIG_RUTA_DEF);
         exit(EXIT_FAILURE);
     }
-     // Ejecutar en primer plano
-    
-    //const char *ip = argv[1];
-    int puerto = atoi(argv[1]);
+
+    // Primero el archivo de configuración; los argumentos tienen prioridad
+    const char *ruta_conf = getenv("SERVER_CONF");
+    if (ruta_conf && *ruta_conf) strncpy(CONFIG_RUTA, ruta_conf, sizeof(CONFIG_RUTA) - 1);
+    int hay_conf = (config_cargar(CONFIG_RUTA, 0) == 0);
+
+    if (argc >= 2) PUERTO = atoi(argv[1]);
     if (argc >= 3) MAX_CLIENTES = atoi(argv[2]);
     if (argc >= 4) BACKLOG = atoi(argv[3]);
     if (argc >= 5) strncpy(CSV_PATH, argv[4], sizeof(CSV_PATH) - 1);
     if (argc >= 6) strncpy(LOG_PATH, argv[5], sizeof(LOG_PATH) - 1);
     if (argc >= 7) FOREGROUND = atoi(argv[6]);
+    if (argc >= 8) {
+        int motor = motor_desde_nombre(argv[7]);
+        if (motor < 0) {
+            fprintf(stderr, "Motor de almacenamiento inválido: %s (use csv, bin, col o log)\n", argv[7]);
+            exit(EXIT_FAILURE);
+        }
+        MOTOR_DB = motor;
+    }
+    if (argc >= 9) strncpy(BIN_PATH, argv[8], sizeof(BIN_PATH) - 1);
     
+    if (PUERTO <= 0) PUERTO = 8080;
     if (MAX_CLIENTES <= 0) MAX_CLIENTES = 5;
     if (BACKLOG <= 0) BACKLOG = 10;
 
@@ -67,12 +115,62 @@ int main(int argc, char *argv[]) {
     init_logger("server_debug.log", FOREGROUND);
     init_action_logger(LOG_PATH, FOREGROUND);
 
-    log_msg("Servidor iniciando en puerto %d (MAX_CLIENTES=%d, BACKLOG=%d, CSV=%s)",
-            puerto, MAX_CLIENTES, BACKLOG, CSV_PATH);
+    log_msg("Configuración: %s%s", CONFIG_RUTA, hay_conf ? "" : " (no encontrada, valores predeterminados)");
+    log_msg("Servidor iniciando en puerto %d (MAX_CLIENTES=%d, BACKLOG=%d, CSV=%s, MOTOR=%s)",
+            PUERTO, MAX_CLIENTES, BACKLOG, CSV_PATH, motor_nombre(MOTOR_DB));
 
     // Sincronizar ruta de DB con db.c
     strncpy(ARCHIVO_DB, CSV_PATH, sizeof(ARCHIVO_DB) - 1);
     ARCHIVO_DB[sizeof(ARCHIVO_DB) - 1] = '\0';
+    strncpy(ARCHIVO_BIN, BIN_PATH, sizeof(ARCHIVO_BIN) - 1);
+    ARCHIVO_BIN[sizeof(ARCHIVO_BIN) - 1] = '\0';
+
+    // WAL, LSN del checkpoint y segmentos del motor de log junto al CSV:
+    // data/productos.csv -> data/productos.{wal,ckpt,seg.NNNNNN}
+    if (ruta_derivada(CSV_PATH, ".wal", ARCHIVO_WAL, sizeof(ARCHIVO_WAL)) != 0 ||
+        ruta_derivada(CSV_PATH, ".ckpt", ARCHIVO_CKPT, sizeof(ARCHIVO_CKPT)) != 0 ||
+        ruta_derivada(CSV_PATH, ".seg", ARCHIVO_SEG, sizeof(ARCHIVO_SEG)) != 0) {
+        log_msg("Ruta del CSV demasiado larga para derivar WAL/checkpoint: %s", CSV_PATH);
+        fprintf(stderr, "❌ Ruta del CSV demasiado larga: %s\n", CSV_PATH);
+        exit(EXIT_FAILURE);
+    }
+
+    // Solo el motor csv reparte las filas; los demás bloquean la tabla entera
+    particiones_configurar(MOTOR_DB == MOTOR_CSV ? PARTICIONES_TABLA : 1);
+
+    // Cargar el último snapshot y reproducir los commits posteriores del WAL
+    uint64_t lsn_recuperado = 0;
+    if (recuperar_base(&lsn_recuperado) != 0) {
+        fprintf(stderr, "❌ No se pudo recuperar la base de datos (%s, WAL %s)\n",
+                MOTOR_DB == MOTOR_BIN ? ARCHIVO_BIN : MOTOR_DB == MOTOR_LOG ? ARCHIVO_SEG : ARCHIVO_DB,
+                ARCHIVO_WAL);
+        exit(EXIT_FAILURE);
+    }
+    if (wal_abrir(ARCHIVO_WAL, lsn_recuperado) != 0) {
+        fprintf(stderr, "❌ No se pudo abrir el WAL (%s)\n", ARCHIVO_WAL);
+        exit(EXIT_FAILURE);
+    }
+    checkpoint_iniciar();
+    compactador_iniciar();
+    bloqueos_iniciar();
+    metricas_iniciar();
+    muestreo_iniciar();
+
+    // Hilos de atención creados de antemano
+    int hilos = POOL_HILOS > 0 ? POOL_HILOS : MAX_CLIENTES;
+    if (hilos < MAX_CLIENTES) {
+        log_msg("⚠️  POOL_HILOS=%d < MAX_CLIENTES=%d: las conexiones admitidas esperarán un hilo libre",
+                hilos, MAX_CLIENTES);
+    }
+    if (pool_iniciar(hilos, atender_cliente) != 0) {
+        fprintf(stderr, "❌ No se pudieron crear los hilos de atención\n");
+        exit(EXIT_FAILURE);
+    }
+    // Sin lugar, las conexiones esperan en cola en vez de rechazarse
+    if (admision_iniciar(pool_despachar) != 0) {
+        fprintf(stderr, "❌ No se pudo iniciar la cola de admisión\n");
+        exit(EXIT_FAILURE);
+    }
 
     // ===== Crear socket =====
     servidor_fd = socket(AF_INET, SOCK_STREAM, 0);
@@ -90,13 +188,16 @@ int main(int argc, char *argv[]) {
     // ===== Configurar dirección =====
     memset(&direccion, 0, sizeof(direccion));
     direccion.sin_family = AF_INET;
-    direccion.sin_port = htons(puerto);
-    direccion.sin_addr.s_addr = htonl(INADDR_ANY);
+    direccion.sin_port = htons(PUERTO);
+    if (inet_pton(AF_INET, IP_SERVIDOR, &direccion.sin_addr) != 1) {
+        fprintf(stderr, "⚠️  IP_ADDRESS inválida (%s): se escucha en todas las interfaces\n", IP_SERVIDOR);
+        direccion.sin_addr.s_addr = htonl(INADDR_ANY);
+    }
 
     // ===== Bind =====
     if (bind(servidor_fd, (struct sockaddr *)&direccion, sizeof(direccion)) < 0) {
-        fprintf(stderr, "❌ Error en bind(%d): %s\n", puerto, strerror(errno));
-        log_msg("Error en bind(%d): %s", puerto, strerror(errno));
+        fprintf(stderr, "❌ Error en bind(%s:%d): %s\n", IP_SERVIDOR, PUERTO, strerror(errno));
+        log_msg("Error en bind(%s:%d): %s", IP_SERVIDOR, PUERTO, strerror(errno));
         close(servidor_fd);
         exit(EXIT_FAILURE);
     }
@@ -109,218 +210,608 @@ int main(int argc, char *argv[]) {
         exit(EXIT_FAILURE);
     }
 
-    printf("✅ Servidor iniciado en puerto %d\n", puerto);
-    log_msg("Servidor iniciado en puerto %d", puerto);
-
-    // Manejar señal Ctrl+C
-    signal(SIGINT, cerrar_servidor);
+    printf("✅ Servidor iniciado en %s:%d\n", IP_SERVIDOR, PUERTO);
+    log_msg("Servidor iniciado en %s:%d", IP_SERVIDOR, PUERTO);
+
+    // Los manejadores solo anotan el pedido; sin SA_RESTART interrumpen el
+    // accept y el bucle principal lo atiende
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sigemptyset(&sa.sa_mask);
+    // Ctrl+C / kill: cierre ordenado
+    sa.sa_handler = pedir_cierre;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    // SIGHUP: recargar la configuración
+    sa.sa_handler = pedir_recarga;
+    sigaction(SIGHUP, &sa, NULL);
+    // SIGUSR1: volcar la traza a TRAZA_RUTA_DEF junto al log de acciones
+    sa.sa_handler = pedir_traza;
+    sigaction(SIGUSR1, &sa, NULL);
 
     // ===== Bucle principal =====
-    while (1) {
+    while (!cerrar) {
         nuevo_socket = accept(servidor_fd, (struct sockaddr *)&direccion, &addrlen);
+        int error_accept = errno;
+        if (cerrar) {
+            if (nuevo_socket >= 0) close(nuevo_socket);
+            break;
+        }
+        if (recargar) {
+            recargar = 0;
+            recargar_configuracion();
+        }
+        if (volcar_traza) {
+            volcar_traza = 0;
+            char ruta[600];
+            ruta_traza(TRAZA_RUTA_DEF, ruta, sizeof(ruta));
+            log_msg("SIGUSR1: traza volcada en %s (%ld tramos)", ruta, traza_volcar(ruta));
+        }
         if (nuevo_socket < 0) {
+            if (error_accept == EINTR) continue;
             perror("⚠️  Error en accept");
             log_msg("Error en accept");
             continue;
         }
 
-        pthread_mutex_lock(&mutex_clientes);
-        if (clientes_activos >= MAX_CLIENTES) {
-            pthread_mutex_unlock(&mutex_clientes);
+        // las respuestas salen en varios send(): sin esto Nagle + ACK diferido las retrasa ~40 ms
+        setsockopt(nuevo_socket, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+
+        int admision = admision_entrar(nuevo_socket);
+        if (admision == ADMISION_RECHAZADO) {
             enviar(nuevo_socket, "Servidor ocupado. Reintente más tarde.\n");
             close(nuevo_socket);
-            log_action("Cliente rechazado: máximo de clientes alcanzado (%d).", MAX_CLIENTES);
+            log_action("Cliente rechazado: máximo de clientes (%d) y cola de espera (%d) llenos.",
+                       MAX_CLIENTES, ADMISION_COLA);
+            metricas_conexion_rechazada();
+            continue;
+        }
+        if (admision == ADMISION_EN_ESPERA) {
+            log_action("Cliente en espera de un lugar (socket=%d).", nuevo_socket);
             continue;
         }
-        clientes_activos++;
-        pthread_mutex_unlock(&mutex_clientes);
-
-        log_action("Cliente conectado (socket=%d). Clientes activos=%d", nuevo_socket, clientes_activos);
-
-        int *p_sock = malloc(sizeof(int));
-        *p_sock = nuevo_socket;
 
-        pthread_t hilo;
-        if (pthread_create(&hilo, NULL, manejador_cliente, p_sock) != 0) {
-            perror("Error creando hilo");
-            log_msg("Error creando hilo para socket=%d", nuevo_socket);
-            free(p_sock);
+        log_action("Cliente conectado (socket=%d). Clientes activos=%d", nuevo_socket, clientes_activos());
+        if (pool_despachar(nuevo_socket) != 0) {
+            log_msg("Cola del pool llena: se rechaza socket=%d", nuevo_socket);
+            enviar(nuevo_socket, "Servidor ocupado. Reintente más tarde.\n");
             close(nuevo_socket);
-            pthread_mutex_lock(&mutex_clientes);
-            clientes_activos--;
-            pthread_mutex_unlock(&mutex_clientes);
+            admision_salir();
+            metricas_conexion_rechazada();
             continue;
         }
-        pthread_detach(hilo);
     }
 
     close(servidor_fd);
-    close_logger();
+    cerrar_servidor(cerrar);
     return 0;
 }
 
-// ===== Manejador de clientes =====
-void *manejador_cliente(void *arg) {
-    int socket_cliente = *(int *)arg;
-    free(arg);
-    int my_turn = 0;
+// ===== Lectura de comandos =====
+// Un comando por línea. Un cliente puede mandar varios seguidos sin esperar
+// las respuestas (pipelining), así que un recv puede traer más de una línea
+// o cortar una a la mitad: lo recibido de más queda para la próxima llamada.
+typedef struct {
+    char datos[BUFFER_SIZE * 4];
+    size_t ini, fin;
+} LectorLineas;
+
+// Copia la próxima línea (sin \r\n) en linea; lo que no entra en cap se
+// descarta. Devuelve su largo o -1 si el cliente se desconectó
+static int leer_linea(int sock, LectorLineas *l, char *linea, size_t cap) {
+    size_t n = 0;
+    while (1) {
+        char *inicio = l->datos + l->ini;
+        char *salto = memchr(inicio, '\n', l->fin - l->ini);
+        size_t largo = salto ? (size_t)(salto - inicio) : l->fin - l->ini;
+        size_t k = largo < cap - 1 - n ? largo : cap - 1 - n;
+        memcpy(linea + n, inicio, k);
+        n += k;
+        if (salto) {
+            l->ini += largo + 1;
+            break;
+        }
+        l->ini = l->fin = 0;
+        ssize_t bytes = recv(sock, l->datos, sizeof(l->datos), 0);
+        if (bytes < 0 && errno == EINTR) continue;
+        if (bytes <= 0) {
+            if (n == 0) return -1;
+            break; // última línea sin salto: se procesa y el próximo recv ve el cierre
+        }
+        metricas_bytes_recibidos((size_t)bytes);
+        l->fin = (size_t)bytes;
+    }
+    while (n > 0 && linea[n - 1] == '\r') n--;
+    linea[n] = '\0';
+    return (int)n;
+}
+
+// ===== Atención de un cliente (en un hilo del pool) =====
+static void atender_cliente(int socket_cliente) {
+    int en_transaccion = 0;
+    int fin_respuesta = 0; // "FIN ON": marcar el final de cada respuesta
+    Transaccion tx;
+    trans_iniciar(&tx);
+    Cursor cursor;
+    cursor_iniciar(&cursor);
+    metricas_conexion_abierta();
 
     char buffer[BUFFER_SIZE];
     enviar(socket_cliente, "📡 Conectado al servidor de base de datos.\n");
 
-    pthread_t self = pthread_self();
-
+    LectorLineas lector = {0};
     while (1) {
-        memset(buffer, 0, sizeof(buffer));
-        int bytes = recv(socket_cliente, buffer, sizeof(buffer) - 1, 0);
-        if (bytes <= 0) {
+        // incluye el tiempo que el cliente tarda en mandar el comando
+        uint64_t t_espera = traza_inicio();
+        if (leer_linea(socket_cliente, &lector, buffer, sizeof(buffer)) < 0) {
             log_action("Cliente (socket=%d) desconectado inesperadamente.", socket_cliente);
             break;
         }
-
-        buffer[bytes] = '\0';
-        buffer[strcspn(buffer, "\r\n")] = 0;
+        traza_nuevo_pedido();
+        traza_fin("espera_comando", t_espera);
+        uint64_t t_parseo = traza_inicio();
         log_action("Recibido de socket=%d: %s", socket_cliente, buffer);
 
-        // Comando en mayúsculas
+        // Comando en mayúsculas; los argumentos empiezan después de la primera
+        // palabra y sus blancos ("" si no hay): el buffer no se limpia entre comandos
         char cmd[32] = {0};
         sscanf(buffer, "%31s", cmd);
         for (int i = 0; cmd[i]; ++i) cmd[i] = toupper(cmd[i]);
+        const char *arg = buffer + strspn(buffer, " \t");
+        arg += strcspn(arg, " \t");
+        arg += strspn(arg, " \t");
+        traza_fin("parseo", t_parseo);
 
         if (strncmp(cmd, "SALIR", 5) == 0) {
             enviar(socket_cliente, "👋 Desconectando...\n");
+            if (fin_respuesta) enviar(socket_cliente, FIN_RESPUESTA);
             break;
         }
 
-        // Verificar bloqueo por transacción activa
-        if (strcmp(cmd, "BEGIN") == 0) {
-            pthread_mutex_lock(&mutex_transaccion);
-            if (transaccion_activa) {
-                enviar(socket_cliente, "❌ Ya existe una transacción activa.\n");
-                if(!pthread_equal(trans_owner, self)) {
-                    enviar(socket_cliente, "⚠️  Transacción activa por otro cliente. Reintente más tarde.\n");
-                }
-                pthread_mutex_unlock(&mutex_transaccion);
-                continue;
-            }else {
-                transaccion_activa = 1;
-                trans_owner = self;
-                my_turn = 1;
-                enviar(socket_cliente, "🚀 Transacción iniciada.\n");
-            }
-            pthread_mutex_unlock(&mutex_transaccion);
+        if (strcmp(cmd, "COMPRIMIR") == 0) {
+            char modo[8] = {0};
+            sscanf(buffer, "%*s %7s", modo);
+            int activo = (strcasecmp(modo, "OFF") != 0);
+            enviar_comprimido(0); // la confirmación va siempre en texto
+            enviar(socket_cliente, activo ? "✅ Compresión activada.\n"
+                                          : "✅ Compresión desactivada.\n");
+            enviar_comprimido(activo);
+            if (fin_respuesta) enviar(socket_cliente, FIN_RESPUESTA);
             continue;
         }
 
-        if (!transaccion_activa || !my_turn) {
-         enviar(socket_cliente, "Para comenzar una transacción, use el comando BEGIN.\n");
-         continue;
-        }else if (my_turn) {
-        
-            // ===== Procesar comandos =====
-            if (strncmp(cmd, "MOSTRAR", 7) == 0) {
-                pthread_mutex_lock(&mutex_archivo);
-                mostrar_registros(socket_cliente);
-                pthread_mutex_unlock(&mutex_archivo);
-            }
-            else if (strncmp(cmd, "BUSCAR", 6) == 0) {
-                pthread_mutex_lock(&mutex_archivo);
-                buscar_registro(socket_cliente, buffer + 7);
-                pthread_mutex_unlock(&mutex_archivo);
-            }
-            else if (strncmp(cmd, "FILTRO", 6) == 0) {
-                pthread_mutex_lock(&mutex_archivo);
-                filtrar_generador(socket_cliente, buffer + 7);
-                pthread_mutex_unlock(&mutex_archivo);
-            }
-            else if (strncmp(cmd, "AGREGAR", 7) == 0) {
-                pthread_mutex_lock(&mutex_archivo);
-                if (agregar_registro(buffer + 8) == 0) {
-                    enviar(socket_cliente, "✅ Registro agregado correctamente.\n");
-                } else {
-                    enviar(socket_cliente, "❌ Error al agregar registro.\n");
-                }
-                pthread_mutex_unlock(&mutex_archivo);
-            }
-            else if (strncmp(cmd, "MODIFICAR", 9) == 0) {
-                pthread_mutex_lock(&mutex_archivo);
-                if (modificar_registro(socket_cliente, buffer + 10) == 0) {
-                    enviar(socket_cliente, "✅ Registro modificado correctamente.\n");
-                } else {
-                    enviar(socket_cliente, "❌ Registro no encontrado para modificar.\n");
-                }
-                pthread_mutex_unlock(&mutex_archivo);
-            }
-            else if (strncmp(cmd, "ELIMINAR", 8) == 0) {
-                pthread_mutex_lock(&mutex_archivo);
-                if (eliminar_registro(buffer + 9) == 0) {
-                    enviar(socket_cliente, "✅ Registro eliminado correctamente.\n");
-                } else {
-                    enviar(socket_cliente, "❌ Registro no encontrado para eliminar.\n");
-                }
-                pthread_mutex_unlock(&mutex_archivo);
-            }
-            else if (strncmp(cmd, "COMMIT", 6) == 0) {
-                pthread_mutex_lock(&mutex_transaccion);
-                if (!my_turn) {
-                    enviar(socket_cliente, "❌ No hay transacción activa o no es propietario.\n");
-                } else {
-                    transaccion_activa = 0;
-                    my_turn = 0;
-                    trans_owner = 0;
-                    if (commit_temp() == 0)
-                        enviar(socket_cliente, "✅ Transacción confirmada (COMMIT).\n");
-                    else
-                        enviar(socket_cliente, "⚠️  Error al confirmar transacción.\n");
-                }
-                pthread_mutex_unlock(&mutex_transaccion);
-            }
-            else if (strncmp(cmd, "ROLLBACK", 8) == 0) {
-                pthread_mutex_lock(&mutex_transaccion);
-                if (!my_turn) {
-                    enviar(socket_cliente, "❌ No hay transacción activa o no es propietario.\n");
-                } else {
-                    if(rollback_transaccion())
-                        enviar(socket_cliente, "⚠️  Error al revertir transacción.\n");
-                    else
-                        enviar(socket_cliente, "↩️  Transacción revertida (ROLLBACK).\n");
-                }
-                pthread_mutex_unlock(&mutex_transaccion);
-            }
-            else {
-                enviar(socket_cliente, "❓ Comando no reconocido.\n");
-            }
+        if (strcmp(cmd, "FIN") == 0) {
+            char modo[8] = {0};
+            sscanf(buffer, "%*s %7s", modo);
+            fin_respuesta = (strcasecmp(modo, "OFF") != 0);
+            enviar(socket_cliente, fin_respuesta ? "✅ Fin de respuesta activado.\n"
+                                                 : "✅ Fin de respuesta desactivado.\n");
+            enviar(socket_cliente, FIN_RESPUESTA); // también cierra la respuesta a FIN OFF
+            continue;
         }
+
+        uint64_t inicio = metricas_ahora_ns();
+        uint64_t t_pedido = traza_inicio();
+        procesar_comando(socket_cliente, arg, cmd, &tx, &en_transaccion, &cursor);
+        arena_reiniciar(arena_hilo()); // lo asignado para este comando
+        Metrica m = metrica_de_comando(cmd);
+        traza_fin(metricas_nombre(m), t_pedido);
+        metricas_registrar(m, metricas_ahora_ns() - inicio);
+        if (fin_respuesta) enviar(socket_cliente, FIN_RESPUESTA);
     }
 
-    liberar_transaccion_si_propietario(self);
+    if (en_transaccion) {
+        log_msg("⚠️  Transacción liberada automáticamente por desconexión del cliente propietario.");
+    }
+    bloqueo_liberar_todos(&tx);
+    trans_liberar(&tx);
+    cursor_cerrar(&cursor);
+    enviar_comprimido(0); // el hilo vuelve al pool
     close(socket_cliente);
 
-    pthread_mutex_lock(&mutex_clientes);
-    clientes_activos--;
-    pthread_mutex_unlock(&mutex_clientes);
+    metricas_conexion_cerrada();
+    admision_salir(); // el lugar pasa al primero en espera, si hay
 
-    log_action("Cliente socket=%d desconectado. Clientes activos=%d", socket_cliente, clientes_activos);
-    return NULL;
+    log_action("Cliente socket=%d desconectado. Clientes activos=%d", socket_cliente, clientes_activos());
 }
 
-// ===== Limpieza de transacciones si cliente muere =====
-void liberar_transaccion_si_propietario(pthread_t self) {
-    pthread_mutex_lock(&mutex_transaccion);
-    if (transaccion_activa && pthread_equal(trans_owner, self)) {
-        transaccion_activa = 0;
-        rollback_transaccion();
-        log_msg("⚠️  Transacción liberada automáticamente por desconexión del cliente propietario.");
+// ===== Despacho de comandos =====
+// Toma las particiones de la máscara registrando cuánto hubo que esperar
+static void bloquear_tabla(uint64_t particiones) {
+    uint64_t t_espera = traza_inicio();
+    uint64_t espera = particiones_bloquear(particiones);
+    if (espera == 0) return;
+    traza_fin("espera_particion", t_espera);
+    metricas_registrar(MET_ESPERA_PARTICION, espera);
+}
+
+// Particiones de los IDs que escribe la transacción (las que toma el COMMIT)
+static uint64_t particiones_de_cambios(const Transaccion *tx) {
+    uint64_t particiones = 0;
+    for (size_t i = 0; i < tx->n; i++) particiones |= particion_mascara(tx->cambios[i].id);
+    return particiones;
+}
+
+static void procesar_comando(int socket_cliente, const char *arg, const char *cmd,
+                             Transaccion *tx, int *en_transaccion, Cursor *cursor) {
+    // STATS no necesita transacción
+    if (strcmp(cmd, "STATS") == 0) {
+        char reporte[8192];
+        metricas_formatear(reporte, sizeof(reporte));
+        enviar(socket_cliente, reporte);
+        return;
+    }
+
+    // TRAZA ON|OFF|VOLCAR [archivo]: tampoco
+    if (strcmp(cmd, "TRAZA") == 0) {
+        comando_traza(socket_cliente, arg);
+        return;
+    }
+
+    // IMPORTAR reemplaza la tabla entera: va fuera de una transacción
+    if (strcmp(cmd, "IMPORTAR") == 0) {
+        if (*en_transaccion) {
+            enviar(socket_cliente, "❌ IMPORTAR no se puede usar dentro de una transacción.\n");
+            return;
+        }
+        importar_tabla(socket_cliente, arg);
+        return;
+    }
+
+    // FETCH y CLOSE leen la copia del cursor: no necesitan la transacción ni la tabla
+    if (strcmp(cmd, "FETCH") == 0) {
+        leer_cursor(socket_cliente, arg, cursor);
+        return;
+    }
+    if (strcmp(cmd, "CLOSE") == 0) {
+        if (!cursor_abierto(cursor)) {
+            enviar(socket_cliente, "❌ No hay un cursor abierto.\n");
+            return;
+        }
+        cursor_cerrar(cursor);
+        enviar(socket_cliente, "✅ Cursor cerrado.\n");
+        return;
+    }
+
+    // Cada cliente tiene su propia transacción; los conflictos se resuelven por fila
+    if (strcmp(cmd, "BEGIN") == 0) {
+        if (*en_transaccion) {
+            enviar(socket_cliente, "❌ Ya existe una transacción activa.\n");
+            return;
+        }
+        // una transacción abortada por wait-die reintenta con su marca original
+        if (tx->marca == 0) tx->marca = bloqueo_nueva_marca();
+        *en_transaccion = 1;
+        enviar(socket_cliente, "🚀 Transacción iniciada.\n");
+        return;
+    }
+
+    if (!*en_transaccion) {
+        enviar(socket_cliente, "Para comenzar una transacción, use el comando BEGIN.\n");
+        return;
+    }
+
+    // ===== Procesar comandos =====
+    if (strncmp(cmd, "MOSTRAR", 7) == 0) {
+        mostrar_tabla(socket_cliente, arg, tx);
+    }
+    else if (strcmp(cmd, "OPEN") == 0) {
+        bloquear_tabla(particiones_todas());
+        int ok = cursor_abrir(cursor, tx) == 0;
+        particiones_desbloquear(particiones_todas());
+        char msg[128];
+        if (ok)
+            snprintf(msg, sizeof(msg), "📂 Cursor abierto: %ld registro(s). Use FETCH <n> y CLOSE.\n", cursor->filas);
+        else
+            snprintf(msg, sizeof(msg), "❌ Sin memoria para abrir el cursor.\n");
+        enviar(socket_cliente, msg);
+    }
+    else if (strncmp(cmd, "BUSCAR", 6) == 0) {
+        if (cache_responder(socket_cliente, "BUSCAR", arg, tx) == 0) return;
+        bloquear_tabla(particiones_todas());
+        buscar_registro(socket_cliente, arg, tx);
+        particiones_desbloquear(particiones_todas());
+    }
+    else if (strncmp(cmd, "FILTRO", 6) == 0) {
+        if (cache_responder(socket_cliente, "FILTRO", arg, tx) == 0) return;
+        bloquear_tabla(particiones_todas());
+        filtrar_generador(socket_cliente, arg, tx);
+        particiones_desbloquear(particiones_todas());
+    }
+    else if (strncmp(cmd, "AGREGAR", 7) == 0) {
+        uint64_t particiones;
+        if (bloquear_escritura(socket_cliente, "AGREGAR", arg, tx, en_transaccion, &particiones) != 0)
+            return;
+        bloquear_tabla(particiones);
+        if (agregar_registro(arg, tx) == 0) {
+            enviar(socket_cliente, "✅ Registro agregado correctamente.\n");
+        } else {
+            enviar(socket_cliente, "❌ Error al agregar registro.\n");
+        }
+        particiones_desbloquear(particiones);
+    }
+    else if (strncmp(cmd, "MODIFICAR", 9) == 0) {
+        uint64_t particiones;
+        if (bloquear_escritura(socket_cliente, "MODIFICAR", arg, tx, en_transaccion, &particiones) != 0)
+            return;
+        bloquear_tabla(particiones);
+        if (modificar_registro(socket_cliente, arg, tx) == 0) {
+            enviar(socket_cliente, "✅ Registro modificado correctamente.\n");
+        } else {
+            enviar(socket_cliente, "❌ Registro no encontrado para modificar.\n");
+        }
+        particiones_desbloquear(particiones);
+    }
+    else if (strncmp(cmd, "ELIMINAR", 8) == 0) {
+        uint64_t particiones;
+        if (bloquear_escritura(socket_cliente, "ELIMINAR", arg, tx, en_transaccion, &particiones) != 0)
+            return;
+        bloquear_tabla(particiones);
+        if (eliminar_registro(arg, tx) == 0) {
+            enviar(socket_cliente, "✅ Registro eliminado correctamente.\n");
+        } else {
+            enviar(socket_cliente, "❌ Registro no encontrado para eliminar.\n");
+        }
+        particiones_desbloquear(particiones);
+    }
+    else if (strncmp(cmd, "COMMIT", 6) == 0) {
+        // Hacer durable el conjunto de escrituras (commit agrupado) y luego aplicarlo
+        const char *error = NULL;
+        if (trans_serializar(tx) != 0) {
+            log_msg("COMMIT: sin memoria para serializar la transacción");
+            error = "sin memoria";
+        } else if (tx->len > 0) {
+            uint64_t t_wal = traza_inicio();
+            uint64_t lsn = wal_commit(tx->ops, tx->len);
+            traza_fin("wal_commit", t_wal);
+            if (lsn == 0) {
+                error = "WAL";
+            } else {
+                uint64_t particiones = particiones_de_cambios(tx);
+                bloquear_tabla(particiones);
+                aplicar_transaccion(tx);
+                wal_aplicado(lsn);
+                particiones_desbloquear(particiones);
+            }
+        }
+        // los bloqueos se sueltan recién con los cambios ya aplicados
+        bloqueo_liberar_todos(tx);
+        trans_reset(tx);
+        tx->marca = 0;
+        *en_transaccion = 0;
+        if (!error) {
+            enviar(socket_cliente, "✅ Transacción confirmada (COMMIT).\n");
+        } else {
+            char msg[128];
+            snprintf(msg, sizeof(msg), "⚠️  Error al confirmar transacción (%s). Cambios descartados.\n", error);
+            enviar(socket_cliente, msg);
+        }
+    }
+    else if (strncmp(cmd, "ROLLBACK", 8) == 0) {
+        // los cambios nunca llegaron a la tabla compartida: basta con descartarlos.
+        // Un ROLLBACK voluntario termina la transacción: el próximo BEGIN es una
+        // transacción nueva con marca nueva (solo un aborto por wait-die la conserva)
+        bloqueo_liberar_todos(tx);
+        trans_reset(tx);
+        tx->marca = 0;
+        *en_transaccion = 0;
+        enviar(socket_cliente, "↩️  Transacción revertida (ROLLBACK).\n");
+    }
+    else {
+        enviar(socket_cliente, "❓ Comando no reconocido.\n");
+    }
+}
+
+// ===== Lecturas largas =====
+// MOSTRAR [LIMIT n] [OFFSET m]: copia la vista con la tabla bloqueada y la envía
+// después de soltarlo, así un cliente lento no frena a los que escriben
+static void mostrar_tabla(int socket_cliente, const char *arg, const Transaccion *tx) {
+    long limite, desde;
+    if (limite_offset_arg(arg, &limite, &desde) != 0) {
+        enviar(socket_cliente, "❌ Uso: MOSTRAR [LIMIT n] [OFFSET m]\n");
+        return;
+    }
+    size_t len;
+    bloquear_tabla(particiones_todas());
+    char *copia = copiar_registros(tx, desde, limite, &len, NULL);
+    if (!copia) mostrar_registros(socket_cliente, tx, desde, limite); // sin memoria: directo al socket
+    particiones_desbloquear(particiones_todas());
+    if (copia) {
+        enviar_bytes(socket_cliente, copia, len);
+        free(copia);
     }
-    pthread_mutex_unlock(&mutex_transaccion);
+}
+
+// FETCH <n>: las n filas siguientes del cursor; al llegar al final lo avisa
+static void leer_cursor(int socket_cliente, const char *arg, Cursor *cursor) {
+    long n;
+    if (sscanf(arg, " %ld", &n) != 1 || n <= 0) {
+        enviar(socket_cliente, "❌ Uso: FETCH <cantidad>\n");
+        return;
+    }
+    if (!cursor_abierto(cursor)) {
+        enviar(socket_cliente, "❌ No hay un cursor abierto (use OPEN).\n");
+        return;
+    }
+    cursor_leer(cursor, socket_cliente, n);
+    if (cursor->pos == cursor->len) {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "🏁 Fin del cursor: %ld registro(s) enviados.\n", cursor->enviadas);
+        enviar(socket_cliente, msg);
+    }
+}
+
+// ===== Traza de tramos =====
+// TRAZA ON|OFF enciende o apaga la anotación; TRAZA VOLCAR [nombre] escribe
+// los anillos de todos los hilos (JSON de eventos de Chrome) en el directorio
+// del log de acciones: el cliente solo elige el nombre, nunca la ruta
+static void comando_traza(int socket_cliente, const char *arg) {
+    char modo[16] = {0}, nombre[128] = {0}, ruta[600];
+    sscanf(arg, " %15s %127s", modo, nombre);
+    char msg[768];
+    if (strcasecmp(modo, "ON") == 0 || strcasecmp(modo, "OFF") == 0) {
+        int activa = strcasecmp(modo, "ON") == 0;
+        traza_activar(activa);
+        log_action("Traza %s (socket=%d).", activa ? "activada" : "desactivada", socket_cliente);
+        enviar(socket_cliente, activa ? "✅ Traza activada.\n" : "✅ Traza desactivada.\n");
+    } else if (strcasecmp(modo, "VOLCAR") == 0) {
+        if (ruta_traza(nombre[0] ? nombre : TRAZA_RUTA_DEF, ruta, sizeof(ruta)) != 0) {
+            enviar(socket_cliente, "❌ TRAZA VOLCAR acepta solo un nombre de archivo (sin '/' ni '..').\n");
+            return;
+        }
+        long n = traza_volcar(ruta);
+        if (n < 0)
+            snprintf(msg, sizeof(msg), "❌ No se pudo escribir la traza en %s.\n", ruta);
+        else
+            snprintf(msg, sizeof(msg), "📝 Traza: %ld tramo(s) en %s.\n", n, ruta);
+        log_action("Traza volcada en %s (socket=%d).", ruta, socket_cliente);
+        enviar(socket_cliente, msg);
+    } else {
+        enviar(socket_cliente, "❌ Uso: TRAZA ON|OFF|VOLCAR [nombre]\n");
+    }
+}
+
+// ===== Importación masiva =====
+// Arma el snapshot sin bloquear la tabla y solo la toma para el cambio
+static void importar_tabla(int socket_cliente, const char *arg) {
+    char origen[512] = {0};
+    if (sscanf(arg, " %511s", origen) != 1) {
+        enviar(socket_cliente, "❌ Uso: IMPORTAR <archivo.csv|archivo.bin>\n");
+        return;
+    }
+    if (pthread_mutex_trylock(&mutex_importar) != 0) {
+        enviar(socket_cliente, "❌ Ya hay una importación en curso.\n");
+        return;
+    }
+    char snapshot[600], msg[512];
+    snprintf(snapshot, sizeof(snapshot), "%s.importar", ARCHIVO_DB);
+    ResultadoImportar r;
+    if (importar_snapshot(origen, snapshot, &r) != 0) {
+        pthread_mutex_unlock(&mutex_importar);
+        snprintf(msg, sizeof(msg), "❌ Error al importar: %s\n", r.error);
+        enviar(socket_cliente, msg);
+        return;
+    }
+    double inicio = metricas_ahora_ns() / 1e6;
+    int ok = checkpoint_reemplazar(snapshot) == 0;
+    double ms_cambio = metricas_ahora_ns() / 1e6 - inicio;
+    if (!ok) remove(snapshot);
+    pthread_mutex_unlock(&mutex_importar);
+
+    if (!ok) {
+        enviar(socket_cliente, "❌ Error al reemplazar la tabla con la importación.\n");
+        return;
+    }
+    log_action("IMPORTAR %s: %ld filas (socket=%d)", origen, r.filas, socket_cliente);
+    snprintf(msg, sizeof(msg),
+             "✅ Importados %ld registros (%ld inválidos, %ld duplicados) desde %s "
+             "en %.0f ms (validación %.0f ms con %d hilo(s), cambio de tabla %.0f ms).\n",
+             r.filas, r.invalidas, r.duplicadas, r.binario ? "binario" : "CSV",
+             r.ms_total + ms_cambio, r.ms_lectura, r.hilos, ms_cambio);
+    enviar(socket_cliente, msg);
+}
+
+// ===== Bloqueos por fila =====
+// Descarta la transacción y suelta sus bloqueos; conserva la marca para el reintento
+static void abortar_transaccion(Transaccion *tx, int *en_transaccion) {
+    bloqueo_liberar_todos(tx);
+    trans_reset(tx);
+    *en_transaccion = 0;
+}
+
+// Bloquea los IDs que va a escribir el comando. Si hay conflicto la transacción
+// se aborta y se avisa al cliente; devuelve -1 en ese caso.
+static int bloquear_escritura(int socket_cliente, const char *cmd, const char *arg,
+                              Transaccion *tx, int *en_transaccion, uint64_t *particiones) {
+    int ids[2];
+    int n = ids_a_bloquear(cmd, arg, ids);
+    // sin IDs el comando solo responde el error de formato
+    *particiones = n ? 0 : particiones_todas();
+    for (int i = 0; i < n; i++) *particiones |= particion_mascara(ids[i]);
+    for (int i = 0; i < n; i++) {
+        uint64_t t_espera = traza_inicio();
+        int r = bloqueo_adquirir(tx, ids[i]);
+        traza_fin("espera_fila", t_espera);
+        if (r == BLOQUEO_OK) continue;
+        abortar_transaccion(tx, en_transaccion);
+        log_action("Transacción abortada (socket=%d): ID %d bloqueado por otra transacción (%s).",
+                   socket_cliente, ids[i], r == BLOQUEO_ABORTA ? "wait-die" : "timeout");
+        enviar(socket_cliente, "❌ Conflicto: el registro está siendo modificado por otra transacción. "
+                               "Transacción abortada, use BEGIN para reintentar.\n");
+        return -1;
+    }
+    return 0;
 }
 
 // ===== Cierre ordenado del servidor =====
-void cerrar_servidor(int signo) {
+// Se ejecuta en el hilo principal, ya fuera del bucle de accept: primero se
+// terminan las conexiones, así el checkpoint final no compite con escrituras
+static void cerrar_servidor(int signo) {
     log_action("🛑 Señal %d recibida. Cerrando servidor y liberando recursos...", signo);
-    rollback_transaccion();
+    admision_detener();
+    pool_detener();
+    metricas_detener();
+    muestreo_detener();
+    compactador_detener();
+    checkpoint_detener();
+    checkpoint_ejecutar();
+    cache_vaciar();
+    cerrar_motor();
+    wal_cerrar();
     close_action_logger();
     close_logger();
     printf("\nServidor detenido correctamente.\n");
-    exit(0);
+}
+
+// Ruta hermana del CSV con otra extensión (data/productos.csv -> data/productos.wal).
+// -1 si no entra en dst
+static int ruta_derivada(const char *csv, const char *ext, char *dst, size_t size) {
+    const char *barra = strrchr(csv, '/');
+    const char *punto = strrchr(barra ? barra : csv, '.');
+    int base = punto ? (int)(punto - csv) : (int)strlen(csv);
+    int n = snprintf(dst, size, "%.*s%s", base, csv, ext);
+    return (n < 0 || (size_t)n >= size) ? -1 : 0;
+}
+
+static int clientes_activos(void) {
+    int activos = 0;
+    admision_estadisticas(&activos, NULL, NULL, NULL, NULL);
+    return activos;
+}
+
+// Ruta de un volcado de la traza: nombre (sin directorios ni "..", que no
+// empiece con '.') dentro del directorio de LOG_PATH. -1 si no es válido
+static int ruta_traza(const char *nombre, char *dst, size_t size) {
+    if (!*nombre || nombre[0] == '.' || strchr(nombre, '/') || strstr(nombre, "..")) return -1;
+    const char *barra = strrchr(LOG_PATH, '/');
+    int largo_dir = barra ? (int)(barra - LOG_PATH) : 1;
+    snprintf(dst, size, "%.*s/%s", largo_dir, barra ? LOG_PATH : ".", nombre);
+    return 0;
+}
+
+static void pedir_cierre(int signo) {
+    cerrar = signo;
+}
+
+static void pedir_traza(int signo) {
+    (void)signo;
+    volcar_traza = 1;
+}
+
+// ===== Recarga de configuración =====
+static void pedir_recarga(int signo) {
+    (void)signo;
+    recargar = 1;
+}
+
+// Se ejecuta en el hilo principal: relee el archivo y aplica los parámetros recargables
+static void recargar_configuracion(void) {
+    log_msg("SIGHUP: recargando %s", CONFIG_RUTA);
+    if (config_cargar(CONFIG_RUTA, 1) != 0) return;
+    pool_redimensionar(POOL_HILOS > 0 ? POOL_HILOS : MAX_CLIENTES);
+    admision_reconfigurar();
+    metricas_reconfigurar();
+    muestreo_reconfigurar();
+    cache_reconfigurar();
+    log_action("Configuración recargada (MAX_CLIENTES=%d, WORKERS=%d).", MAX_CLIENTES, POOL_HILOS);
 }
@@ -1,45 +1,93 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <pthread.h>
 #include "transaction.h"
 #include "db.h"
 
-extern int transaccion_activa;
-extern pthread_mutex_t mutex_transaccion;
+// ====== Conjunto de escrituras ======
 
-// Inicia una transacción
-void begin_transaction() {
-    pthread_mutex_lock(&mutex_transaccion);
-    if (transaccion_activa) {
-        printf("Error: ya existe una transacción activa.\n");
-    } else {
-        transaccion_activa = 1;
-        printf("Transacción iniciada.\n");
-    }
-    pthread_mutex_unlock(&mutex_transaccion);
+void trans_iniciar(Transaccion *t) {
+    t->cambios = NULL;
+    t->n = t->cap = 0;
+    indice_iniciar(&t->idx);
+    arena_iniciar(&t->mem);
+    t->ops = NULL;
+    t->len = t->cap_ops = 0;
+    t->marca = 0;
+    t->bloqueados = NULL;
+    t->n_bloq = t->cap_bloq = 0;
+}
+
+void trans_reset(Transaccion *t) {
+    arena_reiniciar(&t->mem);
+    t->n = 0;
+    t->len = 0;
+    indice_vaciar(&t->idx);
+}
+
+void trans_liberar(Transaccion *t) {
+    trans_reset(t);
+    free(t->cambios);
+    free(t->ops);
+    free(t->bloqueados);
+    arena_liberar(&t->mem);
+    indice_liberar(&t->idx);
+    trans_iniciar(t);
 }
 
-// Confirma la transacción
-void commit_transaction() {
-    pthread_mutex_lock(&mutex_transaccion);
-    if (!transaccion_activa) {
-        printf("Error: no hay transacción activa para confirmar.\n");
-    } else {
-        transaccion_activa = 0;
-        printf("Transacción confirmada.\n");
+const CambioTrans *trans_buscar(const Transaccion *t, int id) {
+    int32_t pos = indice_buscar(&t->idx, id);
+    return pos >= 0 ? &t->cambios[pos] : NULL;
+}
+
+int trans_poner(Transaccion *t, int id, const char *linea, int en_base) {
+    char *copia = NULL;
+    if (linea && !(copia = arena_copiar_linea(&t->mem, linea))) return -1;
+    int32_t pos = indice_buscar(&t->idx, id);
+    if (pos >= 0) {
+        // ya tocado: se conserva en_base del primer cambio (la línea anterior
+        // queda en la arena hasta el fin de la transacción)
+        t->cambios[pos].linea = copia;
+        return 0;
     }
-    pthread_mutex_unlock(&mutex_transaccion);
+    if (t->n == t->cap) {
+        size_t nueva = t->cap ? t->cap * 2 : 16;
+        CambioTrans *c = realloc(t->cambios, nueva * sizeof(CambioTrans));
+        if (!c) return -1;
+        t->cambios = c;
+        t->cap = nueva;
+    }
+    if (indice_poner(&t->idx, id, (int32_t)t->n) != 0) return -1;
+    t->cambios[t->n].id = id;
+    t->cambios[t->n].linea = copia;
+    t->cambios[t->n].en_base = en_base;
+    t->n++;
+    return 0;
 }
 
-// Cancela la transacción
-void rollback_transaction() {
-    pthread_mutex_lock(&mutex_transaccion);
-    if (!transaccion_activa) {
-        printf("Error: no hay transacción activa para cancelar.\n");
-    } else {
-        transaccion_activa = 0;
-        printf("Transacción cancelada.\n");
+int trans_serializar(Transaccion *t) {
+    t->len = 0;
+    for (size_t i = 0; i < t->n; i++) {
+        const CambioTrans *c = &t->cambios[i];
+        if (!c->linea && !c->en_base) continue; // agregado y eliminado en la misma transacción
+        size_t necesario = t->len + (c->linea ? strlen(c->linea) : 0) + 32;
+        if (necesario > t->cap_ops) {
+            size_t nueva = t->cap_ops ? t->cap_ops : 256;
+            while (nueva < necesario) nueva *= 2;
+            char *n = realloc(t->ops, nueva);
+            if (!n) {
+                t->len = 0;
+                return -1;
+            }
+            t->ops = n;
+            t->cap_ops = nueva;
+        }
+        if (c->linea) {
+            t->len += (size_t)snprintf(t->ops + t->len, t->cap_ops - t->len, "%c %d %s",
+                                       c->en_base ? 'M' : 'A', c->id, c->linea);
+        } else {
+            t->len += (size_t)snprintf(t->ops + t->len, t->cap_ops - t->len, "D %d\n", c->id);
+        }
     }
-    pthread_mutex_unlock(&mutex_transaccion);
-}
\ No newline at end of file
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/syscall.h>
+#include "traza.h"
+#include "utils.h"
+
+// ====== Anillos de tramos ======
+// Un productor (el hilo dueño) por anillo; el volcado copia los slots sin
+// detener a nadie y descarta los que el dueño pudo haber pisado mientras
+// copiaba (los que quedan a menos de una vuelta de "escritos").
+
+int TRAZA_ACTIVA = 0;
+int TRAZA_EVENTOS = TRAZA_EVENTOS_DEF;
+
+typedef struct {
+    const char *nombre;
+    uint64_t inicio_ns;
+    uint64_t dur_ns;
+    uint32_t pedido;
+} EventoTraza;
+
+typedef struct AnilloTraza {
+    atomic_size_t escritos;      /* tramos anotados desde que el hilo lo tomó */
+    atomic_int abandonado;       /* el hilo terminó: otro hilo nuevo lo puede reusar */
+    int tid;
+    struct AnilloTraza *sig;
+    size_t tam;                  /* slots, potencia de 2 */
+    EventoTraza slots[];
+} AnilloTraza;
+
+static AnilloTraza *anillos = NULL;
+static pthread_mutex_t mutex_anillos = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t clave_once = PTHREAD_ONCE_INIT;
+static pthread_key_t clave_anillo;
+static __thread AnilloTraza *mi_anillo = NULL;
+static __thread uint32_t mi_pedido = 0;
+static atomic_uint proximo_pedido = 1;
+
+// Mismo reloj que metricas_ahora_ns (importar y bench no enlazan metricas.c)
+static uint64_t ahora_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void marcar_abandonado(void *arg) {
+    atomic_store(&((AnilloTraza *)arg)->abandonado, 1);
+}
+
+static void crear_clave(void) {
+    pthread_key_create(&clave_anillo, marcar_abandonado);
+}
+
+// El anillo del hilo: reusa el de un hilo que ya terminó o crea uno.
+// Los tramos del hilo anterior se pierden al reusarlo
+static AnilloTraza *anillo_del_hilo(void) {
+    if (mi_anillo) return mi_anillo;
+    size_t tam = 16;
+    while (tam < (size_t)TRAZA_EVENTOS) tam <<= 1;
+    int tid = (int)syscall(SYS_gettid);
+
+    AnilloTraza *a = NULL;
+    pthread_mutex_lock(&mutex_anillos);
+    for (AnilloTraza *r = anillos; r; r = r->sig) {
+        int uno = 1;
+        if (r->tam == tam && atomic_compare_exchange_strong(&r->abandonado, &uno, 0)) {
+            a = r;
+            break;
+        }
+    }
+    if (a) {
+        a->tid = tid;
+        atomic_store_explicit(&a->escritos, 0, memory_order_release);
+    }
+    pthread_mutex_unlock(&mutex_anillos);
+
+    if (!a) {
+        a = calloc(1, sizeof(AnilloTraza) + tam * sizeof(EventoTraza));
+        if (!a) return NULL;
+        a->tam = tam;
+        a->tid = tid;
+        pthread_mutex_lock(&mutex_anillos);
+        a->sig = anillos;
+        anillos = a;
+        pthread_mutex_unlock(&mutex_anillos);
+    }
+    pthread_once(&clave_once, crear_clave);
+    pthread_setspecific(clave_anillo, a);
+    mi_anillo = a;
+    return a;
+}
+
+uint64_t traza_inicio() {
+    if (!TRAZA_ACTIVA) return 0;
+    return ahora_ns();
+}
+
+void traza_fin(const char *nombre, uint64_t inicio) {
+    if (inicio == 0) return;
+    uint64_t fin = ahora_ns();
+    AnilloTraza *a = anillo_del_hilo();
+    if (!a) return;
+    size_t i = atomic_load_explicit(&a->escritos, memory_order_relaxed);
+    EventoTraza *e = &a->slots[i & (a->tam - 1)];
+    e->nombre = nombre;
+    e->inicio_ns = inicio;
+    e->dur_ns = fin - inicio;
+    e->pedido = mi_pedido;
+    atomic_store_explicit(&a->escritos, i + 1, memory_order_release);
+}
+
+void traza_nuevo_pedido() {
+    if (!TRAZA_ACTIVA) return;
+    mi_pedido = atomic_fetch_add_explicit(&proximo_pedido, 1, memory_order_relaxed);
+}
+
+void traza_activar(int activa) {
+    TRAZA_ACTIVA = activa ? 1 : 0;
+}
+
+// Copia los tramos válidos de un anillo a copia. Devuelve cuántos
+static size_t copiar_anillo(AnilloTraza *a, EventoTraza *copia, int *tid) {
+    *tid = a->tid;
+    size_t n1 = atomic_load_explicit(&a->escritos, memory_order_acquire);
+    size_t desde = n1 > a->tam ? n1 - a->tam : 0;
+    for (size_t i = desde; i < n1; i++)
+        copia[i - desde] = a->slots[i & (a->tam - 1)];
+    atomic_thread_fence(memory_order_acquire);
+    size_t n2 = atomic_load_explicit(&a->escritos, memory_order_relaxed);
+    if (n2 < n1) return 0;                    // otro hilo lo tomó mientras se copiaba
+    // el slot i pudo pisarse si el dueño ya iba por i + tam
+    size_t validos = n2 >= a->tam ? n2 - a->tam + 1 : 0;
+    if (validos <= desde) return n1 - desde;
+    if (validos >= n1) return 0;
+    memmove(copia, copia + (validos - desde), (n1 - validos) * sizeof(EventoTraza));
+    return n1 - validos;
+}
+
+long traza_volcar(const char *ruta) {
+    if (!ruta || !*ruta) ruta = TRAZA_RUTA_DEF;
+    FILE *fp = fopen(ruta, "w");
+    if (!fp) {
+        log_msg("Traza: no se pudo abrir %s", ruta);
+        return -1;
+    }
+
+    int pid = (int)getpid();
+    long total = 0;
+    EventoTraza *copia = NULL;
+    size_t tam_copia = 0;
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", fp);
+
+    // la lista solo crece (los anillos no se liberan): se puede recorrer sin el mutex
+    pthread_mutex_lock(&mutex_anillos);
+    AnilloTraza *primero = anillos;
+    pthread_mutex_unlock(&mutex_anillos);
+    for (AnilloTraza *a = primero; a; a = a->sig) {
+        if (a->tam > tam_copia) {
+            EventoTraza *nueva = realloc(copia, a->tam * sizeof(EventoTraza));
+            if (!nueva) continue;
+            copia = nueva;
+            tam_copia = a->tam;
+        }
+        int tid;
+        size_t n = copiar_anillo(a, copia, &tid);
+        for (size_t i = 0; i < n; i++) {
+            EventoTraza *e = &copia[i];
+            fprintf(fp, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                        "\"pid\":%d,\"tid\":%d,\"args\":{\"pedido\":%u}}",
+                    total ? "," : "", e->nombre, e->inicio_ns / 1e3, e->dur_ns / 1e3,
+                    pid, tid, e->pedido);
+            total++;
+        }
+    }
+    free(copia);
+    fputs("\n]}\n", fp);
+    if (fclose(fp) != 0) {
+        log_msg("Traza: error al escribir %s", ruta);
+        return -1;
+    }
+    log_msg("Traza: %ld tramo(s) volcados en %s", total, ruta);
+    return total;
+}
@@ -4,8 +4,53 @@
 #include <unistd.h>
 #include <arpa/inet.h>
 #include "utils.h"
+#include "compresion.h"
+#include "protocolo.h"
+#include "traza.h"
 #include <stdarg.h>
 #include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <errno.h>
+
+// ====== Registro asíncrono ======
+// Cada hilo formatea sus mensajes en un anillo propio (un productor, un
+// consumidor, sin locks). Un hilo escritor drena todos los anillos cada
+// LOG_INTERVALO_MS y escribe por lotes, formateando la fecha una vez por
+// segundo; un productor que llena medio anillo lo despierta antes. Si el
+// anillo de un hilo está lleno el mensaje se descarta y se informa la
+// cantidad descartada. Los mensajes que no entran en el slot (un comando
+// recibido, por ejemplo) van a un bloque aparte que libera el escritor; solo
+// más allá de LOG_LARGO_MAX se cortan, y el corte queda marcado.
+
+#define LOG_TEXTO_MAX     240
+#define LOG_LARGO_MAX     (16 * 1024)
+#define LOG_MARCA_CORTE   " …[truncado]"
+#define LOG_INTERVALO_MS  20
+#define LOG_LOTE          (64 * 1024)
+
+enum { DESTINO_DEBUG = 0, DESTINO_ACCION = 1 };
+
+typedef struct {
+    time_t segundo;
+    uint8_t destino;
+    uint16_t len;
+    char *largo;                 /* texto fuera del slot (malloc) o NULL */
+    char texto[LOG_TEXTO_MAX];
+} RegistroLog;
+
+typedef struct AnilloLog {
+    atomic_size_t cabeza;        /* próxima escritura (solo el hilo dueño) */
+    atomic_size_t cola;          /* próxima lectura (solo el escritor) */
+    atomic_ulong descartados;
+    atomic_int abandonado;       /* el hilo terminó: liberar cuando quede vacío */
+    struct AnilloLog *sig;
+    size_t tam;                  /* slots, potencia de 2 */
+    RegistroLog slots[];
+} AnilloLog;
+
+int LOG_ANILLO_SLOTS = LOG_ANILLO_SLOTS_DEF;
 
 // Debug logger (mantiene toda la información y snapshots)
 static FILE *log_fp = NULL;
@@ -16,6 +61,238 @@ static FILE *action_fp = NULL;
 static char action_path[512] = "server.log";
 static uint8_t action_foreground = 0;
 
+static atomic_int debug_activo = 0, accion_activo = 0;
+
+static AnilloLog *anillos = NULL;
+static pthread_mutex_t mutex_anillos = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t mutex_escritor = PTHREAD_MUTEX_INITIALIZER; /* archivos y drenado */
+static pthread_cond_t cond_escritor = PTHREAD_COND_INITIALIZER;
+static pthread_t hilo_escritor;
+static int escritor_activo = 0;
+static int escritor_detener = 0;
+static pthread_once_t clave_once = PTHREAD_ONCE_INIT;
+static pthread_key_t clave_anillo;
+static __thread AnilloLog *mi_anillo = NULL;
+
+// Fecha formateada, recalculada solo cuando cambia el segundo (la usa el escritor)
+static time_t fecha_segundo = -1;
+static char fecha_texto[26];
+
+static void marcar_abandonado(void *arg) {
+    atomic_store(&((AnilloLog *)arg)->abandonado, 1);
+}
+
+static void crear_clave(void) {
+    pthread_key_create(&clave_anillo, marcar_abandonado);
+}
+
+static AnilloLog *anillo_del_hilo(void) {
+    if (mi_anillo) return mi_anillo;
+    size_t tam = 16;
+    while (tam < (size_t)LOG_ANILLO_SLOTS) tam <<= 1;
+    AnilloLog *a = calloc(1, sizeof(AnilloLog) + tam * sizeof(RegistroLog));
+    if (!a) return NULL;
+    a->tam = tam;
+    pthread_once(&clave_once, crear_clave);
+    pthread_setspecific(clave_anillo, a);
+    pthread_mutex_lock(&mutex_anillos);
+    a->sig = anillos;
+    anillos = a;
+    pthread_mutex_unlock(&mutex_anillos);
+    mi_anillo = a;
+    return a;
+}
+
+static const char *fecha_de(time_t segundo) {
+    if (segundo != fecha_segundo) {
+        struct tm tm;
+        localtime_r(&segundo, &tm);
+        strftime(fecha_texto, sizeof(fecha_texto), "%Y-%m-%d %H:%M:%S", &tm);
+        fecha_segundo = segundo;
+    }
+    return fecha_texto;
+}
+
+typedef struct {
+    char buf[LOG_LOTE];
+    size_t len;
+} Lote;
+
+static Lote lote_debug, lote_accion;
+
+static void lote_volcar(Lote *l, FILE *fp) {
+    if (l->len == 0) return;
+    if (fp) fwrite(l->buf, 1, l->len, fp);
+    if (action_foreground) fwrite(l->buf, 1, l->len, stdout);
+    l->len = 0;
+}
+
+static void lote_agregar(Lote *l, FILE *fp, time_t segundo, const char *texto, size_t len) {
+    if (l->len + len + 32 > sizeof(l->buf)) lote_volcar(l, fp); // LOG_LARGO_MAX < LOG_LOTE
+    l->len += (size_t)snprintf(l->buf + l->len, sizeof(l->buf) - l->len, "[%s] ", fecha_de(segundo));
+    memcpy(l->buf + l->len, texto, len);
+    l->len += len;
+    l->buf[l->len++] = '\n';
+}
+
+// Pasa todo lo pendiente de los anillos a los archivos. Con mutex_escritor tomado.
+static void drenar(void) {
+    pthread_mutex_lock(&mutex_anillos);
+    AnilloLog **pp = &anillos;
+    while (*pp) {
+        AnilloLog *a = *pp;
+        size_t cola = atomic_load_explicit(&a->cola, memory_order_relaxed);
+        size_t cabeza = atomic_load_explicit(&a->cabeza, memory_order_acquire);
+        for (; cola != cabeza; cola++) {
+            RegistroLog *r = &a->slots[cola & (a->tam - 1)];
+            const char *texto = r->largo ? r->largo : r->texto;
+            if (r->destino == DESTINO_ACCION)
+                lote_agregar(&lote_accion, action_fp, r->segundo, texto, r->len);
+            else
+                lote_agregar(&lote_debug, log_fp, r->segundo, texto, r->len);
+            free(r->largo);
+            r->largo = NULL;
+        }
+        atomic_store_explicit(&a->cola, cola, memory_order_release);
+
+        unsigned long perdidos = atomic_exchange(&a->descartados, 0);
+        if (perdidos > 0) {
+            char aviso[96];
+            int n = snprintf(aviso, sizeof(aviso), "⚠️  %lu mensaje(s) de log descartados (anillo lleno)", perdidos);
+            lote_agregar(&lote_debug, log_fp, time(NULL), aviso, (size_t)n);
+        }
+        if (atomic_load(&a->abandonado) &&
+            atomic_load_explicit(&a->cabeza, memory_order_acquire) == cola) {
+            *pp = a->sig;
+            free(a);
+            continue;
+        }
+        pp = &a->sig;
+    }
+    pthread_mutex_unlock(&mutex_anillos);
+
+    lote_volcar(&lote_debug, log_fp);
+    lote_volcar(&lote_accion, action_fp);
+    if (log_fp) fflush(log_fp);
+    if (action_fp) fflush(action_fp);
+    if (action_foreground) fflush(stdout);
+}
+
+static void *escritor(void *arg) {
+    (void)arg;
+    // las señales las atiende el hilo principal
+    sigset_t set;
+    sigfillset(&set);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    pthread_mutex_lock(&mutex_escritor);
+    while (!escritor_detener) {
+        drenar();
+        struct timespec limite;
+        clock_gettime(CLOCK_REALTIME, &limite);
+        limite.tv_nsec += LOG_INTERVALO_MS * 1000000L;
+        limite.tv_sec += limite.tv_nsec / 1000000000L;
+        limite.tv_nsec %= 1000000000L;
+        pthread_cond_timedwait(&cond_escritor, &mutex_escritor, &limite);
+    }
+    drenar();
+    pthread_mutex_unlock(&mutex_escritor);
+    return NULL;
+}
+
+static void drenar_al_salir(void);
+static void registrar_salida(void) {
+    atexit(drenar_al_salir);
+}
+
+// Al salir con exit() sin cerrar los loggers, no perder lo encolado
+static void drenar_al_salir(void) {
+    if (pthread_mutex_trylock(&mutex_escritor) != 0) return;
+    drenar();
+    pthread_mutex_unlock(&mutex_escritor);
+}
+
+static void escritor_iniciar(void) {
+    static pthread_once_t salida_once = PTHREAD_ONCE_INIT;
+    pthread_once(&salida_once, registrar_salida);
+    pthread_mutex_lock(&mutex_escritor);
+    int arrancar = !escritor_activo;
+    escritor_activo = 1;
+    escritor_detener = 0;
+    pthread_mutex_unlock(&mutex_escritor);
+    if (arrancar && pthread_create(&hilo_escritor, NULL, escritor, NULL) != 0) {
+        perror("No se pudo crear el hilo de log");
+        escritor_activo = 0;
+    }
+}
+
+// Drena y cierra un archivo de log; detiene el escritor si ya no queda ninguno
+static void cerrar_destino(FILE **fp, atomic_int *activo) {
+    atomic_store(activo, 0);
+    pthread_mutex_lock(&mutex_escritor);
+    drenar();
+    if (*fp) {
+        fclose(*fp);
+        *fp = NULL;
+    }
+    int detener = escritor_activo && !log_fp && !action_fp;
+    if (detener) {
+        escritor_detener = 1;
+        pthread_cond_signal(&cond_escritor);
+    }
+    pthread_mutex_unlock(&mutex_escritor);
+    if (detener) {
+        pthread_join(hilo_escritor, NULL);
+        escritor_activo = 0;
+    }
+}
+
+// Deja marcado el final de un texto cortado a cap bytes (con su '\0').
+// Devuelve el largo resultante
+static size_t marcar_corte(char *texto, size_t cap) {
+    size_t largo = cap - sizeof(LOG_MARCA_CORTE);
+    // no partir un carácter UTF-8 al medio
+    while (largo > 0 && ((unsigned char)texto[largo] & 0xC0) == 0x80) largo--;
+    memcpy(texto + largo, LOG_MARCA_CORTE, sizeof(LOG_MARCA_CORTE));
+    return largo + sizeof(LOG_MARCA_CORTE) - 1;
+}
+
+static void encolar(uint8_t destino, const char *fmt, va_list ap) {
+    AnilloLog *a = anillo_del_hilo();
+    if (!a) return;
+    size_t cabeza = atomic_load_explicit(&a->cabeza, memory_order_relaxed);
+    size_t cola = atomic_load_explicit(&a->cola, memory_order_acquire);
+    if (cabeza - cola >= a->tam) {
+        atomic_fetch_add_explicit(&a->descartados, 1, memory_order_relaxed);
+        return;
+    }
+    RegistroLog *r = &a->slots[cabeza & (a->tam - 1)];
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    r->segundo = ts.tv_sec;
+    r->destino = destino;
+    r->largo = NULL;
+    va_list copia;
+    va_copy(copia, ap);
+    int n = vsnprintf(r->texto, sizeof(r->texto), fmt, ap);
+    if (n < 0) n = 0;
+    size_t len = (size_t)n;
+    if (len >= sizeof(r->texto)) {
+        size_t cap = len < LOG_LARGO_MAX ? len + 1 : LOG_LARGO_MAX;
+        r->largo = malloc(cap);
+        if (r->largo) {
+            vsnprintf(r->largo, cap, fmt, copia);
+            len = len < cap ? len : marcar_corte(r->largo, cap);
+        } else {
+            len = marcar_corte(r->texto, sizeof(r->texto));
+        }
+    }
+    va_end(copia);
+    r->len = (uint16_t)len;
+    atomic_store_explicit(&a->cabeza, cabeza + 1, memory_order_release);
+    if (cabeza - cola == a->tam / 2) pthread_cond_signal(&cond_escritor);
+}
+
 // Inicializa logger debug (info detallada)
 void init_logger(const char *path, uint8_t foreground) {
     if (foreground) {
@@ -25,20 +302,20 @@ void init_logger(const char *path, uint8_t foreground) {
         strncpy(log_path, path, sizeof(log_path)-1);
         log_path[sizeof(log_path)-1] = '\0';
     }
+    pthread_mutex_lock(&mutex_escritor);
     log_fp = fopen(log_path, "a");
+    pthread_mutex_unlock(&mutex_escritor);
     if (!log_fp) {
         perror("No se pudo abrir debug log");
-        log_fp = NULL;
+        return;
     }
+    atomic_store(&debug_activo, 1);
+    escritor_iniciar();
 }
 
 // Cierra logger debug
 void close_logger() {
-    if (log_fp) {
-        fflush(log_fp);
-        fclose(log_fp);
-        log_fp = NULL;
-    }
+    cerrar_destino(&log_fp, &debug_activo);
 }
 
 // Inicializa logger de acciones (server.log)
@@ -50,109 +327,119 @@ void init_action_logger(const char *path, uint8_t foreground) {
         strncpy(action_path, path, sizeof(action_path)-1);
         action_path[sizeof(action_path)-1] = '\0';
     }
+    pthread_mutex_lock(&mutex_escritor);
     action_fp = fopen(action_path, "a");
+    pthread_mutex_unlock(&mutex_escritor);
     if (!action_fp) {
         perror("No se pudo abrir action log");
-        action_fp = NULL;
+        return;
     }
+    atomic_store(&accion_activo, 1);
+    escritor_iniciar();
 }
 
 // Cierra logger de acciones
 void close_action_logger() {
-    if (action_fp) {
-        fflush(action_fp);
-        fclose(action_fp);
-        action_fp = NULL;
-    }
+    cerrar_destino(&action_fp, &accion_activo);
 }
 
-// Escribe entrada de debug con timestamp
+// Encola entrada de debug con timestamp
 void log_msg(const char *fmt, ...) {
-    if (!log_fp) return;
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    char actual_time[26];
-    strftime(actual_time, sizeof(actual_time), "%Y-%m-%d %H:%M:%S", &tm);
-    fprintf(log_fp, "[%s] ", actual_time);
+    if (!atomic_load_explicit(&debug_activo, memory_order_relaxed)) return;
     va_list ap;
     va_start(ap, fmt);
-    vfprintf(log_fp, fmt, ap);
+    encolar(DESTINO_DEBUG, fmt, ap);
     va_end(ap);
-    fprintf(log_fp, "\n");
-
-    if (action_foreground) {
-        printf("[%s] ", actual_time);
-        va_start(ap, fmt);
-        vfprintf(stdout, fmt, ap);
-        va_end(ap);
-        printf("\n");
-    }
-    fflush(log_fp);
 }
 
-// Escribe entrada de acción (sin tanto ruido) con timestamp
+// Encola entrada de acción (sin tanto ruido) con timestamp
 void log_action(const char *fmt, ...) {
-    if (!action_fp) return;
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    char actual_time[26];
-    strftime(actual_time, sizeof(actual_time), "%Y-%m-%d %H:%M:%S", &tm);
-    fprintf(action_fp, "[%s] ", actual_time);
-    
+    if (!atomic_load_explicit(&accion_activo, memory_order_relaxed)) return;
     va_list ap;
     va_start(ap, fmt);
-    vfprintf(action_fp, fmt, ap);
+    encolar(DESTINO_ACCION, fmt, ap);
     va_end(ap);
-    fprintf(action_fp, "\n");
-    
-    if (action_foreground) {
-        printf("[%s] ", actual_time);
-        va_start(ap, fmt);
-        vprintf(fmt, ap);
-        va_end(ap);
-        printf("\n");
-    }
-    
-    fflush(action_fp);
-}
-
-// Ejecuta comandos de monitoreo y vuelca salida al debug log (log_fp)
-void log_monitoring_snapshot() {
-    if (!log_fp) return;
-    log_msg("=== MONITOREO: netstat -tulpn ===");
-    FILE *p = popen("netstat -tulpn 2>/dev/null", "r");
-    if (p) {
-        char line[512];
-        while (fgets(line, sizeof(line), p)) fputs(line, log_fp);
-        pclose(p);
-    }
-    log_msg("=== MONITOREO: ss -tnlp ===");
-    p = popen("ss -tnlp 2>/dev/null", "r");
-    if (p) {
-        char line[512];
-        while (fgets(line, sizeof(line), p)) fputs(line, log_fp);
-        pclose(p);
-    }
-    log_msg("=== MONITOREO: lsof -iTCP -sTCP:LISTEN -P -n ===");
-    p = popen("lsof -iTCP -sTCP:LISTEN -P -n 2>/dev/null", "r");
-    if (p) {
-        char line[512];
-        while (fgets(line, sizeof(line), p)) fputs(line, log_fp);
-        pclose(p);
-    }
-    log_msg("=== MONITOREO: ps -eLf (primeras líneas) ===");
-    p = popen("ps -eLf 2>/dev/null | sed -n '1,200p'", "r");
-    if (p) {
-        char line[512];
-        while (fgets(line, sizeof(line), p)) fputs(line, log_fp);
-        pclose(p);
-    }
-    fflush(log_fp);
 }
 
+static atomic_ullong bytes_enviados = 0;
+static atomic_ullong bloques_comprimidos = 0, bytes_originales = 0, bytes_comprimidos = 0;
+
+int COMPRESION_MIN = COMPRESION_MIN_DEF;
+static __thread int compresion_activa = 0;
+
 // Envía un mensaje al socket del cliente
 void enviar(int socket, const char *mensaje) {
-    if (socket >= 0 && mensaje) send(socket, mensaje, strlen(mensaje), 0);
+    if (socket < 0 || !mensaje) return;
+    enviar_bytes(socket, mensaje, strlen(mensaje));
+}
+
+static int enviar_todo(int socket, const char *datos, size_t n) {
+    while (n > 0) {
+        // MSG_NOSIGNAL: un cliente que ya cerró no debe matar al proceso con SIGPIPE
+        ssize_t r = send(socket, datos, n, MSG_NOSIGNAL);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return -1;
+        atomic_fetch_add_explicit(&bytes_enviados, (unsigned long long)r, memory_order_relaxed);
+        datos += r;
+        n -= (size_t)r;
+    }
+    return 0;
+}
+
+static void poner32(char *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (char)(v >> (8 * i));
+}
+
+// Envía en bloques comprimidos; el que no se achica va como texto.
+// -1 sin memoria para comprimir (el llamante lo envía como texto)
+static int enviar_bloques(int socket, const char *datos, size_t n) {
+    char *buf = malloc(COMPRIMIDO_CABECERA + COMPRESION_COTA(COMPRIMIDO_BLOQUE));
+    if (!buf) return -1;
+    while (n > 0) {
+        size_t largo = n < COMPRIMIDO_BLOQUE ? n : COMPRIMIDO_BLOQUE;
+        size_t z = comprimir_bloque(datos, largo, buf + COMPRIMIDO_CABECERA, largo - 1);
+        int r;
+        if (z > 0) {
+            buf[0] = COMPRIMIDO_MARCA;
+            poner32(buf + 1, (uint32_t)largo);
+            poner32(buf + 5, (uint32_t)z);
+            r = enviar_todo(socket, buf, COMPRIMIDO_CABECERA + z);
+            atomic_fetch_add_explicit(&bloques_comprimidos, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&bytes_originales, largo, memory_order_relaxed);
+            atomic_fetch_add_explicit(&bytes_comprimidos, COMPRIMIDO_CABECERA + z, memory_order_relaxed);
+        } else {
+            r = enviar_todo(socket, datos, largo);
+        }
+        if (r != 0) break;
+        datos += largo;
+        n -= largo;
+    }
+    free(buf);
+    return 0;
+}
+
+// Envía n bytes completos (las copias de MOSTRAR y FETCH pueden ocupar varios MB)
+void enviar_bytes(int socket, const char *datos, size_t n) {
+    if (socket < 0 || !datos) return;
+    uint64_t t_envio = traza_inicio();
+    if (!(compresion_activa && COMPRESION_MIN > 0 && n >= (size_t)COMPRESION_MIN &&
+          enviar_bloques(socket, datos, n) == 0))
+        enviar_todo(socket, datos, n);
+    traza_fin("enviar", t_envio);
+}
+
+void enviar_comprimido(int activo) {
+    compresion_activa = activo;
+}
+
+void compresion_estadisticas(uint64_t *bloques, uint64_t *originales, uint64_t *comprimidos) {
+    if (bloques) *bloques = atomic_load(&bloques_comprimidos);
+    if (originales) *originales = atomic_load(&bytes_originales);
+    if (comprimidos) *comprimidos = atomic_load(&bytes_comprimidos);
+}
+
+uint64_t total_bytes_enviados() {
+    return atomic_load(&bytes_enviados);
 }
 
 // Recibe un mensaje del socket del cliente
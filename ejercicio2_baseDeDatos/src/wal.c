@@ -0,0 +1,326 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <pthread.h>
+#include "wal.h"
+#include "traza.h"
+#include "utils.h"
+
+char ARCHIVO_WAL[512] = "data/productos.wal";
+int GROUP_COMMIT_US = GROUP_COMMIT_US_DEF;
+
+static int wal_fd = -1;
+static pthread_mutex_t mutex_wal = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_durable = PTHREAD_COND_INITIALIZER; /* avanza lsn_durable */
+static pthread_cond_t cond_lote = PTHREAD_COND_INITIALIZER;    /* el lote pendiente se llenó */
+
+// Lote en construcción (protegido por mutex_wal)
+static char *pendiente = NULL;
+static size_t pendiente_len = 0, pendiente_cap = 0;
+// Lote que está escribiendo el líder (solo lo toca el líder)
+static char *escritura = NULL;
+static size_t escritura_cap = 0;
+
+static uint64_t siguiente_lsn = 0;
+static uint64_t lsn_durable = 0;
+static int escribiendo = 0;               /* hay un líder escribiendo un lote */
+static int averiado = 0;                  /* falló una escritura: no se aceptan más commits */
+static off_t tam_durable = 0;             /* bytes del archivo con lotes ya sincronizados */
+static uint64_t lsn_aplicado = 0;         /* todo LSN <= lsn_aplicado ya está en la tabla */
+// Aplicados fuera de orden por encima de lsn_aplicado: aplicados[lsn & (cap_aplicados - 1)].
+// Cada hilo tiene a lo sumo un commit sin aplicar, así que la ventana es chica
+static uint8_t *aplicados = NULL;
+static size_t cap_aplicados = 0;
+
+static uint64_t total_commits = 0;
+static uint64_t total_syncs = 0;
+
+int wal_abrir(const char *path, uint64_t lsn_base) {
+    if (path && path[0] != '\0') {
+        strncpy(ARCHIVO_WAL, path, sizeof(ARCHIVO_WAL) - 1);
+        ARCHIVO_WAL[sizeof(ARCHIVO_WAL) - 1] = '\0';
+    }
+    siguiente_lsn = lsn_base;
+    lsn_durable = siguiente_lsn;
+    lsn_aplicado = siguiente_lsn;
+    wal_fd = open(ARCHIVO_WAL, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (wal_fd < 0) {
+        log_msg("WAL: no se pudo abrir %s: %s", ARCHIVO_WAL, strerror(errno));
+        return -1;
+    }
+    struct stat st;
+    tam_durable = fstat(wal_fd, &st) == 0 ? st.st_size : 0;
+    log_msg("WAL: %s abierto (último LSN=%llu, ventana=%dus)",
+            ARCHIVO_WAL, (unsigned long long)lsn_durable, GROUP_COMMIT_US);
+    return 0;
+}
+
+void wal_cerrar() {
+    pthread_mutex_lock(&mutex_wal);
+    if (wal_fd >= 0) {
+        fdatasync(wal_fd);
+        close(wal_fd);
+        wal_fd = -1;
+        log_msg("WAL: %llu commits escritos con %llu fdatasync",
+                (unsigned long long)total_commits, (unsigned long long)total_syncs);
+    }
+    free(aplicados);
+    aplicados = NULL;
+    cap_aplicados = 0;
+    pthread_mutex_unlock(&mutex_wal);
+}
+
+static int reservar(char **buf, size_t *cap, size_t necesario) {
+    if (necesario <= *cap) return 0;
+    size_t nueva = *cap ? *cap : 4096;
+    while (nueva < necesario) nueva *= 2;
+    char *n = realloc(*buf, nueva);
+    if (!n) return -1;
+    *buf = n;
+    *cap = nueva;
+    return 0;
+}
+
+static int escribir_todo(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+// Tras un error de E/S no se sabe qué parte del lote llegó al disco (y un
+// fdatasync posterior podría dar ok sin haberlo escrito): se recorta el
+// archivo al último lote durable para que la recuperación no reproduzca
+// transacciones que se informaron como fallidas, y el WAL deja de aceptar
+// commits hasta reiniciar. Con el mutex tomado
+static void averiar(uint64_t desde, uint64_t hasta, int err) {
+    log_msg("WAL: error escribiendo lote %llu..%llu: %s",
+            (unsigned long long)desde, (unsigned long long)hasta, strerror(err));
+    if (ftruncate(wal_fd, tam_durable) != 0 || fdatasync(wal_fd) != 0) {
+        log_msg("WAL: no se pudo recortar %s a %lld bytes: %s (puede contener el lote fallido)",
+                ARCHIVO_WAL, (long long)tam_durable, strerror(errno));
+    }
+    averiado = 1;
+    pendiente_len = 0; // los commits encolados fallan con el lote
+    log_msg("WAL: fuera de servicio, se rechazan los commits hasta reiniciar el servidor");
+}
+
+uint64_t wal_commit(const char *ops, size_t len) {
+    char cabecera[48], pie[48];
+    pthread_mutex_lock(&mutex_wal);
+    if (wal_fd < 0 || averiado) {
+        pthread_mutex_unlock(&mutex_wal);
+        return 0;
+    }
+
+    // Encolar el bloque en el lote pendiente. El LSN se consume recién con
+    // lugar en el lote: un número sin bloque frenaría a lsn_aplicado
+    uint64_t lsn = siguiente_lsn + 1;
+    int lc = snprintf(cabecera, sizeof(cabecera), "T %llu\n", (unsigned long long)lsn);
+    int lp = snprintf(pie, sizeof(pie), "C %llu\n", (unsigned long long)lsn);
+    if (reservar(&pendiente, &pendiente_cap, pendiente_len + lc + len + lp) != 0) {
+        pthread_mutex_unlock(&mutex_wal);
+        return 0;
+    }
+    siguiente_lsn = lsn;
+    memcpy(pendiente + pendiente_len, cabecera, lc); pendiente_len += lc;
+    memcpy(pendiente + pendiente_len, ops, len);     pendiente_len += len;
+    memcpy(pendiente + pendiente_len, pie, lp);      pendiente_len += lp;
+    if (pendiente_len >= WAL_LOTE_MAX) pthread_cond_signal(&cond_lote);
+
+    while (lsn_durable < lsn && !averiado) {
+        if (escribiendo) {
+            pthread_cond_wait(&cond_durable, &mutex_wal);
+            continue;
+        }
+
+        // Somos líder: esperar la ventana para sumar más commits al lote
+        escribiendo = 1;
+        if (GROUP_COMMIT_US > 0 && pendiente_len < WAL_LOTE_MAX) {
+            struct timespec limite;
+            clock_gettime(CLOCK_REALTIME, &limite);
+            limite.tv_nsec += (long)GROUP_COMMIT_US * 1000L;
+            limite.tv_sec += limite.tv_nsec / 1000000000L;
+            limite.tv_nsec %= 1000000000L;
+            while (pendiente_len < WAL_LOTE_MAX &&
+                   pthread_cond_timedwait(&cond_lote, &mutex_wal, &limite) != ETIMEDOUT)
+                ;
+        }
+
+        // Tomar el lote completo y escribirlo sin el mutex
+        uint64_t desde = lsn_durable + 1, hasta = siguiente_lsn;
+        size_t n = pendiente_len;
+        char *tmp = escritura; size_t tmp_cap = escritura_cap;
+        escritura = pendiente; escritura_cap = pendiente_cap;
+        pendiente = tmp; pendiente_cap = tmp_cap;
+        pendiente_len = 0;
+        pthread_mutex_unlock(&mutex_wal);
+
+        uint64_t t_sync = traza_inicio();
+        int ok = escribir_todo(wal_fd, escritura, n) == 0 && fdatasync(wal_fd) == 0;
+        int err = errno;
+        traza_fin("wal_fdatasync", t_sync);
+
+        pthread_mutex_lock(&mutex_wal);
+        if (ok) {
+            total_commits += hasta - desde + 1;
+            total_syncs++;
+            tam_durable += (off_t)n;
+            lsn_durable = hasta;
+        } else {
+            averiar(desde, hasta, err);
+        }
+        escribiendo = 0;
+        pthread_cond_broadcast(&cond_durable);
+    }
+
+    int durable = (lsn_durable >= lsn);
+    pthread_mutex_unlock(&mutex_wal);
+    return durable ? lsn : 0;
+}
+
+uint64_t wal_lsn() {
+    pthread_mutex_lock(&mutex_wal);
+    uint64_t lsn = lsn_durable;
+    pthread_mutex_unlock(&mutex_wal);
+    return lsn;
+}
+
+void wal_estadisticas(uint64_t *commits, uint64_t *syncs) {
+    pthread_mutex_lock(&mutex_wal);
+    if (commits) *commits = total_commits;
+    if (syncs) *syncs = total_syncs;
+    pthread_mutex_unlock(&mutex_wal);
+}
+
+// Anota lsn (> lsn_aplicado) en la ventana, agrandándola si no entra
+static int marcar_aplicado(uint64_t lsn) {
+    if (lsn - lsn_aplicado > cap_aplicados) {
+        size_t nueva = cap_aplicados ? cap_aplicados * 2 : 256;
+        while (lsn - lsn_aplicado > nueva) nueva *= 2;
+        uint8_t *n = calloc(nueva, 1);
+        if (!n) return -1;
+        for (uint64_t l = lsn_aplicado + 1; l <= lsn_aplicado + cap_aplicados; l++) {
+            n[l & (nueva - 1)] = aplicados[l & (cap_aplicados - 1)];
+        }
+        free(aplicados);
+        aplicados = n;
+        cap_aplicados = nueva;
+    }
+    aplicados[lsn & (cap_aplicados - 1)] = 1;
+    return 0;
+}
+
+void wal_aplicado(uint64_t lsn) {
+    pthread_mutex_lock(&mutex_wal);
+    if (lsn > lsn_aplicado) {
+        if (marcar_aplicado(lsn) != 0) {
+            log_msg("WAL: sin memoria para anotar el LSN aplicado %llu", (unsigned long long)lsn);
+        }
+        // avanzar sobre los consecutivos ya aplicados
+        while (cap_aplicados > 0 && aplicados[(lsn_aplicado + 1) & (cap_aplicados - 1)]) {
+            lsn_aplicado++;
+            aplicados[lsn_aplicado & (cap_aplicados - 1)] = 0;
+        }
+    }
+    pthread_mutex_unlock(&mutex_wal);
+}
+
+uint64_t wal_lsn_aplicado() {
+    pthread_mutex_lock(&mutex_wal);
+    uint64_t lsn = lsn_aplicado;
+    pthread_mutex_unlock(&mutex_wal);
+    return lsn;
+}
+
+long wal_tamano() {
+    struct stat st;
+    pthread_mutex_lock(&mutex_wal);
+    long tam = (wal_fd >= 0 && fstat(wal_fd, &st) == 0) ? (long)st.st_size : 0;
+    pthread_mutex_unlock(&mutex_wal);
+    return tam;
+}
+
+// Copia los bytes [desde, hasta) de in al final de out
+static int copiar_tramo(int in, int out, off_t desde, off_t hasta) {
+    char buf[65536];
+    while (desde < hasta) {
+        size_t pedir = (size_t)(hasta - desde) < sizeof(buf) ? (size_t)(hasta - desde) : sizeof(buf);
+        ssize_t n = pread(in, buf, pedir, desde);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0 || escribir_todo(out, buf, (size_t)n) != 0) return -1;
+        desde += n;
+    }
+    return 0;
+}
+
+// Posición del primer bloque con LSN > hasta entre los primeros fin bytes
+// (los bloques están en orden de LSN), o fin si no hay ninguno
+static off_t inicio_cola(FILE *in, uint64_t hasta, off_t fin) {
+    char linea[2048];
+    int inicio_linea = 1;
+    off_t pos = 0;
+    while (pos < fin && fgets(linea, sizeof(linea), in)) {
+        unsigned long long lsn;
+        if (inicio_linea && linea[0] == 'T' && sscanf(linea, "T %llu", &lsn) == 1 && lsn > hasta) return pos;
+        inicio_linea = strchr(linea, '\n') != NULL;
+        pos = ftello(in);
+    }
+    return fin;
+}
+
+// La cola se copia en dos pasos: lo durable al empezar, sin el mutex (los
+// commits siguen agregando al final), y con el mutex solo lo agregado
+// mientras tanto, justo antes de reemplazar el archivo
+int wal_truncar(uint64_t hasta) {
+    char tmp[600];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", ARCHIVO_WAL);
+
+    pthread_mutex_lock(&mutex_wal);
+    while (escribiendo) pthread_cond_wait(&cond_durable, &mutex_wal);
+    int abierto = (wal_fd >= 0 && !averiado);
+    off_t fin = tam_durable;
+    pthread_mutex_unlock(&mutex_wal);
+    if (!abierto) return -1;
+
+    FILE *in = fopen(ARCHIVO_WAL, "r");
+    int out = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (!in || out < 0) {
+        if (in) fclose(in);
+        if (out >= 0) close(out);
+        return -1;
+    }
+    off_t desde = inicio_cola(in, hasta, fin);
+    int ok = copiar_tramo(fileno(in), out, desde, fin) == 0 && fdatasync(out) == 0;
+
+    pthread_mutex_lock(&mutex_wal);
+    while (escribiendo) pthread_cond_wait(&cond_durable, &mutex_wal);
+    off_t nuevo_fin = tam_durable;
+    ok = ok && !averiado && wal_fd >= 0 &&
+         copiar_tramo(fileno(in), out, fin, nuevo_fin) == 0 && fdatasync(out) == 0;
+    ok = (close(out) == 0) && ok;
+    fclose(in);
+    if (!ok || rename(tmp, ARCHIVO_WAL) != 0) {
+        log_msg("WAL: error truncando %s: %s", ARCHIVO_WAL, strerror(errno));
+        remove(tmp);
+        pthread_mutex_unlock(&mutex_wal);
+        return -1;
+    }
+    close(wal_fd);
+    wal_fd = open(ARCHIVO_WAL, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    tam_durable = nuevo_fin - desde;
+    int r = (wal_fd >= 0) ? 0 : -1;
+    pthread_mutex_unlock(&mutex_wal);
+    return r;
+}